@@ -0,0 +1,175 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/compile/parallel_build_scheduler.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <queue>
+
+#include "common/thread_pool.h"
+#include "common/util/error_manager/error_manager.h"
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/debug/log.h"
+#include "graph/ge_local_context.h"
+#include "graph/utils/graph_utils.h"
+
+namespace ge {
+namespace {
+constexpr uint32_t kMaxBuildThreadNum = 16U;
+}  // namespace
+
+ParallelBuildScheduler::ParallelBuildScheduler(const uint32_t thread_num)
+    : thread_num_((thread_num == 0U) ? ThreadPool::GetDefaultThreadNum(kMaxBuildThreadNum) : thread_num) {}
+
+Status ParallelBuildScheduler::AddTask(const std::string &name, const BuildTaskFunc &func,
+                                       const std::vector<size_t> &deps, size_t &task_id) {
+  GE_CHK_BOOL_RET_STATUS(func != nullptr, PARAM_INVALID, "[Check][Param]func of task %s is null.", name.c_str());
+  task_id = tasks_.size();
+  for (const size_t dep : deps) {
+    GE_CHK_BOOL_RET_STATUS(dep < task_id, PARAM_INVALID, "[Check][Param]task %s depends on unknown task %zu.",
+                           name.c_str(), dep);
+  }
+  BuildTask task;
+  task.name = name;
+  task.func = func;
+  task.dep_num = deps.size();
+  tasks_.emplace_back(std::move(task));
+  for (const size_t dep : deps) {
+    tasks_[dep].successors.emplace_back(task_id);
+  }
+  return SUCCESS;
+}
+
+Status ParallelBuildScheduler::Run() {
+  task_status_.assign(tasks_.size(), SUCCESS);
+  if (tasks_.empty()) {
+    return SUCCESS;
+  }
+
+  std::vector<size_t> dep_num(tasks_.size());
+  std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t>> ready;
+  for (size_t i = 0U; i < tasks_.size(); ++i) {
+    dep_num[i] = tasks_[i].dep_num;
+    if (dep_num[i] == 0U) {
+      ready.push(i);
+    }
+  }
+
+  const GEThreadLocalContext ge_context = GetThreadLocalContext();
+  const error_message::Context error_context = ErrorManager::GetInstance().GetErrorManagerContext();
+  std::mutex mutex;
+  std::condition_variable cond_var;
+  std::queue<size_t> completed;
+  ThreadPool pool("ge_build_", std::min(thread_num_, static_cast<uint32_t>(tasks_.size())));
+  std::vector<std::future<void>> futures;
+  size_t running = 0U;
+  size_t finished = 0U;
+  bool failed = false;
+
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    // tasks are started in id order, which keeps the logs and the cache filling order stable
+    while ((!failed) && (!ready.empty())) {
+      const size_t task_id = ready.top();
+      ready.pop();
+      auto future = pool.commit([this, task_id, &mutex, &cond_var, &completed, &ge_context, &error_context]() {
+        // the pool threads run with the options and the error context of the caller
+        GetThreadLocalContext() = ge_context;
+        ErrorManager::GetInstance().SetErrorContext(error_context);
+        GELOGD("Start build task %zu[%s].", task_id, tasks_[task_id].name.c_str());
+        Status ret = FAILED;
+        try {
+          ret = tasks_[task_id].func();
+        } catch (const std::exception &e) {
+          GELOGE(FAILED, "[Build][Task]%zu[%s] threw: %s.", task_id, tasks_[task_id].name.c_str(), e.what());
+        } catch (...) {
+          GELOGE(FAILED, "[Build][Task]%zu[%s] threw an unknown exception.", task_id, tasks_[task_id].name.c_str());
+        }
+        // always reported, Run waits for every started task
+        const std::lock_guard<std::mutex> task_lock(mutex);
+        task_status_[task_id] = ret;
+        completed.push(task_id);
+        cond_var.notify_one();
+      });
+      if (!future.valid()) {
+        GELOGE(FAILED, "[Commit][Task]%zu[%s] failed.", task_id, tasks_[task_id].name.c_str());
+        task_status_[task_id] = FAILED;
+        failed = true;
+        break;
+      }
+      futures.emplace_back(std::move(future));
+      ++running;
+    }
+    if (running == 0U) {
+      break;
+    }
+    cond_var.wait(lock, [&completed]() { return !completed.empty(); });
+    while (!completed.empty()) {
+      const size_t task_id = completed.front();
+      completed.pop();
+      --running;
+      ++finished;
+      if (task_status_[task_id] != SUCCESS) {
+        GELOGE(task_status_[task_id], "[Build][Task]%zu[%s] failed.", task_id, tasks_[task_id].name.c_str());
+        failed = true;
+        continue;
+      }
+      for (const size_t successor : tasks_[task_id].successors) {
+        if (--dep_num[successor] == 0U) {
+          ready.push(successor);
+        }
+      }
+    }
+  }
+  lock.unlock();
+  for (auto &future : futures) {
+    future.wait();
+  }
+
+  for (size_t i = 0U; i < task_status_.size(); ++i) {
+    if (task_status_[i] != SUCCESS) {
+      return task_status_[i];
+    }
+  }
+  if (finished != tasks_.size()) {
+    GELOGE(FAILED, "[Check][Task]only %zu of %zu build tasks finished.", finished, tasks_.size());
+    return FAILED;
+  }
+  GELOGI("Finish %zu build tasks by %u threads.", finished, pool.GetThreadNum());
+  return SUCCESS;
+}
+
+Status ParallelBuildScheduler::CompileIndependentGraphs(const ComputeGraphPtr &root_graph,
+                                                        const GraphCompileFunc &compile_func,
+                                                        const uint32_t thread_num) {
+  GE_CHECK_NOTNULL(root_graph);
+  std::vector<ComputeGraphPtr> graphs;
+  GE_CHK_GRAPH_STATUS_RET(GraphUtils::GetIndependentCompileGraphs(root_graph, graphs),
+                          "[Get][IndependentCompileGraphs]of graph %s failed.", root_graph->GetName().c_str());
+  ParallelBuildScheduler scheduler(thread_num);
+  for (const auto &graph : graphs) {
+    GE_CHECK_NOTNULL(graph);
+    size_t task_id = 0U;
+    GE_CHK_STATUS_RET(scheduler.AddTask(graph->GetName(), [graph, &compile_func]() { return compile_func(graph); },
+                                        {}, task_id), "[Add][Task]for graph %s failed.", graph->GetName().c_str());
+  }
+  return scheduler.Run();
+}
+}  // namespace ge
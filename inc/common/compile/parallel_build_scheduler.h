@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_COMMON_COMPILE_PARALLEL_BUILD_SCHEDULER_H_
+#define GE_COMMON_COMPILE_PARALLEL_BUILD_SCHEDULER_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "framework/common/ge_inner_error_codes.h"
+#include "graph/compute_graph.h"
+
+namespace ge {
+using BuildTaskFunc = std::function<Status()>;
+using GraphCompileFunc = std::function<Status(const ComputeGraphPtr &)>;
+
+/// Runs graph build tasks on a bounded worker pool, a task starts once all the tasks it depends on succeeded.
+/// Dependencies can only point to tasks added before, so the task graph is acyclic by construction.
+/// Results are kept per task id. After a failure no new task is started, the running ones are waited for, and the
+/// returned status is the one of the failed task with the smallest id among the tasks that ran. Which tasks were
+/// already running when the first failure was seen depends on the thread timing, so with several failing tasks the
+/// reported one may differ from run to run; a single failing task is always the one reported.
+/// Every task runs with a copy of the thread local options (GetThreadLocalContext) and the ErrorManager context of
+/// the thread calling Run, so the op compile cache configured by OP_COMPILER_CACHE_DIR/OP_COMPILER_CACHE_MODE is
+/// shared by the concurrent compilations. A task throwing an exception fails with FAILED.
+class ParallelBuildScheduler {
+ public:
+  // 0 means min(hardware concurrency, kMaxBuildThreadNum)
+  explicit ParallelBuildScheduler(const uint32_t thread_num = 0U);
+  ~ParallelBuildScheduler() = default;
+
+  Status AddTask(const std::string &name, const BuildTaskFunc &func, const std::vector<size_t> &deps,
+                 size_t &task_id);
+
+  Status Run();
+
+  const std::vector<Status> &GetTaskStatus() const {
+    return task_status_;
+  }
+
+  // compiles the partitions of GraphUtils::GetIndependentCompileGraphs concurrently, they have no dependencies
+  static Status CompileIndependentGraphs(const ComputeGraphPtr &root_graph, const GraphCompileFunc &compile_func,
+                                         const uint32_t thread_num = 0U);
+
+ private:
+  struct BuildTask {
+    std::string name;
+    BuildTaskFunc func;
+    std::vector<size_t> successors;
+    size_t dep_num = 0U;
+  };
+
+  uint32_t thread_num_;
+  std::vector<BuildTask> tasks_;
+  std::vector<Status> task_status_;
+};
+}  // namespace ge
+#endif  // GE_COMMON_COMPILE_PARALLEL_BUILD_SCHEDULER_H_
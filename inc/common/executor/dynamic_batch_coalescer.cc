@@ -0,0 +1,362 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/executor/dynamic_batch_coalescer.h"
+
+#include <algorithm>
+#include <future>
+
+#include "common/util/error_manager/deferred_error.h"
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/debug/log.h"
+#include "framework/common/types.h"
+#include "runtime/mem.h"
+#include "securec.h"
+
+namespace ge {
+namespace {
+// weight of the latest measurement in the moving average of the gear cost
+constexpr double kCostSmoothing = 0.2;
+// unit cost of a sample before any gear is measured, only the ratio between the gears matters then
+constexpr double kInitSampleCostUs = 1.0;
+}  // namespace
+
+DynamicBatchCoalescer::~DynamicBatchCoalescer() {
+  (void)Finalize();
+}
+
+Status DynamicBatchCoalescer::Init(const DynamicBatchCoalescerOption &option) {
+  GE_CHK_BOOL_RET_STATUS(!running_, FAILED, "[Check][State] Coalescer of model %u is already initialized.",
+                         option.model_id);
+  GE_CHK_BOOL_RET_STATUS((!option.input_sample_sizes.empty()) && (!option.output_sample_sizes.empty()),
+                         PARAM_INVALID, "[Check][Param] Sample sizes of model %u are not set.", option.model_id);
+  std::vector<std::vector<int64_t>> batch_info;
+  int32_t dynamic_type = static_cast<int32_t>(FIXED);
+  GE_CHK_STATUS_RET(executor_.GetDynamicBatchInfo(option.model_id, batch_info, dynamic_type),
+                    "[Get][DynamicBatchInfo] Get dynamic batch info of model %u failed.", option.model_id);
+  GE_CHK_BOOL_RET_STATUS((dynamic_type == static_cast<int32_t>(DYNAMIC_BATCH)) && (!batch_info.empty()),
+                         PARAM_INVALID, "[Check][Param] Model %u is not compiled with dynamic batch, type %d.",
+                         option.model_id, dynamic_type);
+  gears_.clear();
+  for (const auto &gear : batch_info) {
+    GE_CHK_BOOL_RET_STATUS((gear.size() == 1U) && (gear[0U] > 0), PARAM_INVALID,
+                           "[Check][Param] Invalid batch gear of model %u.", option.model_id);
+    gears_.emplace_back(static_cast<uint64_t>(gear[0U]));
+  }
+  std::sort(gears_.begin(), gears_.end());
+  gears_.erase(std::unique(gears_.begin(), gears_.end()), gears_.end());
+
+  const uint64_t max_gear = gears_.back();
+  for (const auto *const sample_sizes : {&option.input_sample_sizes, &option.output_sample_sizes}) {
+    for (const uint64_t sample_size : *sample_sizes) {
+      GE_CHK_BOOL_RET_STATUS((sample_size > 0U) && (sample_size <= (UINT64_MAX / max_gear)), PARAM_INVALID,
+                             "[Check][Param] Sample size %lu of model %u is 0 or overflows with batch %lu.",
+                             sample_size, option.model_id, max_gear);
+    }
+  }
+  GE_CHK_BOOL_RET_STATUS(option.dynamic_input_size >= sizeof(uint64_t), PARAM_INVALID,
+                         "[Check][Param] Dynamic input size %lu of model %u is less than the batch size.",
+                         option.dynamic_input_size, option.model_id);
+  option_ = option;
+  const auto malloc_buffers = [max_gear](const std::vector<uint64_t> &sample_sizes, const bool host,
+                                         std::vector<void *> &buffers) -> Status {
+    for (const uint64_t sample_size : sample_sizes) {
+      void *buffer = nullptr;
+      if (host) {
+        GE_CHK_RT_RET(rtMallocHost(&buffer, sample_size * max_gear, GE_MODULE_NAME_U16));
+      } else {
+        GE_CHK_RT_RET(rtMalloc(&buffer, sample_size * max_gear, RT_MEMORY_HBM, GE_MODULE_NAME_U16));
+      }
+      buffers.emplace_back(buffer);
+    }
+    return SUCCESS;
+  };
+  Status ret = malloc_buffers(option_.input_sample_sizes, false, input_buffers_);
+  if (ret == SUCCESS) {
+    ret = malloc_buffers(option_.output_sample_sizes, false, output_buffers_);
+  }
+  if ((ret == SUCCESS) && option_.host_buffers) {
+    ret = malloc_buffers(option_.input_sample_sizes, true, input_staging_);
+    if (ret == SUCCESS) {
+      ret = malloc_buffers(option_.output_sample_sizes, true, output_staging_);
+    }
+  }
+  if (ret == SUCCESS) {
+    ret = (rtMalloc(&dynamic_input_, option_.dynamic_input_size, RT_MEMORY_HBM, GE_MODULE_NAME_U16) == RT_ERROR_NONE)
+              ? SUCCESS : RT_FAILED;
+  }
+  if (ret != SUCCESS) {
+    GELOGE(ret, "[Malloc][Buffer] Allocate batch buffers of model %u failed.", option_.model_id);
+    FreeBuffers();
+    return ret;
+  }
+
+  gear_cost_us_.clear();
+  gear_stats_.clear();
+  for (const uint64_t gear : gears_) {
+    gear_cost_us_.emplace_back(kInitSampleCostUs * static_cast<double>(gear));
+    BatchGearStat stat;
+    stat.batch_size = gear;
+    gear_stats_.emplace_back(stat);
+  }
+  cost_measured_ = false;
+  running_ = true;
+  dispatcher_ = std::thread(&DynamicBatchCoalescer::DispatchLoop, this);
+  GELOGI("Dynamic batch coalescer of model %u initialized, gear num %zu, max gear %lu, latency budget %lu us.",
+         option_.model_id, gears_.size(), max_gear, option_.latency_budget_us);
+  return SUCCESS;
+}
+
+Status DynamicBatchCoalescer::Finalize() {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_) {
+      return SUCCESS;
+    }
+    running_ = false;
+  }
+  cond_.notify_all();
+  if (dispatcher_.joinable()) {
+    dispatcher_.join();
+  }
+  FreeBuffers();
+  return SUCCESS;
+}
+
+void DynamicBatchCoalescer::FreeBuffers() {
+  for (void *const buffer : input_buffers_) {
+    (void)rtFree(buffer);
+  }
+  for (void *const buffer : output_buffers_) {
+    (void)rtFree(buffer);
+  }
+  for (void *const buffer : input_staging_) {
+    (void)rtFreeHost(buffer);
+  }
+  for (void *const buffer : output_staging_) {
+    (void)rtFreeHost(buffer);
+  }
+  if (dynamic_input_ != nullptr) {
+    (void)rtFree(dynamic_input_);
+    dynamic_input_ = nullptr;
+  }
+  input_buffers_.clear();
+  output_buffers_.clear();
+  input_staging_.clear();
+  output_staging_.clear();
+}
+
+Status DynamicBatchCoalescer::Submit(const std::vector<DataBuffer> &inputs, const std::vector<DataBuffer> &outputs,
+                                     const DoneCallback &done) {
+  GE_CHK_BOOL_RET_STATUS((inputs.size() == option_.input_sample_sizes.size()) &&
+                         (outputs.size() == option_.output_sample_sizes.size()), PARAM_INVALID,
+                         "[Check][Param] Request of model %u has %zu inputs and %zu outputs, expect %zu and %zu.",
+                         option_.model_id, inputs.size(), outputs.size(), option_.input_sample_sizes.size(),
+                         option_.output_sample_sizes.size());
+  for (size_t i = 0U; i < inputs.size(); ++i) {
+    GE_CHK_BOOL_RET_STATUS((inputs[i].data != nullptr) && (inputs[i].length >= option_.input_sample_sizes[i]),
+                           PARAM_INVALID, "[Check][Param] Input %zu of request is shorter than one sample.", i);
+  }
+  for (size_t i = 0U; i < outputs.size(); ++i) {
+    GE_CHK_BOOL_RET_STATUS((outputs[i].data != nullptr) && (outputs[i].length >= option_.output_sample_sizes[i]),
+                           PARAM_INVALID, "[Check][Param] Output %zu of request is shorter than one sample.", i);
+  }
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    GE_CHK_BOOL_RET_STATUS(running_, FAILED, "[Check][State] Coalescer of model %u is not running.",
+                           option_.model_id);
+    // a full queue is back pressure the caller retries on, its error is only formatted if it is read
+    if (queue_.size() >= option_.max_queue_depth) {
+      GELOGW("[Check][Queue] Queue of model %u is full, depth %zu.", option_.model_id, queue_.size());
+      REPORT_INNER_ERROR_DEFERRED("E19999", "Queue of model %u is full, depth %zu.", option_.model_id, queue_.size());
+      return FAILED;
+    }
+    queue_.push_back({inputs, outputs, done, Clock::now()});
+  }
+  cond_.notify_one();
+  return SUCCESS;
+}
+
+Status DynamicBatchCoalescer::Execute(const std::vector<DataBuffer> &inputs, const std::vector<DataBuffer> &outputs) {
+  std::promise<Status> promise;
+  std::future<Status> future = promise.get_future();
+  GE_CHK_STATUS_RET_NOLOG(Submit(inputs, outputs, [&promise](const Status status) { promise.set_value(status); }));
+  return future.get();
+}
+
+size_t DynamicBatchCoalescer::SelectGear(const std::vector<uint64_t> &gears, const std::vector<double> &gear_cost_us,
+                                         const size_t queue_depth) {
+  const auto up = std::lower_bound(gears.begin(), gears.end(), static_cast<uint64_t>(queue_depth));
+  if (up == gears.end()) {
+    return gears.size() - 1U;
+  }
+  const size_t up_index = static_cast<size_t>(up - gears.begin());
+  if ((*up == queue_depth) || (up_index == 0U)) {
+    return up_index;
+  }
+  // padding the queue to the larger gear against running a full smaller gear and leaving the rest queued
+  const size_t down_index = up_index - 1U;
+  const double padded_cost = gear_cost_us[up_index] / static_cast<double>(queue_depth);
+  const double full_cost = gear_cost_us[down_index] / static_cast<double>(gears[down_index]);
+  return (full_cost < padded_cost) ? down_index : up_index;
+}
+
+void DynamicBatchCoalescer::DispatchLoop() {
+  const auto budget = std::chrono::microseconds(option_.latency_budget_us);
+  std::vector<Request> batch;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cond_.wait(lock, [this]() { return (!running_) || (!queue_.empty()); });
+    if (queue_.empty()) {
+      return;
+    }
+    const size_t depth = queue_.size();
+    size_t gear_index = SelectGear(gears_, gear_cost_us_, depth);
+    // the oldest request has to be dispatched once the wait plus the execution of the gear reaches the budget
+    const auto exec_time = std::chrono::microseconds(static_cast<int64_t>(gear_cost_us_[gear_index]));
+    const Clock::time_point deadline = queue_.front().enqueue_time + budget - exec_time;
+    if (running_ && (depth < gears_.back()) && (Clock::now() < deadline)) {
+      (void)cond_.wait_until(lock, deadline, [this, depth]() {
+        return (!running_) || (queue_.size() >= gears_.back()) || (queue_.size() != depth);
+      });
+      continue;
+    }
+    if (!running_) {
+      // draining, no reason to wait for more requests
+      const auto up = std::lower_bound(gears_.begin(), gears_.end(), static_cast<uint64_t>(depth));
+      gear_index = (up == gears_.end()) ? (gears_.size() - 1U) : static_cast<size_t>(up - gears_.begin());
+    }
+    const size_t sample_num = std::min(depth, static_cast<size_t>(gears_[gear_index]));
+    batch.clear();
+    for (size_t i = 0U; i < sample_num; ++i) {
+      batch.emplace_back(std::move(queue_.front()));
+      queue_.pop_front();
+    }
+    lock.unlock();
+    const Status ret = RunBatch(batch, gear_index);
+    for (const auto &request : batch) {
+      if (request.done != nullptr) {
+        request.done(ret);
+      }
+    }
+    lock.lock();
+  }
+}
+
+Status DynamicBatchCoalescer::PackInput(const std::vector<Request> &batch, const size_t input_index,
+                                        const uint64_t gear) const {
+  const uint64_t sample_size = option_.input_sample_sizes[input_index];
+  uint8_t *const base = static_cast<uint8_t *>(input_buffers_[input_index]);
+  // rows after the batch are padding, their content does not matter
+  if (!option_.host_buffers) {
+    for (size_t j = 0U; j < batch.size(); ++j) {
+      GE_CHK_RT_RET(rtMemcpy(base + (j * sample_size), (gear - j) * sample_size, batch[j].inputs[input_index].data,
+                             sample_size, RT_MEMCPY_DEVICE_TO_DEVICE));
+    }
+    return SUCCESS;
+  }
+  uint8_t *const staging = static_cast<uint8_t *>(input_staging_[input_index]);
+  for (size_t j = 0U; j < batch.size(); ++j) {
+    GE_CHK_BOOL_RET_STATUS(memcpy_s(staging + (j * sample_size), (gear - j) * sample_size,
+                                    batch[j].inputs[input_index].data, sample_size) == EOK, FAILED,
+                           "[Copy][Input] Pack input %zu of request %zu failed.", input_index, j);
+  }
+  GE_CHK_RT_RET(rtMemcpy(base, gear * sample_size, staging, batch.size() * sample_size, RT_MEMCPY_HOST_TO_DEVICE));
+  return SUCCESS;
+}
+
+Status DynamicBatchCoalescer::ScatterOutput(const std::vector<Request> &batch, const size_t output_index) const {
+  const uint64_t sample_size = option_.output_sample_sizes[output_index];
+  const uint8_t *const base = static_cast<const uint8_t *>(output_buffers_[output_index]);
+  if (!option_.host_buffers) {
+    for (size_t j = 0U; j < batch.size(); ++j) {
+      GE_CHK_RT_RET(rtMemcpy(batch[j].outputs[output_index].data, batch[j].outputs[output_index].length,
+                             base + (j * sample_size), sample_size, RT_MEMCPY_DEVICE_TO_DEVICE));
+    }
+    return SUCCESS;
+  }
+  uint8_t *const staging = static_cast<uint8_t *>(output_staging_[output_index]);
+  const uint64_t len = batch.size() * sample_size;
+  GE_CHK_RT_RET(rtMemcpy(staging, len, base, len, RT_MEMCPY_DEVICE_TO_HOST));
+  for (size_t j = 0U; j < batch.size(); ++j) {
+    GE_CHK_BOOL_RET_STATUS(memcpy_s(batch[j].outputs[output_index].data, batch[j].outputs[output_index].length,
+                                    staging + (j * sample_size), sample_size) == EOK, FAILED,
+                           "[Copy][Output] Scatter output %zu to request %zu failed.", output_index, j);
+  }
+  return SUCCESS;
+}
+
+Status DynamicBatchCoalescer::RunBatch(const std::vector<Request> &batch, const size_t gear_index) {
+  const auto start = Clock::now();
+  const uint64_t gear = gears_[gear_index];
+  RunModelData input_data;
+  input_data.index = 0U;
+  input_data.modelId = option_.model_id;
+  input_data.timestamp = 0U;
+  input_data.timeout = 0U;
+  input_data.dynamic_batch_size = gear;
+  for (size_t i = 0U; i < input_buffers_.size(); ++i) {
+    GE_CHK_STATUS_RET_NOLOG(PackInput(batch, i, gear));
+    input_data.blobs.emplace_back(DataBuffer(input_buffers_[i], gear * option_.input_sample_sizes[i]));
+  }
+  // the gear is selected by the extra dynamic batch input, after the model inputs
+  GE_CHK_STATUS_RET(executor_.SetDynamicBatchSize(option_.model_id, dynamic_input_, option_.dynamic_input_size, gear),
+                    "[Set][DynamicBatchSize] Set batch %lu of model %u failed.", gear, option_.model_id);
+  input_data.blobs.emplace_back(DataBuffer(dynamic_input_, option_.dynamic_input_size));
+  RunModelData output_data;
+  output_data.index = 0U;
+  output_data.modelId = option_.model_id;
+  output_data.timestamp = 0U;
+  output_data.timeout = 0U;
+  for (size_t i = 0U; i < output_buffers_.size(); ++i) {
+    output_data.blobs.emplace_back(DataBuffer(output_buffers_[i], gear * option_.output_sample_sizes[i]));
+  }
+
+  GE_CHK_STATUS_RET(executor_.ExecModel(option_.model_id, option_.stream, input_data, output_data, false),
+                    "[Exec][Model] Execute model %u with batch %lu failed.", option_.model_id, gear);
+
+  for (size_t i = 0U; i < output_buffers_.size(); ++i) {
+    GE_CHK_STATUS_RET_NOLOG(ScatterOutput(batch, i));
+  }
+  const double exec_us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+  UpdateCost(gear_index, batch.size(), exec_us);
+  GELOGD("Model %u executed %zu requests with batch %lu in %.1f us.", option_.model_id, batch.size(), gear, exec_us);
+  return SUCCESS;
+}
+
+void DynamicBatchCoalescer::UpdateCost(const size_t gear_index, const size_t sample_num, const double exec_us) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  if (!cost_measured_) {
+    // scale the estimates of all gears by the first measurement, so the gears stay comparable
+    const double sample_cost = exec_us / static_cast<double>(gears_[gear_index]);
+    for (size_t i = 0U; i < gears_.size(); ++i) {
+      gear_cost_us_[i] = sample_cost * static_cast<double>(gears_[i]);
+    }
+    cost_measured_ = true;
+  }
+  BatchGearStat &stat = gear_stats_[gear_index];
+  gear_cost_us_[gear_index] = (stat.exec_count == 0U) ? exec_us :
+                              (((1.0 - kCostSmoothing) * gear_cost_us_[gear_index]) + (kCostSmoothing * exec_us));
+  ++stat.exec_count;
+  stat.padded_samples += gears_[gear_index] - sample_num;
+  stat.avg_exec_us = gear_cost_us_[gear_index];
+}
+
+std::vector<BatchGearStat> DynamicBatchCoalescer::GetGearStats() const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return gear_stats_;
+}
+}  // namespace ge
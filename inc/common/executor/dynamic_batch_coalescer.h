@@ -0,0 +1,125 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_COMMON_EXECUTOR_DYNAMIC_BATCH_COALESCER_H_
+#define GE_COMMON_EXECUTOR_DYNAMIC_BATCH_COALESCER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "framework/executor/ge_executor.h"
+
+namespace ge {
+struct DynamicBatchCoalescerOption {
+  uint32_t model_id = 0U;
+  void *stream = nullptr;
+  // bytes of one sample of every model input / output, the batch dim is the outermost one
+  std::vector<uint64_t> input_sample_sizes;
+  std::vector<uint64_t> output_sample_sizes;
+  // bytes of the extra dynamic batch input the model gets after its inputs, at least the batch size itself
+  uint64_t dynamic_input_size = sizeof(uint64_t);
+  // longest time a request may wait in the queue plus the estimated execution of its batch
+  uint64_t latency_budget_us = 2000U;
+  size_t max_queue_depth = 1024U;
+  // the buffers of the requests are on the host, otherwise on the device; host requests are packed into a pinned
+  // host staging buffer and moved with one copy per input / output
+  bool host_buffers = true;
+};
+
+struct BatchGearStat {
+  uint64_t batch_size = 0U;
+  uint64_t exec_count = 0U;
+  uint64_t padded_samples = 0U;  // samples executed for padding only
+  double avg_exec_us = 0.0;      // moving average of pack + ExecModel + scatter
+};
+
+/// Serving side coalescer of single sample requests for models compiled with dynamic batch gears.
+/// Requests are queued and one dispatcher thread packs them contiguously into the input buffers of a gear, selects
+/// the gear by SetDynamicBatchSize on the dynamic batch input, runs ExecModel once and scatters the outputs back.
+/// The batch is dispatched when the queue reaches the largest gear or when waiting longer would break the latency
+/// budget of the oldest request; the gear is then chosen by SelectGear from the measured cost of every gear.
+class DynamicBatchCoalescer {
+ public:
+  using DoneCallback = std::function<void(const Status status)>;
+
+  explicit DynamicBatchCoalescer(GeExecutor &executor) : executor_(executor) {}
+  DynamicBatchCoalescer(const DynamicBatchCoalescer &) = delete;
+  DynamicBatchCoalescer &operator=(const DynamicBatchCoalescer &) = delete;
+  ~DynamicBatchCoalescer();
+
+  // reads the gears by GetDynamicBatchInfo, the model must be loaded with dynamic batch
+  Status Init(const DynamicBatchCoalescerOption &option);
+  // dispatches the queued requests and stops the dispatcher
+  Status Finalize();
+
+  // the buffers must stay valid until done is called, done is called on the dispatcher thread. FAILED when the queue
+  // is full, that error is deferred and reported by error_message::FlushDeferredErrors
+  Status Submit(const std::vector<DataBuffer> &inputs, const std::vector<DataBuffer> &outputs,
+                const DoneCallback &done);
+  // blocking Submit
+  Status Execute(const std::vector<DataBuffer> &inputs, const std::vector<DataBuffer> &outputs);
+
+  // index of the gear for the queue depth, gears ascending: the smallest gear holding the whole queue unless a
+  // smaller full gear is cheaper per sample
+  static size_t SelectGear(const std::vector<uint64_t> &gears, const std::vector<double> &gear_cost_us,
+                           const size_t queue_depth);
+
+  const std::vector<uint64_t> &GetGears() const {
+    return gears_;
+  }
+  std::vector<BatchGearStat> GetGearStats() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+  struct Request {
+    std::vector<DataBuffer> inputs;
+    std::vector<DataBuffer> outputs;
+    DoneCallback done;
+    Clock::time_point enqueue_time;
+  };
+
+  void DispatchLoop();
+  Status RunBatch(const std::vector<Request> &batch, const size_t gear_index);
+  Status PackInput(const std::vector<Request> &batch, const size_t input_index, const uint64_t gear) const;
+  Status ScatterOutput(const std::vector<Request> &batch, const size_t output_index) const;
+  void UpdateCost(const size_t gear_index, const size_t sample_num, const double exec_us);
+  void FreeBuffers();
+
+  GeExecutor &executor_;
+  DynamicBatchCoalescerOption option_;
+  std::vector<uint64_t> gears_;
+  std::vector<void *> input_buffers_;   // device, sized for the largest gear
+  std::vector<void *> output_buffers_;
+  std::vector<void *> input_staging_;   // pinned host, only for host buffers
+  std::vector<void *> output_staging_;
+  void *dynamic_input_ = nullptr;       // device, batch size written by SetDynamicBatchSize
+
+  mutable std::mutex mutex_;
+  std::condition_variable cond_;
+  std::deque<Request> queue_;
+  bool running_ = false;
+  std::thread dispatcher_;
+  std::vector<double> gear_cost_us_;    // estimated execution time of every gear
+  std::vector<BatchGearStat> gear_stats_;
+  bool cost_measured_ = false;
+};
+}  // namespace ge
+#endif  // GE_COMMON_EXECUTOR_DYNAMIC_BATCH_COALESCER_H_
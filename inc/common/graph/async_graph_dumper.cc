@@ -0,0 +1,280 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/graph/async_graph_dumper.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/debug/log.h"
+#include "google/protobuf/io/gzip_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl.h"
+#include "google/protobuf/text_format.h"
+#include "graph/model.h"
+#include "graph/model_serialize.h"
+#include "mmpa/mmpa_api.h"
+#include "proto/ge_ir.pb.h"
+
+namespace ge {
+namespace {
+constexpr size_t kDumpSeqWidth = 5U;
+constexpr int32_t kMaxCompressionLevel = 9;
+const std::string kDumpFilePrefix = "ge_proto_";
+const std::string kDumpFileSuffix = ".pb.gz";
+const std::string kSubgraphDumpSuffix = "_sub_graph_";
+
+// dump env of GraphUtils::DumpGEGraph
+constexpr char_t kDumpGeGraph[] = "DUMP_GE_GRAPH";
+constexpr char_t kDumpGraphLevel[] = "DUMP_GRAPH_LEVEL";
+constexpr int64_t kDumpGraphLevelNoSubgraph = 2;
+constexpr int64_t kDumpGraphLevelBuild = 3;
+constexpr int64_t kDumpGraphLevelPreRunBegin = 4;
+constexpr int32_t kDecimalBase = 10;
+const std::vector<std::string> kSubgraphDumpStrs = {"partition", "OptimizeSubGraph", "Aicpu", "sub_graph"};
+const std::string kDumpStrBuild = "Build";
+const std::string kDumpStrPreRunBegin = "PreRunBegin";
+
+int64_t GetEnvLevel(const char_t *const name, const int64_t default_level) {
+  char_t value[MMPA_MAX_PATH] = {'\0'};
+  if ((mmGetEnv(name, &value[0], static_cast<uint32_t>(MMPA_MAX_PATH)) != EN_OK) || (value[0] == '\0')) {
+    return default_level;
+  }
+  return static_cast<int64_t>(std::strtol(&value[0], nullptr, kDecimalBase));
+}
+
+// same filter as GraphUtils::DumpGEGraph, NO_DUMP when the graph of suffix is not dumped
+DumpLevel GetDumpLevel(const std::string &suffix) {
+  const int64_t dump_level = GetEnvLevel(kDumpGeGraph, static_cast<int64_t>(DumpLevel::NO_DUMP));
+  if ((dump_level <= static_cast<int64_t>(DumpLevel::NO_DUMP)) ||
+      (dump_level >= static_cast<int64_t>(DumpLevel::DUMP_LEVEL_END))) {
+    return DumpLevel::NO_DUMP;
+  }
+  // any other DUMP_GRAPH_LEVEL dumps all graphs
+  const int64_t graph_level = GetEnvLevel(kDumpGraphLevel, kDumpGraphLevelNoSubgraph);
+  bool skipped = false;
+  if (graph_level == kDumpGraphLevelNoSubgraph) {
+    skipped = std::any_of(kSubgraphDumpStrs.begin(), kSubgraphDumpStrs.end(), [&suffix](const std::string &str) {
+      return suffix.find(str) != std::string::npos;
+    });
+  } else if (graph_level == kDumpGraphLevelBuild) {
+    skipped = (suffix != kDumpStrBuild);
+  } else if (graph_level == kDumpGraphLevelPreRunBegin) {
+    skipped = (suffix != kDumpStrPreRunBegin);
+  }
+  return skipped ? DumpLevel::NO_DUMP : static_cast<DumpLevel>(dump_level);
+}
+
+// DUMP_WITH_OUT_DESC keeps the nodes and their relations only
+void RemoveDescs(proto::ModelDef &model_def) {
+  for (auto &graph_def : *model_def.mutable_graph()) {
+    for (auto &op_def : *graph_def.mutable_op()) {
+      op_def.clear_input_desc();
+      op_def.clear_output_desc();
+      op_def.clear_attr();
+    }
+  }
+}
+
+std::string GetDumpFilePath(const std::string &dump_path, const uint32_t seq, const std::string &suffix) {
+  std::string seq_str = std::to_string(seq);
+  if (seq_str.size() < kDumpSeqWidth) {
+    (void)seq_str.insert(0U, kDumpSeqWidth - seq_str.size(), '0');
+  }
+  std::string file_path = dump_path;
+  if ((!file_path.empty()) && (file_path.back() != '/')) {
+    file_path += "/";
+  }
+  return file_path + kDumpFilePrefix + seq_str + "_" + suffix + kDumpFileSuffix;
+}
+
+Status ReadModelDef(const std::string &dump_file, proto::ModelDef &model_def) {
+  std::ifstream ifs(dump_file, std::ios::in | std::ios::binary);
+  GE_CHK_BOOL_RET_STATUS(ifs.is_open(), FAILED, "[Open][File]%s failed.", dump_file.c_str());
+  google::protobuf::io::IstreamInputStream input_stream(&ifs);
+  google::protobuf::io::GzipInputStream gzip_stream(&input_stream);
+  GE_CHK_BOOL_RET_STATUS(model_def.ParseFromZeroCopyStream(&gzip_stream), FAILED,
+                         "[Parse][ModelDef]from %s failed.", dump_file.c_str());
+  return SUCCESS;
+}
+}  // namespace
+
+AsyncGraphDumper &AsyncGraphDumper::Instance() {
+  static AsyncGraphDumper instance;
+  return instance;
+}
+
+AsyncGraphDumper::~AsyncGraphDumper() {
+  Finalize();
+}
+
+Status AsyncGraphDumper::Init(const AsyncDumpOption &option) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  if (running_.load()) {
+    GELOGW("[Init][AsyncGraphDumper]already running, option is ignored.");
+    return SUCCESS;
+  }
+  GE_CHK_BOOL_RET_STATUS((option.queue_capacity > 0U) && (option.compression_level >= 0) &&
+                         (option.compression_level <= kMaxCompressionLevel), PARAM_INVALID,
+                         "[Check][Param]queue capacity %zu or compression level %d is invalid.",
+                         option.queue_capacity, option.compression_level);
+  option_ = option;
+  queue_.SetMaxSize(static_cast<uint32_t>(option.queue_capacity));
+  queue_.Restart();
+  dropped_num_.store(0U);
+  writer_ = std::thread(&AsyncGraphDumper::WriterLoop, this);
+  running_.store(true);
+  GELOGI("Async graph dumper started, path [%s], queue capacity %zu, drop policy %u.", option_.dump_path.c_str(),
+         option_.queue_capacity, static_cast<uint32_t>(option_.drop_policy));
+  return SUCCESS;
+}
+
+void AsyncGraphDumper::Finalize() {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  if (!running_.exchange(false)) {
+    return;
+  }
+  queue_.Stop();
+  if (writer_.joinable()) {
+    writer_.join();
+  }
+  // the writer stops at once, the snapshots left are written here so none is lost
+  for (const auto &task : queue_.GetRemainItems()) {
+    (void)WriteDumpFile(task);
+  }
+  queue_.Clear();
+  GELOGI("Async graph dumper stopped, dropped snapshot num %lu.", dropped_num_.load());
+}
+
+Status AsyncGraphDumper::Dump(const ComputeGraphPtr &graph, const std::string &suffix) {
+  GE_CHECK_NOTNULL(graph);
+  GE_CHK_BOOL_RET_STATUS(running_.load(), FAILED, "[Check][Param]async graph dumper is not running.");
+  DumpTask task;
+  task.dump_level = GetDumpLevel(suffix);
+  if (task.dump_level == DumpLevel::NO_DUMP) {
+    return SUCCESS;
+  }
+  GE_CHK_GRAPH_STATUS_RET(GraphUtils::CopyComputeGraph(graph, task.graph), "[Copy][Graph]%s failed.",
+                          graph->GetName().c_str());
+  GE_CHECK_NOTNULL(task.graph);
+  task.suffix = suffix;
+  task.file_path = GetDumpFilePath(option_.dump_path, dump_seq_++, suffix);
+
+  switch (option_.drop_policy) {
+    case DumpDropPolicy::kBlock:
+      GE_CHK_BOOL_RET_STATUS(queue_.Push(std::move(task), true), FAILED, "[Push][Snapshot]of graph %s failed.",
+                             graph->GetName().c_str());
+      break;
+    case DumpDropPolicy::kDropOldest:
+      while (!queue_.Push(task, false)) {
+        GE_CHK_BOOL_RET_STATUS(running_.load(), FAILED, "[Check][Param]async graph dumper is stopped.");
+        DumpTask oldest;
+        if (queue_.Pop(oldest, 0)) {
+          GELOGW("[Dump][Graph]queue is full, snapshot %s is dropped.", oldest.file_path.c_str());
+          ++dropped_num_;
+        }
+      }
+      break;
+    default:
+      if (!queue_.Push(std::move(task), false)) {
+        GELOGW("[Dump][Graph]queue is full, snapshot of graph %s is dropped.", graph->GetName().c_str());
+        ++dropped_num_;
+      }
+      break;
+  }
+  return SUCCESS;
+}
+
+void AsyncGraphDumper::WriterLoop() {
+  (void)mmSetCurrentThreadName("ge_graph_dump");
+  DumpTask task;
+  while (queue_.Pop(task)) {
+    (void)WriteDumpFile(task);
+    task.graph.reset();
+  }
+}
+
+Status AsyncGraphDumper::WriteDumpFile(const DumpTask &task) const {
+  // GE_DUMP writes the onnx files of the graph and of every subgraph too
+  GraphUtils::DumpGEGraphToOnnx(*task.graph, task.suffix);
+  uint64_t subgraph_index = 0U;
+  for (const auto &subgraph : task.graph->GetAllSubgraphs()) {
+    GraphUtils::DumpGEGraphToOnnx(*subgraph, task.suffix + kSubgraphDumpSuffix + std::to_string(subgraph_index++));
+  }
+
+  proto::ModelDef model_def;
+  Model model(task.graph->GetName(), "");
+  model.SetGraph(task.graph);
+  if (ModelSerialize().SerializeModel(model, task.dump_level != DumpLevel::DUMP_ALL, model_def) != SUCCESS) {
+    GELOGW("[Serialize][Graph]%s failed, the snapshot is dropped.", task.graph->GetName().c_str());
+    return FAILED;
+  }
+  if (task.dump_level == DumpLevel::DUMP_WITH_OUT_DESC) {
+    RemoveDescs(model_def);
+  }
+  std::ofstream ofs(task.file_path, std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!ofs.is_open()) {
+    GELOGW("[Open][File]%s failed, the snapshot is dropped.", task.file_path.c_str());
+    return FAILED;
+  }
+  {
+    google::protobuf::io::OstreamOutputStream output_stream(&ofs);
+    google::protobuf::io::GzipOutputStream::Options options;
+    options.compression_level = option_.compression_level;
+    google::protobuf::io::GzipOutputStream gzip_stream(&output_stream, options);
+    if ((!model_def.SerializeToZeroCopyStream(&gzip_stream)) || (!gzip_stream.Close())) {
+      GELOGW("[Write][File]%s failed.", task.file_path.c_str());
+      return FAILED;
+    }
+  }
+  GELOGD("Dump graph to %s.", task.file_path.c_str());
+  return SUCCESS;
+}
+
+Status AsyncGraphDumper::LoadDump(const std::string &dump_file, ComputeGraphPtr &graph) {
+  proto::ModelDef model_def;
+  GE_CHK_STATUS_RET_NOLOG(ReadModelDef(dump_file, model_def));
+  Model model;
+  GE_CHK_BOOL_RET_STATUS(ModelSerialize().UnserializeModel(model_def, model), FAILED,
+                         "[Unserialize][Model]from %s failed.", dump_file.c_str());
+  graph = model.GetGraph();
+  GE_CHECK_NOTNULL(graph);
+  return SUCCESS;
+}
+
+Status AsyncGraphDumper::ConvertToText(const std::string &dump_file, const std::string &text_file) {
+  proto::ModelDef model_def;
+  GE_CHK_STATUS_RET_NOLOG(ReadModelDef(dump_file, model_def));
+  std::string text;
+  GE_CHK_BOOL_RET_STATUS(google::protobuf::TextFormat::PrintToString(model_def, &text), FAILED,
+                         "[Print][Text]of %s failed.", dump_file.c_str());
+  std::ofstream ofs(text_file, std::ios::out | std::ios::trunc);
+  GE_CHK_BOOL_RET_STATUS(ofs.is_open(), FAILED, "[Open][File]%s failed.", text_file.c_str());
+  ofs << text;
+  GE_CHK_BOOL_RET_STATUS(ofs.good(), FAILED, "[Write][File]%s failed.", text_file.c_str());
+  return SUCCESS;
+}
+
+Status AsyncGraphDumper::ConvertToOnnx(const std::string &dump_file, const std::string &path,
+                                       const std::string &suffix) {
+  ComputeGraphPtr graph;
+  GE_CHK_STATUS_RET_NOLOG(LoadDump(dump_file, graph));
+  GraphUtils::DumpGrphToOnnx(*graph, path, suffix);
+  return SUCCESS;
+}
+}  // namespace ge
@@ -0,0 +1,116 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_COMMON_GRAPH_ASYNC_GRAPH_DUMPER_H_
+#define GE_COMMON_GRAPH_ASYNC_GRAPH_DUMPER_H_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "common/blocking_queue.h"
+#include "framework/common/ge_inner_error_codes.h"
+#include "graph/compute_graph.h"
+#include "graph/utils/graph_utils.h"
+
+/**
+ * Same as GE_DUMP, filtered by the same DUMP_GE_GRAPH and DUMP_GRAPH_LEVEL, but the calling thread only copies the
+ * graph; serialization, compression, file writing and the onnx dump run on the writer of AsyncGraphDumper.
+ * Falls back to GE_DUMP when the dumper is not started.
+ */
+#define GE_DUMP_ASYNC(compute_graph, name)                                                                             \
+  do {                                                                                                                 \
+    if (ge::AsyncGraphDumper::Instance().IsRunning()) {                                                                \
+      (void)ge::AsyncGraphDumper::Instance().Dump((compute_graph), (name));                                            \
+    } else {                                                                                                           \
+      GE_DUMP((compute_graph), (name));                                                                                \
+    }                                                                                                                  \
+  } while (false)
+
+namespace ge {
+// what Dump does when the queue is full
+enum class DumpDropPolicy : uint32_t {
+  kDropNewest = 0U,  // the new snapshot is dropped, the compiling thread never waits
+  kDropOldest = 1U,  // the oldest queued snapshot is dropped
+  kBlock = 2U        // the compiling thread waits for the writer, nothing is lost
+};
+
+struct AsyncDumpOption {
+  std::string dump_path;  // directory of the dump files, empty for the current directory
+  size_t queue_capacity = 16U;
+  DumpDropPolicy drop_policy = DumpDropPolicy::kDropNewest;
+  int32_t compression_level = 1;  // zlib level 0~9, fast compression by default
+};
+
+/// Background dumper of graphs.
+/// Dump skips the graphs GraphUtils::DumpGEGraph would skip, takes a snapshot (a copy of the graph with its
+/// subgraphs) of the others and queues it. The writer thread serializes the snapshot into
+/// ge_proto_<seq>_<suffix>.pb.gz, without weights unless DUMP_GE_GRAPH is 1 and without descs and attrs when it
+/// is 3, and writes the onnx files of GraphUtils::DumpGEGraphToOnnx. Binary proto plus gzip is several times
+/// smaller and faster to produce than the text dump. ConvertToText and ConvertToOnnx turn a dump file back into the
+/// formats of GraphUtils::DumpGEGraph and GraphUtils::DumpGEGraphToOnnx offline.
+class AsyncGraphDumper {
+ public:
+  static AsyncGraphDumper &Instance();
+
+  AsyncGraphDumper(const AsyncGraphDumper &) = delete;
+  AsyncGraphDumper &operator=(const AsyncGraphDumper &) = delete;
+
+  Status Init(const AsyncDumpOption &option);
+  // writes all queued snapshots and stops the writer
+  void Finalize();
+
+  bool IsRunning() const {
+    return running_.load();
+  }
+
+  // SUCCESS also when the graph is not dumped by the dump env or the snapshot is dropped by the drop policy
+  Status Dump(const ComputeGraphPtr &graph, const std::string &suffix);
+
+  uint64_t GetDroppedNum() const {
+    return dropped_num_.load();
+  }
+
+  static Status LoadDump(const std::string &dump_file, ComputeGraphPtr &graph);
+  static Status ConvertToText(const std::string &dump_file, const std::string &text_file);
+  static Status ConvertToOnnx(const std::string &dump_file, const std::string &path, const std::string &suffix);
+
+ private:
+  struct DumpTask {
+    ComputeGraphPtr graph;  // private copy, the dumped graph may change after Dump returns
+    std::string suffix;
+    DumpLevel dump_level = DumpLevel::DUMP_ALL;
+    std::string file_path;
+  };
+
+  AsyncGraphDumper() = default;
+  ~AsyncGraphDumper();
+
+  void WriterLoop();
+  Status WriteDumpFile(const DumpTask &task) const;
+
+  AsyncDumpOption option_;
+  std::mutex mutex_;  // guards Init and Finalize
+  BlockingQueue<DumpTask> queue_;
+  std::thread writer_;
+  std::atomic<bool> running_{false};
+  std::atomic<uint32_t> dump_seq_{0U};
+  std::atomic<uint64_t> dropped_num_{0U};
+};
+}  // namespace ge
+#endif  // GE_COMMON_GRAPH_ASYNC_GRAPH_DUMPER_H_
@@ -0,0 +1,229 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/graph/cow_graph_clone.h"
+
+#include <vector>
+
+#include "common/util/mem_utils.h"
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/debug/log.h"
+#include "graph/utils/graph_utils.h"
+
+namespace ge {
+namespace {
+NodePtr FindNewNode(const std::map<const Node *, NodePtr> &node_old_2_new, const Node *const old_node) {
+  const auto iter = node_old_2_new.find(old_node);
+  return (iter == node_old_2_new.end()) ? nullptr : iter->second;
+}
+}  // namespace
+
+Status CowGraphClone::Create(const ComputeGraphPtr &src_graph, std::unique_ptr<CowGraphClone> &clone) {
+  GE_CHECK_NOTNULL(src_graph);
+  std::unique_ptr<CowGraphClone> new_clone(new (std::nothrow) CowGraphClone());
+  GE_CHECK_NOTNULL(new_clone);
+  GE_CHK_STATUS_RET(new_clone->CloneGraph(src_graph, nullptr, nullptr, new_clone->graph_),
+                    "[Clone][Graph]%s failed.", src_graph->GetName().c_str());
+  GELOGD("Clone graph %s with %zu shared op descs.", src_graph->GetName().c_str(), new_clone->shared_nodes_.size());
+  clone = std::move(new_clone);
+  return SUCCESS;
+}
+
+Status CowGraphClone::CloneGraph(const ComputeGraphPtr &src_graph, const ComputeGraphPtr &parent_graph,
+                                 const NodePtr &parent_node, ComputeGraphPtr &dst_graph) {
+  dst_graph = MakeShared<ComputeGraph>(src_graph->GetName());
+  GE_CHECK_NOTNULL(dst_graph);
+  if (root_graph_ == nullptr) {
+    root_graph_ = dst_graph;
+  }
+  std::map<const Node *, NodePtr> node_old_2_new;
+  GE_CHK_STATUS_RET(CloneNodes(src_graph, dst_graph, node_old_2_new), "[Clone][Nodes]of graph %s failed.",
+                    src_graph->GetName().c_str());
+  GE_CHK_STATUS_RET(CloneEdges(src_graph, node_old_2_new), "[Clone][Edges]of graph %s failed.",
+                    src_graph->GetName().c_str());
+  CloneGraphInfo(src_graph, node_old_2_new, dst_graph);
+  if (parent_graph != nullptr) {
+    dst_graph->SetParentGraph(parent_graph);
+    dst_graph->SetParentNode(parent_node);
+    GE_CHK_GRAPH_STATUS_RET(root_graph_->AddSubgraph(dst_graph->GetName(), dst_graph),
+                            "[Add][Subgraph]%s to root graph %s failed.", dst_graph->GetName().c_str(),
+                            root_graph_->GetName().c_str());
+  }
+
+  // subgraphs are registered in the root graph of the source
+  const ComputeGraphPtr src_root_graph = GraphUtils::FindRootGraph(src_graph);
+  GE_CHECK_NOTNULL(src_root_graph);
+  for (const auto &src_node : src_graph->GetDirectNode()) {
+    for (const std::string &name : src_node->GetOpDesc()->GetSubgraphInstanceNames()) {
+      if (name.empty()) {
+        continue;
+      }
+      const ComputeGraphPtr src_subgraph = src_root_graph->GetSubgraph(name);
+      if (src_subgraph == nullptr) {
+        GELOGE(FAILED, "[Find][Subgraph]%s of node %s is not in root graph %s.", name.c_str(),
+               src_node->GetName().c_str(), src_root_graph->GetName().c_str());
+        return FAILED;
+      }
+      ComputeGraphPtr dst_subgraph;
+      GE_CHK_STATUS_RET(CloneGraph(src_subgraph, dst_graph, FindNewNode(node_old_2_new, src_node.get()),
+                                   dst_subgraph), "[Clone][Subgraph]%s failed.", name.c_str());
+    }
+  }
+  return SUCCESS;
+}
+
+Status CowGraphClone::CloneNodes(const ComputeGraphPtr &src_graph, const ComputeGraphPtr &dst_graph,
+                                 std::map<const Node *, NodePtr> &node_old_2_new) {
+  for (const auto &src_node : src_graph->GetDirectNode()) {
+    const OpDescPtr op_desc = src_node->GetOpDesc();
+    GE_CHECK_NOTNULL(op_desc);
+    // the id of the source is passed so that adding the node writes back the value it already has
+    const NodePtr dst_node = dst_graph->AddNode(op_desc, op_desc->GetId());
+    if (dst_node == nullptr) {
+      GELOGE(FAILED, "[Add][Node]%s to graph %s failed.", src_node->GetName().c_str(), dst_graph->GetName().c_str());
+      return FAILED;
+    }
+    node_old_2_new[src_node.get()] = dst_node;
+    shared_nodes_[dst_node.get()] = src_node;
+    src_nodes_[dst_node.get()] = src_node;
+  }
+  return SUCCESS;
+}
+
+Status CowGraphClone::CloneEdges(const ComputeGraphPtr &src_graph,
+                                 const std::map<const Node *, NodePtr> &node_old_2_new) {
+  for (const auto &src_node : src_graph->GetDirectNode()) {
+    const NodePtr dst_node = FindNewNode(node_old_2_new, src_node.get());
+    GE_CHECK_NOTNULL(dst_node);
+    for (const auto &out_anchor : src_node->GetAllOutDataAnchors()) {
+      const auto dst_out_anchor = dst_node->GetOutDataAnchor(out_anchor->GetIdx());
+      GE_CHECK_NOTNULL(dst_out_anchor);
+      for (const auto &peer_in_anchor : out_anchor->GetPeerInDataAnchors()) {
+        const NodePtr peer_node = FindNewNode(node_old_2_new, peer_in_anchor->GetOwnerNodeBarePtr());
+        GE_CHECK_NOTNULL(peer_node);
+        const auto dst_in_anchor = peer_node->GetInDataAnchor(peer_in_anchor->GetIdx());
+        GE_CHK_GRAPH_STATUS_RET(GraphUtils::AddEdge(dst_out_anchor, dst_in_anchor),
+                                "[Add][DataEdge]%s:%d -> %s:%d failed.", dst_node->GetName().c_str(),
+                                out_anchor->GetIdx(), peer_node->GetName().c_str(), peer_in_anchor->GetIdx());
+      }
+      for (const auto &peer_in_ctrl_anchor : out_anchor->GetPeerInControlAnchors()) {
+        const NodePtr peer_node = FindNewNode(node_old_2_new, peer_in_ctrl_anchor->GetOwnerNodeBarePtr());
+        GE_CHECK_NOTNULL(peer_node);
+        GE_CHK_GRAPH_STATUS_RET(GraphUtils::AddEdge(dst_out_anchor, peer_node->GetInControlAnchor()),
+                                "[Add][DataCtrlEdge]%s -> %s failed.", dst_node->GetName().c_str(),
+                                peer_node->GetName().c_str());
+      }
+    }
+    for (const auto &peer_in_ctrl_anchor : src_node->GetOutControlAnchor()->GetPeerInControlAnchors()) {
+      const NodePtr peer_node = FindNewNode(node_old_2_new, peer_in_ctrl_anchor->GetOwnerNodeBarePtr());
+      GE_CHECK_NOTNULL(peer_node);
+      GE_CHK_GRAPH_STATUS_RET(GraphUtils::AddEdge(dst_node->GetOutControlAnchor(), peer_node->GetInControlAnchor()),
+                              "[Add][CtrlEdge]%s -> %s failed.", dst_node->GetName().c_str(),
+                              peer_node->GetName().c_str());
+    }
+  }
+  return SUCCESS;
+}
+
+void CowGraphClone::CloneGraphInfo(const ComputeGraphPtr &src_graph,
+                                   const std::map<const Node *, NodePtr> &node_old_2_new,
+                                   const ComputeGraphPtr &dst_graph) {
+  for (const auto &input_node : src_graph->GetInputNodes()) {
+    const NodePtr dst_node = FindNewNode(node_old_2_new, input_node.get());
+    if (dst_node != nullptr) {
+      (void) dst_graph->AddInputNode(dst_node);
+    }
+  }
+  std::vector<std::pair<NodePtr, int32_t>> out_nodes_info;
+  for (const auto &out_node_info : src_graph->GetGraphOutNodesInfo()) {
+    const NodePtr dst_node = FindNewNode(node_old_2_new, out_node_info.first.get());
+    if (dst_node != nullptr) {
+      out_nodes_info.emplace_back(dst_node, out_node_info.second);
+    }
+  }
+  dst_graph->SetGraphOutNodesInfo(out_nodes_info);
+  dst_graph->SetInputSize(src_graph->GetInputSize());
+  dst_graph->SetOutputSize(src_graph->GetOutputSize());
+  dst_graph->SetSessionID(src_graph->GetSessionID());
+  dst_graph->SetGraphID(src_graph->GetGraphID());
+  dst_graph->SetGraphUnknownFlag(src_graph->GetGraphUnknownFlag());
+  dst_graph->SetNeedIteration(src_graph->GetNeedIteration());
+  ComputeGraphPtr inherit_graph = dst_graph;
+  GraphUtils::InheritOriginalAttr(src_graph, inherit_graph);
+}
+
+OpDescPtr CowGraphClone::MutableOpDesc(const NodePtr &node) {
+  if (node == nullptr) {
+    return nullptr;
+  }
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return MaterializeLocked(node);
+}
+
+OpDescPtr CowGraphClone::MaterializeLocked(const NodePtr &node) {
+  const auto iter = shared_nodes_.find(node.get());
+  if (iter == shared_nodes_.end()) {
+    return node->GetOpDesc();
+  }
+  const OpDescPtr op_desc = MakeShared<OpDesc>(*node->GetOpDesc());
+  if (op_desc == nullptr) {
+    GELOGE(FAILED, "[Copy][OpDesc]of node %s failed.", node->GetName().c_str());
+    return nullptr;
+  }
+  if (node->UpdateOpDesc(op_desc) != GRAPH_SUCCESS) {
+    GELOGE(FAILED, "[Update][OpDesc]of node %s failed.", node->GetName().c_str());
+    return nullptr;
+  }
+  (void) shared_nodes_.erase(iter);
+  return op_desc;
+}
+
+ConstOpDescPtr CowGraphClone::GetOpDesc(const NodePtr &node) const {
+  return (node == nullptr) ? nullptr : node->GetOpDesc();
+}
+
+bool CowGraphClone::IsShared(const NodePtr &node) const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return shared_nodes_.count(node.get()) > 0U;
+}
+
+Status CowGraphClone::MaterializeAll() {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<NodePtr> nodes;
+  nodes.reserve(shared_nodes_.size());
+  for (const auto &node : graph_->GetAllNodes()) {
+    if (shared_nodes_.count(node.get()) > 0U) {
+      nodes.emplace_back(node);
+    }
+  }
+  for (const auto &node : nodes) {
+    GE_CHECK_NOTNULL(MaterializeLocked(node));
+  }
+  GELOGD("Materialize %zu op descs of graph %s.", nodes.size(), graph_->GetName().c_str());
+  return SUCCESS;
+}
+
+NodePtr CowGraphClone::GetSrcNode(const NodePtr &node) const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  const auto iter = src_nodes_.find(node.get());
+  return (iter == src_nodes_.end()) ? nullptr : iter->second;
+}
+
+size_t CowGraphClone::GetSharedNum() const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return shared_nodes_.size();
+}
+}  // namespace ge
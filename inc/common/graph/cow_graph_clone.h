@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_COMMON_GRAPH_COW_GRAPH_CLONE_H_
+#define GE_COMMON_GRAPH_COW_GRAPH_CLONE_H_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "framework/common/ge_inner_error_codes.h"
+#include "graph/compute_graph.h"
+#include "graph/node.h"
+#include "graph/op_desc.h"
+
+namespace ge {
+/// Copy-on-write counterpart of GraphUtils::CopyComputeGraph.
+/// The topology (nodes, anchors, edges, subgraphs, graph attrs) of the clone is private, while every cloned node
+/// shares the OpDesc of its source node. The first MutableOpDesc() call of a node copies the OpDesc with its copy
+/// constructor (which keeps tensor descs and the attr store) and rebinds the node, so the cost of a clone grows
+/// with the number of nodes changed instead of the size of the graph.
+/// Contract: the OpDesc of a cloned node is read only until MutableOpDesc() is called for that node. Passes which
+/// are not aware of the clone (including TopologicalSorting, which writes op ids) must run after
+/// MaterializeAll(). The source graph must not be modified while the clone still shares its OpDescs.
+class CowGraphClone {
+ public:
+  static Status Create(const ComputeGraphPtr &src_graph, std::unique_ptr<CowGraphClone> &clone);
+
+  ~CowGraphClone() = default;
+  CowGraphClone(const CowGraphClone &) = delete;
+  CowGraphClone &operator=(const CowGraphClone &) = delete;
+
+  const ComputeGraphPtr &GetGraph() const {
+    return graph_;
+  }
+
+  // returns a private OpDesc of a node of the clone, copying the shared one on first call
+  OpDescPtr MutableOpDesc(const NodePtr &node);
+
+  // shared OpDesc of a node of the clone, must not be modified
+  ConstOpDescPtr GetOpDesc(const NodePtr &node) const;
+
+  bool IsShared(const NodePtr &node) const;
+
+  // copies every OpDesc that is still shared, the clone is then equal to a deep copy
+  Status MaterializeAll();
+
+  NodePtr GetSrcNode(const NodePtr &node) const;
+
+  size_t GetSharedNum() const;
+
+ private:
+  CowGraphClone() = default;
+
+  Status CloneGraph(const ComputeGraphPtr &src_graph, const ComputeGraphPtr &parent_graph,
+                    const NodePtr &parent_node, ComputeGraphPtr &dst_graph);
+  Status CloneNodes(const ComputeGraphPtr &src_graph, const ComputeGraphPtr &dst_graph,
+                    std::map<const Node *, NodePtr> &node_old_2_new);
+  static Status CloneEdges(const ComputeGraphPtr &src_graph, const std::map<const Node *, NodePtr> &node_old_2_new);
+  static void CloneGraphInfo(const ComputeGraphPtr &src_graph, const std::map<const Node *, NodePtr> &node_old_2_new,
+                             const ComputeGraphPtr &dst_graph);
+  OpDescPtr MaterializeLocked(const NodePtr &node);
+
+  ComputeGraphPtr graph_;
+  ComputeGraphPtr root_graph_;
+  mutable std::mutex mutex_;
+  // cloned node -> source node, only for the nodes which still share the OpDesc of the source
+  std::unordered_map<const Node *, NodePtr> shared_nodes_;
+  std::unordered_map<const Node *, NodePtr> src_nodes_;
+};
+}  // namespace ge
+#endif  // GE_COMMON_GRAPH_COW_GRAPH_CLONE_H_
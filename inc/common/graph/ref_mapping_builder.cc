@@ -0,0 +1,283 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/graph/ref_mapping_builder.h"
+
+#include <algorithm>
+
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/debug/log.h"
+#include "framework/common/types.h"
+#include "graph/debug/ge_attr_define.h"
+#include "graph/utils/attr_utils.h"
+
+namespace ge {
+namespace {
+bool IsMergeType(const std::string &type) {
+  return (type == MERGE) || (type == REFMERGE) || (type == STREAMMERGE);
+}
+}  // namespace
+
+Status RefMappingBuilder::Build(const ComputeGraphPtr &graph) {
+  GE_CHECK_NOTNULL(graph);
+  anchors_.clear();
+  node_ranges_.clear();
+  const auto all_nodes = graph->GetAllNodes();
+  for (const auto &node : all_nodes) {
+    GE_CHECK_NOTNULL(node);
+    AddNodeAnchors(node);
+  }
+  parents_.resize(anchors_.size());
+  first_ids_.resize(anchors_.size());
+  ranks_.assign(anchors_.size(), 0U);
+  for (size_t i = 0U; i < anchors_.size(); ++i) {
+    parents_[i] = static_cast<uint32_t>(i);
+    first_ids_[i] = static_cast<uint32_t>(i);
+  }
+
+  for (const auto &node : all_nodes) {
+    GE_CHK_STATUS_RET(UnionNodeAnchors(node), "[Union][Anchors]of node %s failed.", node->GetName().c_str());
+  }
+  // flatten, all lookups after Build are a single index
+  for (size_t i = 0U; i < parents_.size(); ++i) {
+    (void)Find(static_cast<uint32_t>(i));
+  }
+  GELOGD("Build ref mapping of graph %s, anchor num %zu, symbol num %zu.", graph->GetName().c_str(),
+         anchors_.size(), GetSymbolNum());
+  return SUCCESS;
+}
+
+void RefMappingBuilder::AddNodeAnchors(const NodePtr &node) {
+  NodeAnchorRange range{};
+  range.out_base = static_cast<uint32_t>(anchors_.size());
+  range.out_num = node->GetAllOutDataAnchorsSize();
+  for (uint32_t i = 0U; i < range.out_num; ++i) {
+    anchors_.push_back({node, i, kOut});
+  }
+  range.in_base = static_cast<uint32_t>(anchors_.size());
+  range.in_num = node->GetAllInDataAnchorsSize();
+  for (uint32_t i = 0U; i < range.in_num; ++i) {
+    anchors_.push_back({node, i, kIn});
+  }
+  node_ranges_[node.get()] = range;
+}
+
+Status RefMappingBuilder::UnionNodeAnchors(const NodePtr &node) {
+  for (const auto in_anchor : node->GetAllInDataAnchorsPtr()) {
+    GE_CHECK_NOTNULL(in_anchor);
+    const auto peer_out_anchor = in_anchor->GetPeerOutAnchor();
+    if (peer_out_anchor == nullptr) {
+      continue;
+    }
+    Union(GetAnchorId(node.get(), static_cast<uint32_t>(in_anchor->GetIdx()), kIn),
+          GetAnchorId(peer_out_anchor->GetOwnerNodeBarePtr(), static_cast<uint32_t>(peer_out_anchor->GetIdx()), kOut));
+  }
+  const std::string type = node->GetType();
+  if (type == DATA) {
+    GE_CHK_STATUS_RET_NOLOG(UnionSubgraphData(node));
+  } else if (type == NETOUTPUT) {
+    GE_CHK_STATUS_RET_NOLOG(UnionSubgraphNetOutput(node));
+  } else if (IsMergeType(type)) {
+    UnionMergeInputs(node);
+  }
+  UnionRefOutputs(node);
+  return SUCCESS;
+}
+
+Status RefMappingBuilder::UnionSubgraphData(const NodePtr &node) {
+  const auto owner_graph = node->GetOwnerComputeGraphBarePtr();
+  GE_CHECK_NOTNULL(owner_graph);
+  const Node *const parent_node = owner_graph->GetParentNodeBarePtr();
+  if (parent_node == nullptr) {
+    return SUCCESS;
+  }
+  uint32_t parent_index = 0U;
+  if (!AttrUtils::GetInt(node->GetOpDesc(), ATTR_NAME_PARENT_NODE_INDEX, parent_index)) {
+    return SUCCESS;
+  }
+  const int64_t parent_in_id = GetAnchorId(parent_node, parent_index, kIn);
+  GE_CHK_BOOL_RET_STATUS(parent_in_id != kInvalidId, FAILED, "[Check][Param]parent index %u of %s is invalid.",
+                         parent_index, node->GetName().c_str());
+  Union(GetAnchorId(node.get(), 0U, kOut), parent_in_id);
+  return SUCCESS;
+}
+
+Status RefMappingBuilder::UnionSubgraphNetOutput(const NodePtr &node) {
+  const auto owner_graph = node->GetOwnerComputeGraphBarePtr();
+  GE_CHECK_NOTNULL(owner_graph);
+  const Node *const parent_node = owner_graph->GetParentNodeBarePtr();
+  if (parent_node == nullptr) {
+    return SUCCESS;
+  }
+  const auto op_desc = node->GetOpDesc();
+  GE_CHECK_NOTNULL(op_desc);
+  for (uint32_t i = 0U; i < node->GetAllInDataAnchorsSize(); ++i) {
+    const auto input_desc = op_desc->GetInputDescPtr(i);
+    uint32_t parent_index = 0U;
+    if ((input_desc == nullptr) || (!AttrUtils::GetInt(input_desc, ATTR_NAME_PARENT_NODE_INDEX, parent_index))) {
+      continue;
+    }
+    const int64_t parent_out_id = GetAnchorId(parent_node, parent_index, kOut);
+    GE_CHK_BOOL_RET_STATUS(parent_out_id != kInvalidId, FAILED,
+                           "[Check][Param]parent index %u of input %u of %s is invalid.", parent_index, i,
+                           node->GetName().c_str());
+    Union(GetAnchorId(node.get(), i, kIn), parent_out_id);
+  }
+  return SUCCESS;
+}
+
+void RefMappingBuilder::UnionRefOutputs(const NodePtr &node) {
+  // the predicates GetRefMapping uses: pass-through nodes, ref and reuse-input outputs, no-padding continuous reuse
+  for (const auto &out_anchor : node->GetAllOutDataAnchors()) {
+    if (out_anchor == nullptr) {
+      continue;
+    }
+    int32_t in_index = -1;
+    if (GraphUtils::IsRefFromInput(out_anchor, in_index) || GraphUtils::IsNoPaddingRefFromInput(out_anchor, in_index)) {
+      Union(GetAnchorId(node.get(), static_cast<uint32_t>(out_anchor->GetIdx()), kOut),
+            (in_index >= 0) ? GetAnchorId(node.get(), static_cast<uint32_t>(in_index), kIn) : kInvalidId);
+    }
+  }
+}
+
+void RefMappingBuilder::UnionMergeInputs(const NodePtr &node) {
+  const int64_t out_id = GetAnchorId(node.get(), 0U, kOut);
+  for (const auto in_anchor : node->GetAllInDataAnchorsPtr()) {
+    if ((in_anchor != nullptr) && (in_anchor->GetPeerOutAnchor() != nullptr)) {
+      Union(out_id, GetAnchorId(node.get(), static_cast<uint32_t>(in_anchor->GetIdx()), kIn));
+    }
+  }
+}
+
+uint32_t RefMappingBuilder::Find(const uint32_t id) {
+  uint32_t root = id;
+  while (parents_[root] != root) {
+    root = parents_[root];
+  }
+  // path compression
+  uint32_t cur = id;
+  while (parents_[cur] != root) {
+    const uint32_t next = parents_[cur];
+    parents_[cur] = root;
+    cur = next;
+  }
+  return root;
+}
+
+void RefMappingBuilder::Union(const int64_t lhs, const int64_t rhs) {
+  if ((lhs == kInvalidId) || (rhs == kInvalidId)) {
+    return;
+  }
+  uint32_t lhs_root = Find(static_cast<uint32_t>(lhs));
+  uint32_t rhs_root = Find(static_cast<uint32_t>(rhs));
+  if (lhs_root == rhs_root) {
+    return;
+  }
+  if (ranks_[lhs_root] < ranks_[rhs_root]) {
+    std::swap(lhs_root, rhs_root);
+  } else if (ranks_[lhs_root] == ranks_[rhs_root]) {
+    ++ranks_[lhs_root];
+  }
+  parents_[rhs_root] = lhs_root;
+  first_ids_[lhs_root] = std::min(first_ids_[lhs_root], first_ids_[rhs_root]);
+}
+
+int64_t RefMappingBuilder::GetAnchorId(const Node *const node, const uint32_t index, const IOType io_type) const {
+  const auto iter = node_ranges_.find(node);
+  if (iter == node_ranges_.end()) {
+    return kInvalidId;
+  }
+  const NodeAnchorRange &range = iter->second;
+  if (io_type == kOut) {
+    return (index < range.out_num) ? static_cast<int64_t>(range.out_base + index) : kInvalidId;
+  }
+  return (index < range.in_num) ? static_cast<int64_t>(range.in_base + index) : kInvalidId;
+}
+
+int64_t RefMappingBuilder::GetSymbolId(const Node *const node, const uint32_t index, const IOType io_type) const {
+  const int64_t id = GetAnchorId(node, index, io_type);
+  return (id == kInvalidId) ? kInvalidId : static_cast<int64_t>(parents_[static_cast<size_t>(id)]);
+}
+
+bool RefMappingBuilder::IsSameSymbol(const NodeIndexIO &lhs, const NodeIndexIO &rhs) const {
+  const int64_t lhs_symbol = GetSymbolId(lhs.node_ptr_, lhs.index_, lhs.io_type_);
+  return (lhs_symbol != kInvalidId) && (lhs_symbol == GetSymbolId(rhs.node_ptr_, rhs.index_, rhs.io_type_));
+}
+
+Status RefMappingBuilder::GetSymbol(const NodeIndexIO &anchor, std::string &symbol) const {
+  const int64_t symbol_id = GetSymbolId(anchor.node_ptr_, anchor.index_, anchor.io_type_);
+  GE_CHK_BOOL_RET_STATUS(symbol_id != kInvalidId, PARAM_INVALID, "[Check][Param]anchor %s is not in the graph.",
+                         anchor.ToString().c_str());
+  const AnchorKey &first = anchors_[first_ids_[static_cast<size_t>(symbol_id)]];
+  symbol = NodeIndexIO(first.node, first.index, first.io_type).ToString();
+  return SUCCESS;
+}
+
+Status RefMappingBuilder::ToRefMapping(SymbolToAnchors &symbol_to_anchors, AnchorToSymbol &anchor_to_symbol) const {
+  std::vector<std::string> symbols(anchors_.size());
+  for (size_t i = 0U; i < anchors_.size(); ++i) {
+    const AnchorKey &key = anchors_[i];
+    const NodeIndexIO node_index_io(key.node, key.index, key.io_type);
+    std::string &symbol = symbols[parents_[i]];
+    if (symbol.empty()) {
+      // the first anchor of a set in id order is the one the symbol is named after
+      symbol = node_index_io.ToString();
+    }
+    anchor_to_symbol[node_index_io.ToString()] = symbol;
+    symbol_to_anchors[symbol].emplace_back(node_index_io);
+  }
+  return SUCCESS;
+}
+
+Status RefMappingBuilder::CheckAgainstRefMapping(const ComputeGraphPtr &graph) const {
+  GE_CHECK_NOTNULL(graph);
+  SymbolToAnchors symbol_to_anchors;
+  AnchorToSymbol anchor_to_symbol;
+  GE_CHK_GRAPH_STATUS_RET(GraphUtils::GetRefMapping(graph, symbol_to_anchors, anchor_to_symbol),
+                          "[Get][RefMapping]of graph %s failed.", graph->GetName().c_str());
+  // the same partition is a one to one mapping between the symbol ids and the symbols of GetRefMapping
+  std::unordered_map<int64_t, std::string> id_to_symbol;
+  std::unordered_map<std::string, int64_t> symbol_to_id;
+  for (size_t i = 0U; i < anchors_.size(); ++i) {
+    const AnchorKey &key = anchors_[i];
+    const std::string anchor = NodeIndexIO(key.node, key.index, key.io_type).ToString();
+    const auto iter = anchor_to_symbol.find(anchor);
+    if (iter == anchor_to_symbol.end()) {
+      // anchors without any edge are not in the maps of GetRefMapping
+      continue;
+    }
+    const int64_t symbol_id = static_cast<int64_t>(parents_[i]);
+    const auto id_iter = id_to_symbol.emplace(symbol_id, iter->second).first;
+    const auto symbol_iter = symbol_to_id.emplace(iter->second, symbol_id).first;
+    if ((id_iter->second != iter->second) || (symbol_iter->second != symbol_id)) {
+      GELOGE(FAILED, "[Check][RefMapping]anchor %s of graph %s is in symbol %s of GetRefMapping, which is split or "
+             "merged differently here.", anchor.c_str(), graph->GetName().c_str(), iter->second.c_str());
+      return FAILED;
+    }
+  }
+  return SUCCESS;
+}
+
+size_t RefMappingBuilder::GetSymbolNum() const {
+  size_t symbol_num = 0U;
+  for (size_t i = 0U; i < parents_.size(); ++i) {
+    if (parents_[i] == i) {
+      ++symbol_num;
+    }
+  }
+  return symbol_num;
+}
+}  // namespace ge
@@ -0,0 +1,101 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_COMMON_GRAPH_REF_MAPPING_BUILDER_H_
+#define GE_COMMON_GRAPH_REF_MAPPING_BUILDER_H_
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "framework/common/ge_inner_error_codes.h"
+#include "graph/compute_graph.h"
+#include "graph/utils/graph_utils.h"
+
+namespace ge {
+/// Symbol analysis of the tensors of a graph, i.e. which input and output anchors share one piece of memory.
+/// Groups the anchors as GraphUtils::GetRefMapping does: a consumer input shares with its peer output, an output
+/// shares with an input whenever GraphUtils::IsRefFromInput or IsNoPaddingRefFromInput says so (ref, reuse-input,
+/// pass-through and no-padding continuous outputs), Merge outputs with all inputs, subgraph Data outputs and NetOutput
+/// inputs with the parent node anchor of their parent index. CheckAgainstRefMapping verifies the grouping against
+/// GetRefMapping on a given graph.
+/// Every anchor of the graph and its subgraphs gets a dense id and the relation is kept in a union-find with
+/// path compression and union by rank, so one union is almost constant time instead of rewriting the string maps.
+/// The symbol of a set is the string of its first anchor in node order (normally the producing output). GetRefMapping
+/// may name a set after another of its anchors, e.g. for Merge, so symbols are compared by IsSameSymbol and not by
+/// their strings. Strings are only built when GetSymbol or ToRefMapping is called.
+class RefMappingBuilder {
+ public:
+  static constexpr int64_t kInvalidId = -1;
+
+  RefMappingBuilder() = default;
+  ~RefMappingBuilder() = default;
+
+  Status Build(const ComputeGraphPtr &graph);
+
+  // dense id of the anchor, kInvalidId if the node is not in the graph or the index is out of range
+  int64_t GetAnchorId(const Node *const node, const uint32_t index, const IOType io_type) const;
+
+  // id of the set of the anchor, equal ids mean the same memory
+  int64_t GetSymbolId(const Node *const node, const uint32_t index, const IOType io_type) const;
+
+  bool IsSameSymbol(const NodeIndexIO &lhs, const NodeIndexIO &rhs) const;
+
+  Status GetSymbol(const NodeIndexIO &anchor, std::string &symbol) const;
+
+  // maps in the form GraphUtils::GetRefMapping returns, anchors of a symbol are in node order
+  Status ToRefMapping(SymbolToAnchors &symbol_to_anchors, AnchorToSymbol &anchor_to_symbol) const;
+
+  // FAILED if the anchors of the built graph are grouped differently from GraphUtils::GetRefMapping, symbol names
+  // are not compared; meant for debugging and for checking the builder on sample graphs
+  Status CheckAgainstRefMapping(const ComputeGraphPtr &graph) const;
+
+  size_t GetAnchorNum() const {
+    return anchors_.size();
+  }
+
+  size_t GetSymbolNum() const;
+
+ private:
+  struct AnchorKey {
+    NodePtr node;
+    uint32_t index;
+    IOType io_type;
+  };
+  struct NodeAnchorRange {
+    uint32_t out_base;
+    uint32_t out_num;
+    uint32_t in_base;
+    uint32_t in_num;
+  };
+
+  void AddNodeAnchors(const NodePtr &node);
+  Status UnionNodeAnchors(const NodePtr &node);
+  Status UnionSubgraphData(const NodePtr &node);
+  Status UnionSubgraphNetOutput(const NodePtr &node);
+  void UnionRefOutputs(const NodePtr &node);
+  void UnionMergeInputs(const NodePtr &node);
+  uint32_t Find(const uint32_t id);
+  void Union(const int64_t lhs, const int64_t rhs);
+
+  std::vector<AnchorKey> anchors_;
+  std::unordered_map<const Node *, NodeAnchorRange> node_ranges_;
+  std::vector<uint32_t> parents_;  // flattened after Build, parents_[id] is the root
+  std::vector<uint8_t> ranks_;
+  std::vector<uint32_t> first_ids_;  // smallest id of the set, valid at the roots
+};
+}  // namespace ge
+#endif  // GE_COMMON_GRAPH_REF_MAPPING_BUILDER_H_
@@ -16,7 +16,89 @@
 
 #include "common/kernel_store.h"
 
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
 namespace ge {
+namespace {
+constexpr char_t kKernelIndexName[] = "__kernel_store_index__";
+// name length of the fence, readers without index support take it for a block exceeding the store and stop
+constexpr uint32_t kIndexFenceNameLen = UINT32_MAX;
+
+// index of a loaded store, kept in kernels_ under kKernelIndexName. Kernels are created from it on first lookup as
+// views of the store, copies of the store share it together with the kernels already created.
+class LazyKernelIndex : public OpKernelBin {
+ public:
+  LazyKernelIndex() : OpKernelBin(kKernelIndexName, std::vector<char>()) {}
+  const uint8_t *data = nullptr;  // the kernel items of the store, up to the fence
+  size_t data_len = 0U;
+  std::shared_ptr<const void> owner;  // keeps data alive, also held by every kernel created from the index
+  std::vector<KernelStoreIndexItem> items;
+  std::mutex mutex;
+  std::unordered_map<std::string, KernelBinPtr> kernels;
+};
+
+bool IsIndexName(const std::string &name) {
+  return (name.length() == (sizeof(kKernelIndexName) - 1U)) && (name == kKernelIndexName);
+}
+
+// FNV-1a, the value is persisted in the om file so it must not depend on std::hash
+uint64_t HashKernelName(const char *name, const size_t len) {
+  constexpr uint64_t kFnvOffsetBasis = 14695981039346656037ULL;
+  constexpr uint64_t kFnvPrime = 1099511628211ULL;
+  uint64_t hash = kFnvOffsetBasis;
+  for (size_t i = 0U; i < len; ++i) {
+    hash ^= static_cast<uint64_t>(static_cast<uint8_t>(name[i]));
+    hash *= kFnvPrime;
+  }
+  return hash;
+}
+
+bool AppendBytes(const void *data, const size_t len, uint8_t *&next_buffer, size_t &remain_len) {
+  if (len > 0U) {
+    GE_CHK_BOOL_EXEC_NOLOG(memcpy_s(next_buffer, remain_len, data, len) == EOK, return false);
+  }
+  next_buffer += len;
+  remain_len -= len;
+  return true;
+}
+
+bool AppendItem(const std::string &name, const void *bin, const size_t bin_len, uint8_t *&next_buffer,
+                size_t &remain_len) {
+  KernelStoreItemHead kernel_head{};
+  kernel_head.magic = kKernelItemMagic;
+  kernel_head.name_len = static_cast<uint32_t>(name.length());
+  kernel_head.bin_len = static_cast<uint32_t>(bin_len);
+  return AppendBytes(&kernel_head, sizeof(kernel_head), next_buffer, remain_len) &&
+         AppendBytes(name.data(), name.length(), next_buffer, remain_len) &&
+         AppendBytes(bin, bin_len, next_buffer, remain_len);
+}
+
+// the kernel item at offset of an index, nullptr if the item is invalid
+const KernelStoreItemHead *GetIndexedItem(const LazyKernelIndex &index, const size_t offset) {
+  if ((offset > index.data_len) || ((index.data_len - offset) < sizeof(KernelStoreItemHead))) {
+    GELOGW("Invalid kernel index offset %zu, buffer len %zu", offset, index.data_len);
+    return nullptr;
+  }
+  const auto *const kernel_head = reinterpret_cast<const KernelStoreItemHead *>(index.data + offset);
+  const size_t remain_len = index.data_len - offset - sizeof(KernelStoreItemHead);
+  if ((kernel_head->magic != kKernelItemMagic) ||
+      (remain_len < (static_cast<size_t>(kernel_head->name_len) + kernel_head->bin_len))) {
+    GELOGW("Invalid kernel block at offset %zu, name len %u, bin len %u", offset, kernel_head->name_len,
+           kernel_head->bin_len);
+    return nullptr;
+  }
+  return kernel_head;
+}
+
+KernelBinPtr CreateKernel(const LazyKernelIndex &index, const KernelStoreItemHead &kernel_head) {
+  const uint8_t *next_buffer = reinterpret_cast<const uint8_t *>(&kernel_head) + sizeof(KernelStoreItemHead);
+  const std::string name(reinterpret_cast<const char *>(next_buffer), kernel_head.name_len);
+  next_buffer += kernel_head.name_len;
+  return ge::MakeShared<KernelBin>(name, next_buffer, static_cast<size_t>(kernel_head.bin_len), index.owner);
+}
+}  // namespace
 
 void KernelStore::AddKernel(const KernelBinPtr &kernel) {
   if (kernel != nullptr) {
@@ -25,14 +107,40 @@ void KernelStore::AddKernel(const KernelBinPtr &kernel) {
 }
 
 bool KernelStore::Build() {
+  // kernels of a loaded store which were never looked up are still in the index
+  GE_CHK_BOOL_EXEC_NOLOG(MaterializeAll(), return false);
   buffer_.clear();
-  size_t total_len = 0;
+  if (kernels_.empty()) {
+    return true;
+  }
+  // sorted so that the same kernels always build the same store
+  std::vector<KernelBinPtr> kernels;
+  kernels.reserve(kernels_.size());
   for (const auto &item : kernels_) {
-    auto kernel = item.second;
+    kernels.emplace_back(item.second);
+  }
+  std::sort(kernels.begin(), kernels.end(), [](const KernelBinPtr &lhs, const KernelBinPtr &rhs) {
+    return lhs->GetName() < rhs->GetName();
+  });
+
+  size_t total_len = 0U;
+  std::vector<KernelStoreIndexItem> index_items;
+  index_items.reserve(kernels.size());
+  for (const auto &kernel : kernels) {
+    index_items.push_back({HashKernelName(kernel->GetName().data(), kernel->GetName().length()),
+                           static_cast<uint64_t>(total_len)});
     total_len += sizeof(KernelStoreItemHead);
     total_len += kernel->GetName().length();
     total_len += kernel->GetBinDataSize();
   }
+  std::sort(index_items.begin(), index_items.end(),
+            [](const KernelStoreIndexItem &lhs, const KernelStoreIndexItem &rhs) {
+              return (lhs.name_hash < rhs.name_hash) ||
+                     ((lhs.name_hash == rhs.name_hash) && (lhs.offset < rhs.offset));
+            });
+  const size_t fence_offset = total_len;
+  total_len += sizeof(KernelStoreItemHead) + (index_items.size() * sizeof(KernelStoreIndexItem)) +
+               sizeof(KernelStoreIndexTail);
 
   try {
     buffer_.resize(total_len);
@@ -47,31 +155,24 @@ bool KernelStore::Build() {
 
   uint8_t *next_buffer = buffer_.data();
   size_t remain_len = total_len;
-  errno_t mem_ret;
-  for (const auto &item : kernels_) {
-    auto kernel = item.second;
-    KernelStoreItemHead kernel_head{};
-    kernel_head.magic = kKernelItemMagic;
-    kernel_head.name_len = static_cast<uint32_t>(kernel->GetName().length());
-    kernel_head.bin_len = static_cast<uint32_t>(kernel->GetBinDataSize());
-
+  for (const auto &kernel : kernels) {
     GELOGD("get kernel bin name %s, addr %p, size %zu",
            kernel->GetName().c_str(), kernel->GetBinData(), kernel->GetBinDataSize());
-    mem_ret = memcpy_s(next_buffer, remain_len, &kernel_head, sizeof(kernel_head));
-    GE_CHK_BOOL_EXEC_NOLOG(mem_ret == EOK, return false);
-    next_buffer += sizeof(kernel_head);
-
-    mem_ret = memcpy_s(next_buffer, remain_len - sizeof(kernel_head), kernel->GetName().data(), kernel_head.name_len);
-    GE_CHK_BOOL_EXEC_NOLOG(mem_ret == EOK, return false);
-    next_buffer += kernel_head.name_len;
-
-    mem_ret = memcpy_s(next_buffer, remain_len - sizeof(kernel_head) - kernel_head.name_len, kernel->GetBinData(),
-                       kernel_head.bin_len);
-    GE_CHK_BOOL_EXEC_NOLOG(mem_ret == EOK, return false);
-
-    next_buffer += kernel_head.bin_len;
-    remain_len = remain_len - sizeof(kernel_head) - kernel_head.name_len - kernel_head.bin_len;
+    GE_CHK_BOOL_EXEC_NOLOG(AppendItem(kernel->GetName(), kernel->GetBinData(), kernel->GetBinDataSize(),
+                                      next_buffer, remain_len), return false);
   }
+  KernelStoreItemHead fence{};
+  fence.magic = kKernelIndexMagic;
+  fence.name_len = kIndexFenceNameLen;
+  KernelStoreIndexTail tail{};
+  tail.magic = kKernelIndexMagic;
+  tail.version = kKernelIndexVersion;
+  tail.kernel_num = static_cast<uint32_t>(index_items.size());
+  tail.fence_offset = static_cast<uint64_t>(fence_offset);
+  GE_CHK_BOOL_EXEC_NOLOG(AppendBytes(&fence, sizeof(fence), next_buffer, remain_len) &&
+                         AppendBytes(index_items.data(), index_items.size() * sizeof(KernelStoreIndexItem),
+                                     next_buffer, remain_len) &&
+                         AppendBytes(&tail, sizeof(tail), next_buffer, remain_len), return false);
   kernels_.clear();
   return true;
 }
@@ -84,11 +185,85 @@ bool KernelStore::Load(const uint8_t *data, const size_t &len) {
   if (data == nullptr || len == 0) {
     return false;
   }
+  if (LoadIndex(data, len, nullptr)) {
+    return true;
+  }
+  // stores built without index are unpacked at once
+  return LoadAll(data, len, nullptr);
+}
+
+bool KernelStore::Load(const uint8_t *data, const size_t &len, const std::shared_ptr<const void> &owner) {
+  if ((data == nullptr) || (len == 0U)) {
+    return false;
+  }
+  if (LoadIndex(data, len, owner)) {
+    return true;
+  }
+  return LoadAll(data, len, owner);
+}
+
+bool KernelStore::LoadIndex(const uint8_t *data, const size_t &len, const std::shared_ptr<const void> &owner) {
+  if ((len < (sizeof(KernelStoreItemHead) + sizeof(KernelStoreIndexTail))) || (kernels_.count(kKernelIndexName) > 0U)) {
+    return false;
+  }
+  KernelStoreIndexTail tail{};
+  GE_CHK_BOOL_EXEC_NOLOG(memcpy_s(&tail, sizeof(tail), data + len - sizeof(tail), sizeof(tail)) == EOK,
+                         return false);
+  if ((tail.magic != kKernelIndexMagic) || (tail.version != kKernelIndexVersion)) {
+    return false;
+  }
+  const size_t items_len = static_cast<size_t>(tail.kernel_num) * sizeof(KernelStoreIndexItem);
+  const size_t index_len = sizeof(KernelStoreItemHead) + items_len + sizeof(KernelStoreIndexTail);
+  KernelStoreItemHead fence{};
+  if ((tail.fence_offset > len) || ((len - tail.fence_offset) != index_len) ||
+      (memcpy_s(&fence, sizeof(fence), data + tail.fence_offset, sizeof(fence)) != EOK) ||
+      (fence.magic != kKernelIndexMagic) || (fence.name_len != kIndexFenceNameLen)) {
+    GELOGW("Invalid kernel index, buffer len %zu, kernel num %u, fence offset %lu", len, tail.kernel_num,
+           tail.fence_offset);
+    return false;
+  }
+
+  auto index = ge::MakeShared<LazyKernelIndex>();
+  GE_CHK_BOOL_EXEC_NOLOG(index != nullptr, return false);
+  index->items.resize(tail.kernel_num);
+  if (items_len > 0U) {
+    GE_CHK_BOOL_EXEC_NOLOG(memcpy_s(index->items.data(), items_len,
+                                    data + tail.fence_offset + sizeof(KernelStoreItemHead), items_len) == EOK,
+                           return false);
+  }
+  if (!std::is_sorted(index->items.begin(), index->items.end(),
+                      [](const KernelStoreIndexItem &lhs, const KernelStoreIndexItem &rhs) {
+                        return lhs.name_hash < rhs.name_hash;
+                      })) {
+    GELOGW("Kernel index is not sorted, kernel num %u", tail.kernel_num);
+    return false;
+  }
+  if (owner != nullptr) {
+    index->data = data;
+    index->owner = owner;
+  } else {
+    // the caller does not guarantee the lifetime of data, keep one copy of the kernel items
+    const auto copy = ge::MakeShared<std::vector<uint8_t>>(data, data + tail.fence_offset);
+    GE_CHK_BOOL_EXEC_NOLOG(copy != nullptr, return false);
+    index->data = copy->data();
+    index->owner = copy;
+  }
+  index->data_len = static_cast<size_t>(tail.fence_offset);
+  kernels_[kKernelIndexName] = index;
+  GELOGD("Load kernel index from om, kernel num %u", tail.kernel_num);
+  return true;
+}
+
+bool KernelStore::LoadAll(const uint8_t *data, const size_t &len, const std::shared_ptr<const void> &owner) {
   size_t buffer_len = len;
   while (buffer_len > sizeof(KernelStoreItemHead)) {
     const char *next_buffer = reinterpret_cast<const char *>(data) + (len - buffer_len);
 
     const auto *kernel_head = reinterpret_cast<const KernelStoreItemHead *>(next_buffer);
+    // the index behind the fence holds no kernels
+    if ((kernel_head->magic == kKernelIndexMagic) && (kernel_head->name_len == kIndexFenceNameLen)) {
+      break;
+    }
     if (buffer_len < kernel_head->name_len + kernel_head->bin_len + sizeof(KernelStoreItemHead)) {
       GELOGW("Invalid kernel block remain buffer len %zu, name len %u, bin len %u", buffer_len, kernel_head->name_len,
              kernel_head->bin_len);
@@ -100,8 +275,14 @@ bool KernelStore::Load(const uint8_t *data, const size_t &len) {
 
     next_buffer += kernel_head->name_len;
     GELOGD("Load kernel from om:%s,%u,%u", name.c_str(), kernel_head->name_len, kernel_head->bin_len);
-    std::vector<char> kernel_bin(next_buffer, next_buffer + kernel_head->bin_len);
-    KernelBinPtr teb_kernel_ptr = ge::MakeShared<KernelBin>(name, std::move(kernel_bin));
+    KernelBinPtr teb_kernel_ptr;
+    if (owner != nullptr) {
+      teb_kernel_ptr = ge::MakeShared<KernelBin>(name, reinterpret_cast<const uint8_t *>(next_buffer),
+                                                 static_cast<size_t>(kernel_head->bin_len), owner);
+    } else {
+      std::vector<char> kernel_bin(next_buffer, next_buffer + kernel_head->bin_len);
+      teb_kernel_ptr = ge::MakeShared<KernelBin>(name, std::move(kernel_bin));
+    }
     if (teb_kernel_ptr != nullptr) {
       kernels_.emplace(name, teb_kernel_ptr);
     }
@@ -114,9 +295,68 @@ bool KernelStore::Load(const uint8_t *data, const size_t &len) {
 KernelBinPtr KernelStore::FindKernel(const std::string &name) const {
   auto it = kernels_.find(name);
   if (it != kernels_.end()) {
-    return it->second;
+    return IsIndexName(name) ? nullptr : it->second;
+  }
+  return FindLazyKernel(name);
+}
+
+KernelBinPtr KernelStore::FindLazyKernel(const std::string &name) const {
+  const auto index_iter = kernels_.find(kKernelIndexName);
+  if (index_iter == kernels_.end()) {
+    return nullptr;
+  }
+  LazyKernelIndex &index = *std::static_pointer_cast<LazyKernelIndex>(index_iter->second);
+  const std::lock_guard<std::mutex> lock(index.mutex);
+  const auto cached = index.kernels.find(name);
+  if (cached != index.kernels.end()) {
+    return cached->second;
+  }
+
+  const KernelStoreIndexItem key{HashKernelName(name.data(), name.length()), 0U};
+  auto range = std::equal_range(index.items.begin(), index.items.end(), key,
+                                [](const KernelStoreIndexItem &lhs, const KernelStoreIndexItem &rhs) {
+                                  return lhs.name_hash < rhs.name_hash;
+                                });
+  for (auto iter = range.first; iter != range.second; ++iter) {
+    const KernelStoreItemHead *const kernel_head = GetIndexedItem(index, static_cast<size_t>(iter->offset));
+    if (kernel_head == nullptr) {
+      continue;
+    }
+    const char *const kernel_name = reinterpret_cast<const char *>(kernel_head) + sizeof(KernelStoreItemHead);
+    if ((kernel_head->name_len != name.length()) || (std::memcmp(kernel_name, name.data(), name.length()) != 0)) {
+      continue;
+    }
+    GELOGD("Load kernel from om on demand:%s,%u,%u", name.c_str(), kernel_head->name_len, kernel_head->bin_len);
+    KernelBinPtr kernel = CreateKernel(index, *kernel_head);
+    if (kernel != nullptr) {
+      index.kernels.emplace(name, kernel);
+    }
+    return kernel;
   }
   return nullptr;
 }
 
+bool KernelStore::MaterializeAll() {
+  const auto index_iter = kernels_.find(kKernelIndexName);
+  if (index_iter == kernels_.end()) {
+    return true;
+  }
+  const auto index = std::static_pointer_cast<LazyKernelIndex>(index_iter->second);
+  (void) kernels_.erase(index_iter);
+  const std::lock_guard<std::mutex> lock(index->mutex);
+  for (const auto &item : index->items) {
+    const KernelStoreItemHead *const kernel_head = GetIndexedItem(*index, static_cast<size_t>(item.offset));
+    GE_CHK_BOOL_EXEC_NOLOG(kernel_head != nullptr, return false);
+    const std::string name(reinterpret_cast<const char *>(kernel_head) + sizeof(KernelStoreItemHead),
+                           kernel_head->name_len);
+    if (kernels_.count(name) > 0U) {
+      continue;
+    }
+    const auto cached = index->kernels.find(name);
+    KernelBinPtr kernel = (cached != index->kernels.end()) ? cached->second : CreateKernel(*index, *kernel_head);
+    GE_CHK_BOOL_EXEC_NOLOG(kernel != nullptr, return false);
+    kernels_.emplace(name, kernel);
+  }
+  return true;
+}
 }  // namespace ge
@@ -41,6 +41,8 @@ using TBEKernel = ge::OpKernelBin;
 using TBEKernelPtr = std::shared_ptr<ge::OpKernelBin>;
 
 const uint32_t kKernelItemMagic = 0x5d776efd;
+const uint32_t kKernelIndexMagic = 0x5d776efe;
+const uint32_t kKernelIndexVersion = 1U;
 
 struct KernelStoreItemHead {
   uint32_t magic;
@@ -48,6 +50,23 @@ struct KernelStoreItemHead {
   uint32_t bin_len;
 };
 
+// Stores with at least one kernel end with a name-hash index:
+//   [kernel items][fence: KernelStoreItemHead][KernelStoreIndexItem * kernel_num][KernelStoreIndexTail]
+// The fence claims a block larger than any store, so readers without index support stop there and see exactly the
+// kernels. An empty store stays empty.
+struct KernelStoreIndexItem {
+  uint64_t name_hash;
+  uint64_t offset;  // position of the KernelStoreItemHead from the beginning of the store
+};
+
+struct KernelStoreIndexTail {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t kernel_num;
+  uint32_t reserved;
+  uint64_t fence_offset;
+};
+
 class KernelStore {
  public:
   KernelStore() = default;
@@ -55,6 +74,8 @@ class KernelStore {
   virtual bool Build();
 
   virtual bool Load(const uint8_t *data, const size_t &len);
+  // zero-copy load of a store with index: the index and the kernels refer to data, owner keeps it alive
+  bool Load(const uint8_t *data, const size_t &len, const std::shared_ptr<const void> &owner);
 
   virtual const uint8_t *Data() const;
   virtual size_t DataSize() const;
@@ -62,6 +83,12 @@ class KernelStore {
   virtual KernelBinPtr FindKernel(const std::string &name) const;
 
  private:
+  bool LoadIndex(const uint8_t *data, const size_t &len, const std::shared_ptr<const void> &owner);
+  bool LoadAll(const uint8_t *data, const size_t &len, const std::shared_ptr<const void> &owner);
+  KernelBinPtr FindLazyKernel(const std::string &name) const;
+  bool MaterializeAll();
+
+  // the index of a loaded store is kept in kernels_ under a reserved name, the layout of the class is unchanged
   std::unordered_map<std::string, KernelBinPtr> kernels_;
   std::vector<uint8_t> buffer_;
 };
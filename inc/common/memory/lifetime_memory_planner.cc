@@ -0,0 +1,416 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/memory/lifetime_memory_planner.h"
+
+#include <algorithm>
+#include <future>
+#include <list>
+#include <map>
+#include <set>
+#include <unordered_map>
+
+#include "common/thread_pool.h"
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/debug/log.h"
+#include "graph/debug/ge_attr_define.h"
+#include "graph/debug/ge_op_types.h"
+#include "graph/utils/attr_utils.h"
+#include "graph/utils/tensor_utils.h"
+
+namespace ge {
+namespace {
+// outputs of these nodes are not feature maps: weights, variables and zero copy inputs are placed elsewhere
+const std::set<std::string> kNotFeatureMapTypes = {DATA, AIPPDATA, REFDATA, CONSTANT, CONSTANTOP, FILECONSTANT,
+                                                   VARIABLE, NETOUTPUT};
+const std::vector<std::string> kContinuousMemoryAttrs = {ATTR_NAME_CONTINUOUS_INPUT, ATTR_NAME_CONTINUOUS_OUTPUT,
+                                                         ATTR_NAME_NOPADDING_CONTINUOUS_INPUT,
+                                                         ATTR_NAME_NOPADDING_CONTINUOUS_OUTPUT};
+// workspaces of another memory type or excluded from reuse are not in the feature map
+const std::vector<std::string> kWorkspaceTypeAttrs = {TVM_ATTR_NAME_WORKSPACE_TYPE, ATTR_NAME_WORKSPACE_TYPE_LIST,
+                                                      ATTR_NAME_WORKSPACE_MEMORY_NO_REUSE_SCOPE};
+
+// every output is placed on its own by its live interval in the node order, tensors whose address is tied to
+// another tensor, cleaned by an atomic task or used on another stream would be aliased with live buffers
+bool IsNodeSupported(const OpDescPtr &op_desc, std::string &reason) {
+  bool flag = false;
+  if (AttrUtils::GetBool(op_desc, ATTR_NAME_REFERENCE, flag) && flag) {
+    reason = "ref outputs";
+    return false;
+  }
+  for (const auto &attr : kContinuousMemoryAttrs) {
+    if (AttrUtils::GetBool(op_desc, attr, flag) && flag) {
+      reason = "continuous memory";
+      return false;
+    }
+  }
+  std::vector<int64_t> atomic_outputs;
+  if (AttrUtils::GetListInt(op_desc, ATOMIC_ATTR_OUTPUT_INDEX, atomic_outputs) && (!atomic_outputs.empty())) {
+    reason = "atomic clean outputs";
+    return false;
+  }
+  const auto atomic_workspaces = op_desc->TryGetExtAttr(EXT_ATTR_ATOMIC_WORKSPACE_INFO,
+                                                        std::map<std::string, std::map<int64_t, int64_t>>());
+  if (!atomic_workspaces.empty()) {
+    reason = "atomic clean workspaces";
+    return false;
+  }
+  for (const auto &attr : kWorkspaceTypeAttrs) {
+    if (op_desc->HasAttr(attr)) {
+      reason = "typed workspaces";
+      return false;
+    }
+  }
+  if (!op_desc->GetSubgraphInstanceNames().empty()) {
+    reason = "subgraphs";
+    return false;
+  }
+  for (const auto &output_desc : op_desc->GetAllOutputsDescPtr()) {
+    bool reuse_input = false;
+    if ((output_desc != nullptr) && (TensorUtils::GetReuseInput(*output_desc, reuse_input) == GRAPH_SUCCESS) &&
+        reuse_input) {
+      reason = "outputs reusing inputs";
+      return false;
+    }
+  }
+  return true;
+}
+
+struct PlacedBlock {
+  int64_t offset;
+  int64_t size;
+};
+
+bool IsOverlapped(const MemoryBlockRequest &lhs, const MemoryBlockRequest &rhs) {
+  return (lhs.start <= rhs.end) && (rhs.start <= lhs.end);
+}
+
+class BestFitPlacer {
+ public:
+  BestFitPlacer(const std::vector<int64_t> &sizes, const std::vector<MemoryBlockRequest> &requests)
+      : sizes_(sizes), requests_(requests), offsets_(sizes.size(), -1) {}
+
+  // smallest gap between the placed blocks live at the same time which is large enough, or the top of them
+  int64_t FindOffset(const size_t index) const {
+    std::vector<PlacedBlock> blocks;
+    for (const size_t placed : placed_) {
+      if (IsOverlapped(requests_[index], requests_[placed])) {
+        blocks.push_back({offsets_[placed], sizes_[placed]});
+      }
+    }
+    std::sort(blocks.begin(), blocks.end(),
+              [](const PlacedBlock &lhs, const PlacedBlock &rhs) { return lhs.offset < rhs.offset; });
+    int64_t cur = 0;
+    int64_t best_offset = -1;
+    int64_t best_gap = INT64_MAX;
+    for (const auto &block : blocks) {
+      if (block.offset > cur) {
+        const int64_t gap = block.offset - cur;
+        if ((gap >= sizes_[index]) && (gap < best_gap)) {
+          best_gap = gap;
+          best_offset = cur;
+        }
+      }
+      cur = std::max(cur, block.offset + block.size);
+    }
+    return (best_offset >= 0) ? best_offset : cur;
+  }
+
+  void Place(const size_t index, const int64_t offset) {
+    offsets_[index] = offset;
+    placed_.push_back(index);
+    peak_ = std::max(peak_, offset + sizes_[index]);
+  }
+
+  int64_t GetPeak() const {
+    return peak_;
+  }
+
+  std::vector<int64_t> &MutableOffsets() {
+    return offsets_;
+  }
+
+ private:
+  const std::vector<int64_t> &sizes_;
+  const std::vector<MemoryBlockRequest> &requests_;
+  std::vector<int64_t> offsets_;
+  std::vector<size_t> placed_;
+  int64_t peak_ = 0;
+};
+}  // namespace
+
+int64_t LifetimeMemoryPlanner::AlignSize(const int64_t size) const {
+  const int64_t align = (option_.align_size > 0) ? option_.align_size : 1;
+  return (size + align - 1) / align * align;
+}
+
+Status LifetimeMemoryPlanner::CollectRequests(const ComputeGraphPtr &graph,
+                                              std::vector<MemoryBlockRequest> &requests) const {
+  GE_CHECK_NOTNULL(graph);
+  std::unordered_map<const Node *, uint32_t> node_to_step;
+  uint32_t step = 0U;
+  int64_t stream_id = -1;
+  for (const auto &node : graph->GetDirectNode()) {
+    node_to_step[node.get()] = step++;
+    const OpDescPtr op_desc = node->GetOpDesc();
+    GE_CHECK_NOTNULL(op_desc);
+    if (kNotFeatureMapTypes.count(op_desc->GetType()) > 0U) {
+      continue;
+    }
+    std::string reason;
+    if ((stream_id >= 0) && (op_desc->GetStreamId() >= 0) && (op_desc->GetStreamId() != stream_id)) {
+      reason = "multiple streams";
+    } else if (!IsNodeSupported(op_desc, reason)) {
+      reason += " of node " + node->GetName();
+    } else {
+      stream_id = (stream_id >= 0) ? stream_id : op_desc->GetStreamId();
+      continue;
+    }
+    GELOGI("Graph %s is not planned by lifetime, it has %s.", graph->GetName().c_str(), reason.c_str());
+    return UNSUPPORTED;
+  }
+  const uint32_t last_step = (step == 0U) ? 0U : (step - 1U);
+
+  for (const auto &node : graph->GetDirectNode()) {
+    const OpDescPtr op_desc = node->GetOpDesc();
+    GE_CHECK_NOTNULL(op_desc);
+    if (kNotFeatureMapTypes.count(op_desc->GetType()) > 0U) {
+      continue;
+    }
+    for (const auto &out_anchor : node->GetAllOutDataAnchors()) {
+      const auto output_index = static_cast<uint32_t>(out_anchor->GetIdx());
+      const auto output_desc = op_desc->GetOutputDescPtr(output_index);
+      int64_t size = 0;
+      // an output left out of the plan would keep its default offset inside the new layout
+      if ((output_desc == nullptr) || (TensorUtils::GetSize(*output_desc, size) != GRAPH_SUCCESS) || (size <= 0)) {
+        GELOGI("Graph %s is not planned by lifetime, output %u of node %s has no static size.",
+               graph->GetName().c_str(), output_index, node->GetName().c_str());
+        return UNSUPPORTED;
+      }
+      MemoryBlockRequest request;
+      request.size = size;
+      request.start = node_to_step[node.get()];
+      request.end = request.start;
+      request.node = node;
+      request.output_index = output_index;
+      for (const auto &peer_in_anchor : out_anchor->GetPeerInDataAnchors()) {
+        const Node *const peer_node = peer_in_anchor->GetOwnerNodeBarePtr();
+        GE_CHECK_NOTNULL(peer_node);
+        // graph outputs are read after the last node
+        if (peer_node->GetType() == NETOUTPUT) {
+          request.end = last_step;
+          break;
+        }
+        const auto iter = node_to_step.find(peer_node);
+        if (iter != node_to_step.end()) {
+          request.end = std::max(request.end, iter->second);
+        }
+      }
+      requests.emplace_back(std::move(request));
+    }
+    // a workspace is only live while its node runs
+    const std::vector<int64_t> workspace_bytes = op_desc->GetWorkspaceBytes();
+    for (size_t i = 0U; i < workspace_bytes.size(); ++i) {
+      if (workspace_bytes[i] <= 0) {
+        continue;
+      }
+      MemoryBlockRequest request;
+      request.size = workspace_bytes[i];
+      request.start = node_to_step[node.get()];
+      request.end = request.start;
+      request.node = node;
+      request.output_index = static_cast<uint32_t>(i);
+      request.is_workspace = true;
+      requests.emplace_back(std::move(request));
+    }
+  }
+  GELOGD("Collect %zu feature map tensors and workspaces from %u nodes of graph %s.", requests.size(), step,
+         graph->GetName().c_str());
+  return SUCCESS;
+}
+
+Status LifetimeMemoryPlanner::Plan(const std::vector<MemoryBlockRequest> &requests, MemoryPlanResult &result) const {
+  result = MemoryPlanResult();
+  if (requests.empty()) {
+    return SUCCESS;
+  }
+
+  std::vector<int64_t> sizes(requests.size());
+  int64_t no_reuse_size = 0;
+  uint32_t max_step = 0U;
+  for (size_t i = 0U; i < requests.size(); ++i) {
+    if ((requests[i].size <= 0) || (requests[i].start > requests[i].end)) {
+      GELOGE(PARAM_INVALID, "[Check][Param]request %zu is invalid, size %ld, interval [%u, %u].", i,
+             requests[i].size, requests[i].start, requests[i].end);
+      return PARAM_INVALID;
+    }
+    sizes[i] = AlignSize(requests[i].size);
+    no_reuse_size += sizes[i];
+    max_step = std::max(max_step, requests[i].end);
+  }
+
+  // live size of every step, its maximum is the lower bound of any plan
+  std::vector<int64_t> step_pressure(static_cast<size_t>(max_step) + 2U, 0);
+  for (size_t i = 0U; i < requests.size(); ++i) {
+    step_pressure[requests[i].start] += sizes[i];
+    step_pressure[static_cast<size_t>(requests[i].end) + 1U] -= sizes[i];
+  }
+  for (size_t i = 1U; i < step_pressure.size(); ++i) {
+    step_pressure[i] += step_pressure[i - 1U];
+  }
+  const int64_t lower_bound = *std::max_element(step_pressure.begin(), step_pressure.end());
+
+  std::vector<MemoryPlanHeuristic> heuristics = {MemoryPlanHeuristic::kGreedyBySize};
+  if (option_.try_all_heuristics) {
+    heuristics = {MemoryPlanHeuristic::kGreedyBySize, MemoryPlanHeuristic::kGreedyByBreadth,
+                  MemoryPlanHeuristic::kGreedyByDuration};
+  }
+
+  std::vector<MemoryPlanResult> plans;
+  if (heuristics.size() == 1U) {
+    plans.emplace_back(PlanWithHeuristic(sizes, requests, step_pressure, heuristics[0U]));
+  } else {
+    const uint32_t thread_num = (option_.thread_num == 0U) ? static_cast<uint32_t>(heuristics.size())
+                                                           : option_.thread_num;
+    ThreadPool pool("ge_mplan_", thread_num);
+    std::vector<std::future<MemoryPlanResult>> futures;
+    for (const auto heuristic : heuristics) {
+      auto future = pool.commit([this, &sizes, &requests, &step_pressure, heuristic]() -> MemoryPlanResult {
+        return PlanWithHeuristic(sizes, requests, step_pressure, heuristic);
+      });
+      if (!future.valid()) {
+        GELOGE(FAILED, "[Commit][Task]failed, heuristic %u.", static_cast<uint32_t>(heuristic));
+        return FAILED;
+      }
+      futures.emplace_back(std::move(future));
+    }
+    for (auto &future : futures) {
+      plans.emplace_back(future.get());
+    }
+  }
+
+  size_t best = 0U;
+  for (size_t i = 1U; i < plans.size(); ++i) {
+    if (plans[i].peak_size < plans[best].peak_size) {
+      best = i;
+    }
+  }
+  result = std::move(plans[best]);
+  result.lower_bound = lower_bound;
+  result.no_reuse_size = no_reuse_size;
+  return SUCCESS;
+}
+
+MemoryPlanResult LifetimeMemoryPlanner::PlanWithHeuristic(const std::vector<int64_t> &sizes,
+                                                          const std::vector<MemoryBlockRequest> &requests,
+                                                          const std::vector<int64_t> &step_pressure,
+                                                          const MemoryPlanHeuristic heuristic) const {
+  std::vector<size_t> order(requests.size());
+  std::vector<int64_t> keys(requests.size());
+  for (size_t i = 0U; i < requests.size(); ++i) {
+    order[i] = i;
+    if (heuristic == MemoryPlanHeuristic::kGreedyByBreadth) {
+      keys[i] = *std::max_element(step_pressure.begin() + requests[i].start,
+                                  step_pressure.begin() + requests[i].end + 1);
+    } else if (heuristic == MemoryPlanHeuristic::kGreedyByDuration) {
+      keys[i] = static_cast<int64_t>(requests[i].end - requests[i].start);
+    } else {
+      keys[i] = sizes[i];
+    }
+  }
+  std::stable_sort(order.begin(), order.end(), [&keys, &sizes](const size_t lhs, const size_t rhs) {
+    return (keys[lhs] != keys[rhs]) ? (keys[lhs] > keys[rhs]) : (sizes[lhs] > sizes[rhs]);
+  });
+
+  BestFitPlacer placer(sizes, requests);
+  std::list<size_t> pending(order.begin(), order.end());
+  while (!pending.empty()) {
+    auto cur = pending.begin();
+    int64_t offset = placer.FindOffset(*cur);
+    // before the peak is raised, place a following tensor which fits under it
+    if ((option_.lookahead > 0U) && ((offset + sizes[*cur]) > placer.GetPeak())) {
+      auto candidate = std::next(cur);
+      for (uint32_t i = 0U; (i < option_.lookahead) && (candidate != pending.end()); ++i, ++candidate) {
+        const int64_t candidate_offset = placer.FindOffset(*candidate);
+        if ((candidate_offset + sizes[*candidate]) <= placer.GetPeak()) {
+          cur = candidate;
+          offset = candidate_offset;
+          break;
+        }
+      }
+    }
+    placer.Place(*cur, offset);
+    (void) pending.erase(cur);
+  }
+
+  MemoryPlanResult result;
+  result.offsets = std::move(placer.MutableOffsets());
+  result.peak_size = placer.GetPeak();
+  result.heuristic = heuristic;
+  return result;
+}
+
+Status LifetimeMemoryPlanner::Apply(const std::vector<MemoryBlockRequest> &requests, const MemoryPlanResult &result,
+                                    const int64_t base) {
+  if (requests.size() != result.offsets.size()) {
+    GELOGE(PARAM_INVALID, "[Check][Param]request num %zu mismatch with plan size %zu.", requests.size(),
+           result.offsets.size());
+    return PARAM_INVALID;
+  }
+  for (size_t i = 0U; i < requests.size(); ++i) {
+    GE_CHECK_NOTNULL(requests[i].node);
+    const OpDescPtr op_desc = requests[i].node->GetOpDesc();
+    GE_CHECK_NOTNULL(op_desc);
+    if (requests[i].is_workspace) {
+      std::vector<int64_t> workspaces = op_desc->GetWorkspace();
+      if (workspaces.size() < op_desc->GetWorkspaceBytes().size()) {
+        workspaces.resize(op_desc->GetWorkspaceBytes().size(), 0);
+      }
+      if (requests[i].output_index >= workspaces.size()) {
+        GELOGE(PARAM_INVALID, "[Check][Param]workspace index %u of node %s is out of range %zu.",
+               requests[i].output_index, requests[i].node->GetName().c_str(), workspaces.size());
+        return PARAM_INVALID;
+      }
+      workspaces[requests[i].output_index] = base + result.offsets[i];
+      op_desc->SetWorkspace(workspaces);
+      continue;
+    }
+    std::vector<int64_t> output_offsets = op_desc->GetOutputOffset();
+    if (output_offsets.size() < op_desc->GetOutputsSize()) {
+      output_offsets.resize(op_desc->GetOutputsSize(), 0);
+    }
+    if (requests[i].output_index >= output_offsets.size()) {
+      GELOGE(PARAM_INVALID, "[Check][Param]output index %u of node %s is out of range %zu.",
+             requests[i].output_index, requests[i].node->GetName().c_str(), output_offsets.size());
+      return PARAM_INVALID;
+    }
+    output_offsets[requests[i].output_index] = base + result.offsets[i];
+    op_desc->SetOutputOffset(output_offsets);
+  }
+  return SUCCESS;
+}
+
+void LifetimeMemoryPlanner::Report(const std::string &graph_name, const MemoryPlanResult &result,
+                                   const int64_t default_size) {
+  GEEVENT("[MemoryPlan]graph %s, heuristic %u, peak %ld, lower bound %ld, default %ld, no reuse %ld.",
+          graph_name.c_str(), static_cast<uint32_t>(result.heuristic), result.peak_size, result.lower_bound,
+          default_size, result.no_reuse_size);
+  if ((default_size > 0) && (result.peak_size < default_size)) {
+    GELOGI("[MemoryPlan]graph %s saves %ld bytes against the default plan.", graph_name.c_str(),
+           default_size - result.peak_size);
+  }
+}
+}  // namespace ge
@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_COMMON_MEMORY_LIFETIME_MEMORY_PLANNER_H_
+#define GE_COMMON_MEMORY_LIFETIME_MEMORY_PLANNER_H_
+
+#include <string>
+#include <vector>
+
+#include "framework/common/ge_inner_error_codes.h"
+#include "framework/memory/memory_assigner.h"
+#include "graph/compute_graph.h"
+
+namespace ge {
+// order in which the tensors are placed, every heuristic may win on a different graph
+enum class MemoryPlanHeuristic : uint32_t {
+  kGreedyBySize = 0U,      // largest tensor first
+  kGreedyByBreadth = 1U,   // tensor live at the step with the highest pressure first
+  kGreedyByDuration = 2U,  // longest lived tensor first
+  kHeuristicEnd = 3U
+};
+
+struct MemoryPlanOption {
+  int64_t align_size = MEM_ALIGN_SIZE;
+  // number of following tensors checked for one that fits under the current peak before the peak is raised,
+  // 0 disables lookahead
+  uint32_t lookahead = 0U;
+  // all heuristics are tried concurrently and the lowest peak is kept, false only runs kGreedyBySize
+  bool try_all_heuristics = true;
+  uint32_t thread_num = 0U;  // 0 means one thread per heuristic
+};
+
+// one feature map tensor, live from the step of its producer to the step of its last consumer, both included,
+// or one workspace, live at the step of its node only
+struct MemoryBlockRequest {
+  int64_t size = 0;
+  uint32_t start = 0U;
+  uint32_t end = 0U;
+  NodePtr node;              // producer, empty for requests not built from a graph
+  uint32_t output_index = 0U;  // index of the workspace if is_workspace
+  bool is_workspace = false;
+};
+
+struct MemoryPlanResult {
+  std::vector<int64_t> offsets;  // offset of every request, relative to the feature map base
+  int64_t peak_size = 0;
+  int64_t lower_bound = 0;       // peak of the step with the largest live size, no plan can do better
+  int64_t no_reuse_size = 0;     // sum of all aligned sizes
+  MemoryPlanHeuristic heuristic = MemoryPlanHeuristic::kGreedyBySize;
+};
+
+/// Offline feature map planner based on tensor live intervals.
+/// The live intervals come from the topological order of the nodes, the placement is an interval-graph best fit:
+/// each tensor takes the smallest gap between the tensors already placed whose intervals overlap with its own,
+/// so an offset is reused as soon as the previous occupant is dead.
+/// This is a planning strategy beside MemoryAssigner::AssignMemory, callers compare the reported peak with the
+/// size assigned by the default strategy and keep the smaller one.
+/// Outputs and workspaces of the feature map are planned together, so the plan replaces every offset of the
+/// default plan in that region. Only single stream graphs without subgraphs are planned. Ref and reuse-input
+/// outputs, continuous inputs or outputs, atomic clean outputs or workspaces, workspaces of another memory type and
+/// outputs without a static size tie addresses together or live outside the region in ways the intervals do not
+/// model, graphs which have any of them are refused with UNSUPPORTED and keep the default plan.
+class LifetimeMemoryPlanner {
+ public:
+  explicit LifetimeMemoryPlanner(const MemoryPlanOption &option = MemoryPlanOption()) : option_(option) {}
+  ~LifetimeMemoryPlanner() = default;
+
+  // collects the output tensors and workspaces of the direct nodes of the graph, the graph must be topologically
+  // sorted, UNSUPPORTED if the graph can not be planned by live intervals
+  Status CollectRequests(const ComputeGraphPtr &graph, std::vector<MemoryBlockRequest> &requests) const;
+
+  Status Plan(const std::vector<MemoryBlockRequest> &requests, MemoryPlanResult &result) const;
+
+  // sets the output and workspace offsets of the nodes to base + planned offset
+  static Status Apply(const std::vector<MemoryBlockRequest> &requests, const MemoryPlanResult &result,
+                      const int64_t base);
+
+  // logs the plan against the feature map size assigned by the default strategy (outputs and workspaces, as the
+  // peak of the plan), 0 if unknown
+  static void Report(const std::string &graph_name, const MemoryPlanResult &result, const int64_t default_size);
+
+ private:
+  int64_t AlignSize(const int64_t size) const;
+  MemoryPlanResult PlanWithHeuristic(const std::vector<int64_t> &sizes,
+                                     const std::vector<MemoryBlockRequest> &requests,
+                                     const std::vector<int64_t> &step_pressure,
+                                     const MemoryPlanHeuristic heuristic) const;
+
+  MemoryPlanOption option_;
+};
+}  // namespace ge
+#endif  // GE_COMMON_MEMORY_LIFETIME_MEMORY_PLANNER_H_
@@ -0,0 +1,210 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/model/model_parallel_unserializer.h"
+
+#include <algorithm>
+#include <future>
+#include <queue>
+
+#include "common/thread_pool.h"
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/debug/log.h"
+#include "google/protobuf/arena.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "graph/detail/model_serialize_imp.h"
+
+namespace ge {
+namespace {
+constexpr uint32_t kMaxUnserializeThreadNum = 16U;
+constexpr size_t kMaxArenaStartBlockSize = 64UL * 1024UL * 1024UL;
+constexpr int32_t kProtoTotalBytesLimit = INT32_MAX;
+
+Status UnserializeOneGraph(const std::shared_ptr<proto::ModelDef> &model_def, const int32_t index,
+                           ComputeGraphPtr &graph) {
+  // every graph owns its own node name table, exactly like the subgraphs in ModelSerializeImp::UnserializeModel
+  ModelSerializeImp impl;
+  impl.SetProtobufOwner(model_def);
+  proto::GraphDef &graph_proto = *model_def->mutable_graph(index);
+  if (!impl.UnserializeGraphWithoutEdge(graph, graph_proto)) {
+    GELOGE(FAILED, "[Unserialize][Graph]failed, graph index %d, name %s.", index, graph_proto.name().c_str());
+    return FAILED;
+  }
+  if (!impl.HandleNodeNameRef()) {
+    GELOGE(FAILED, "[Link][Edges]failed, graph index %d, name %s.", index, graph_proto.name().c_str());
+    return FAILED;
+  }
+  return SUCCESS;
+}
+}  // namespace
+
+Status ModelParallelUnserializer::ParseModelDef(const uint8_t *const data, const size_t len,
+                                                const UnserializeOption &option,
+                                                std::shared_ptr<proto::ModelDef> &model_def) {
+  GE_CHECK_NOTNULL(data);
+  if ((len == 0U) || (len > static_cast<size_t>(kProtoTotalBytesLimit))) {
+    GELOGE(PARAM_INVALID, "[Check][Param]model data len %zu is invalid.", len);
+    return PARAM_INVALID;
+  }
+
+  if (option.use_arena) {
+    google::protobuf::ArenaOptions arena_options;
+    // the decoded messages are about as large as the encoded bytes, so start with a block of that size
+    arena_options.start_block_size = std::max(std::min(len, kMaxArenaStartBlockSize), arena_options.start_block_size);
+    if (option.arena_max_block_size != 0U) {
+      arena_options.max_block_size = std::max(option.arena_max_block_size, arena_options.start_block_size);
+    } else {
+      arena_options.max_block_size = std::max(arena_options.max_block_size, arena_options.start_block_size);
+    }
+    const auto arena = std::make_shared<google::protobuf::Arena>(arena_options);
+    proto::ModelDef *const raw_model_def = google::protobuf::Arena::CreateMessage<proto::ModelDef>(arena.get());
+    GE_CHECK_NOTNULL(raw_model_def);
+    // the message is freed with the arena, the deleter only keeps the arena alive for the last owner
+    model_def = std::shared_ptr<proto::ModelDef>(raw_model_def, [arena](const proto::ModelDef *const) {});
+  } else {
+    model_def = MakeShared<proto::ModelDef>();
+    GE_CHECK_NOTNULL(model_def);
+  }
+
+  google::protobuf::io::CodedInputStream coded_stream(data, static_cast<int32_t>(len));
+  coded_stream.SetTotalBytesLimit(kProtoTotalBytesLimit);
+  if (!model_def->ParseFromCodedStream(&coded_stream)) {
+    GELOGE(FAILED, "[Parse][ModelDef]parse model def from data failed, len %zu.", len);
+    model_def.reset();
+    return FAILED;
+  }
+  return SUCCESS;
+}
+
+Status ModelParallelUnserializer::Unserialize(const uint8_t *const data, const size_t len, Model &model) const {
+  std::shared_ptr<proto::ModelDef> model_def;
+  GE_CHK_STATUS_RET(ParseModelDef(data, len, option_, model_def), "[Parse][ModelDef]failed, len %zu.", len);
+  return Unserialize(model_def, model);
+}
+
+Status ModelParallelUnserializer::Unserialize(const std::shared_ptr<proto::ModelDef> &model_def, Model &model) const {
+  GE_CHECK_NOTNULL(model_def);
+  model.SetName(model_def->name());
+  model.SetVersion(model_def->version());
+  model.SetPlatformVersion(model_def->custom_version());
+  if (!ModelSerializeImp::DeserializeAllAttrsToAttrHolder(model_def->attr(), &model)) {
+    GELOGE(FAILED, "[Unserialize][Attrs]failed, model %s.", model_def->name().c_str());
+    return FAILED;
+  }
+  if (model_def->graph_size() == 0) {
+    return SUCCESS;
+  }
+
+  const uint32_t thread_num = (option_.thread_num == 0U) ?
+                              ThreadPool::GetDefaultThreadNum(kMaxUnserializeThreadNum) : option_.thread_num;
+  std::vector<ComputeGraphPtr> graphs;
+  GE_CHK_STATUS_RET(UnserializeGraphs(model_def, thread_num, graphs), "[Unserialize][Graphs]failed, model %s.",
+                    model_def->name().c_str());
+
+  // index 0 is the root graph, the following are subgraphs
+  const ComputeGraphPtr root_graph = graphs[0U];
+  const std::vector<ComputeGraphPtr> subgraphs(graphs.begin() + 1, graphs.end());
+  GE_CHK_STATUS_RET(RebuildOwnership(root_graph, subgraphs), "[Rebuild][Ownership]failed, model %s.",
+                    model_def->name().c_str());
+  model.SetGraph(root_graph);
+  GELOGI("Unserialize model %s with %zu graphs by %u threads.", model_def->name().c_str(), graphs.size(),
+         thread_num);
+  return SUCCESS;
+}
+
+Status ModelParallelUnserializer::UnserializeGraphs(const std::shared_ptr<proto::ModelDef> &model_def,
+                                                    const uint32_t thread_num,
+                                                    std::vector<ComputeGraphPtr> &graphs) {
+  const int32_t graph_num = model_def->graph_size();
+  graphs.assign(static_cast<size_t>(graph_num), nullptr);
+  const uint32_t worker_num = std::min(thread_num, static_cast<uint32_t>(graph_num));
+  if (worker_num <= 1U) {
+    for (int32_t i = 0; i < graph_num; ++i) {
+      GE_CHK_STATUS_RET_NOLOG(UnserializeOneGraph(model_def, i, graphs[static_cast<size_t>(i)]));
+    }
+    return SUCCESS;
+  }
+
+  ThreadPool pool("ge_unser_", worker_num);
+  std::vector<std::future<Status>> results;
+  // largest graphs first so that the root graph does not start last
+  std::vector<int32_t> order(static_cast<size_t>(graph_num));
+  for (int32_t i = 0; i < graph_num; ++i) {
+    order[static_cast<size_t>(i)] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&model_def](const int32_t lhs, const int32_t rhs) {
+    return model_def->graph(lhs).op_size() > model_def->graph(rhs).op_size();
+  });
+  for (const int32_t index : order) {
+    auto future = pool.commit([&model_def, &graphs, index]() -> Status {
+      return UnserializeOneGraph(model_def, index, graphs[static_cast<size_t>(index)]);
+    });
+    if (!future.valid()) {
+      GELOGE(FAILED, "[Commit][Task]failed, graph index %d.", index);
+      return FAILED;
+    }
+    results.emplace_back(std::move(future));
+  }
+
+  Status ret = SUCCESS;
+  for (auto &result : results) {
+    const Status task_ret = result.get();
+    if (task_ret != SUCCESS) {
+      ret = task_ret;
+    }
+  }
+  return ret;
+}
+
+Status ModelParallelUnserializer::RebuildOwnership(const ComputeGraphPtr &root_graph,
+                                                   const std::vector<ComputeGraphPtr> &subgraphs) {
+  GE_CHECK_NOTNULL(root_graph);
+  std::map<std::string, ComputeGraphPtr> name_to_subgraph;
+  for (const auto &subgraph : subgraphs) {
+    GE_CHECK_NOTNULL(subgraph);
+    name_to_subgraph[subgraph->GetName()] = subgraph;
+  }
+
+  std::queue<ComputeGraphPtr> all_graphs;
+  all_graphs.emplace(root_graph);
+  while (!all_graphs.empty()) {
+    const ComputeGraphPtr graph = all_graphs.front();
+    all_graphs.pop();
+    for (const NodePtr &node : graph->GetDirectNode()) {
+      const OpDescPtr op_desc = node->GetOpDesc();
+      GE_CHECK_NOTNULL(op_desc);
+      for (const std::string &name : op_desc->GetSubgraphInstanceNames()) {
+        if (name.empty()) {
+          continue;
+        }
+        const auto iter = name_to_subgraph.find(name);
+        if (iter == name_to_subgraph.end()) {
+          GELOGE(FAILED, "[Find][Subgraph]%s of node %s is not in the model.", name.c_str(), node->GetName().c_str());
+          return FAILED;
+        }
+        const ComputeGraphPtr &subgraph = iter->second;
+        subgraph->SetParentGraph(graph);
+        subgraph->SetParentNode(node);
+        GE_CHK_GRAPH_STATUS_RET(root_graph->AddSubgraph(subgraph->GetName(), subgraph),
+                                "[Add][Subgraph]%s to root graph %s failed.", name.c_str(),
+                                root_graph->GetName().c_str());
+        all_graphs.emplace(subgraph);
+      }
+    }
+  }
+  return SUCCESS;
+}
+}  // namespace ge
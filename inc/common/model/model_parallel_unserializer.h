@@ -0,0 +1,63 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_MODEL_MODEL_PARALLEL_UNSERIALIZER_H_
+#define GE_MODEL_MODEL_PARALLEL_UNSERIALIZER_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "framework/common/ge_inner_error_codes.h"
+#include "graph/compute_graph.h"
+#include "graph/model.h"
+#include "proto/ge_ir.pb.h"
+
+namespace ge {
+struct UnserializeOption {
+  uint32_t thread_num = 0U;               // 0 means min(hardware concurrency, kMaxUnserializeThreadNum)
+  bool use_arena = true;                  // parse the ModelDef on a protobuf arena
+  size_t arena_max_block_size = 0U;       // 0 means protobuf default
+};
+
+/// Faster equivalent of ModelSerialize::UnserializeModel(data, len, model) for large models:
+///  - the ModelDef is parsed on a protobuf arena whose lifetime is bound to the protobuf owner of the graphs,
+///    so the many small messages are bump allocated and released at once;
+///  - the root graph and every subgraph are unserialized concurrently, each by its own ModelSerializeImp,
+///    which is how UnserializeModel already isolates subgraphs, then ownership is rebuilt in graph order.
+/// The result is identical to the serial path, subgraphs are attached in the order of the ModelDef.
+class ModelParallelUnserializer {
+ public:
+  explicit ModelParallelUnserializer(const UnserializeOption &option = UnserializeOption()) : option_(option) {}
+  ~ModelParallelUnserializer() = default;
+
+  Status Unserialize(const uint8_t *const data, const size_t len, Model &model) const;
+
+  Status Unserialize(const std::shared_ptr<proto::ModelDef> &model_def, Model &model) const;
+
+  static Status ParseModelDef(const uint8_t *const data, const size_t len, const UnserializeOption &option,
+                              std::shared_ptr<proto::ModelDef> &model_def);
+
+ private:
+  static Status UnserializeGraphs(const std::shared_ptr<proto::ModelDef> &model_def, const uint32_t thread_num,
+                                  std::vector<ComputeGraphPtr> &graphs);
+  static Status RebuildOwnership(const ComputeGraphPtr &root_graph, const std::vector<ComputeGraphPtr> &subgraphs);
+
+  UnserializeOption option_;
+};
+}  // namespace ge
+#endif  // GE_MODEL_MODEL_PARALLEL_UNSERIALIZER_H_
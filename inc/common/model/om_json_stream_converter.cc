@@ -0,0 +1,491 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/model/om_json_stream_converter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <sys/mman.h>
+#include <vector>
+
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/debug/log.h"
+#include "framework/common/types.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/util/json_util.h"
+#include "google/protobuf/wire_format_lite.h"
+#include "mmpa/mmpa_api.h"
+#include "proto/ge_ir.pb.h"
+
+namespace ge {
+namespace {
+constexpr uint32_t kWireLengthDelimited = 2U;
+constexpr int32_t kProtoTotalBytesLimit = INT32_MAX;
+constexpr size_t kOutputBufferSize = 4UL * 1024UL * 1024UL;
+constexpr uint8_t kModelTypeIr = 0U;
+constexpr uint8_t kModelTypeStandard = 1U;
+// ModelDef
+constexpr uint32_t kModelNameField = 1U;
+constexpr uint32_t kModelVersionField = 2U;
+constexpr uint32_t kModelCustomVersionField = 3U;
+constexpr uint32_t kModelGraphField = 7U;
+constexpr uint32_t kModelAttrField = 11U;
+// GraphDef
+constexpr uint32_t kGraphNameField = 1U;
+constexpr uint32_t kGraphInputField = 4U;
+constexpr uint32_t kGraphOutputField = 5U;
+constexpr uint32_t kGraphOpField = 6U;
+constexpr uint32_t kGraphAttrField = 11U;
+// map entry
+constexpr uint32_t kMapKeyField = 1U;
+constexpr uint32_t kMapValueField = 2U;
+
+// walks the fields of one message, the payload of length delimited fields stays in the mapped data
+class FieldReader {
+ public:
+  FieldReader(const uint8_t *const data, const size_t len)
+      : data_(data), stream_(data, static_cast<int32_t>(len)) {
+    stream_.SetTotalBytesLimit(kProtoTotalBytesLimit);
+  }
+
+  // false at the end of the message
+  bool Next(uint32_t &field, uint32_t &wire_type) {
+    const uint32_t tag = stream_.ReadTag();
+    field = tag >> 3U;
+    wire_type = tag & 0x7U;
+    return tag != 0U;
+  }
+
+  bool ReadBytes(const uint8_t *&payload, size_t &len) {
+    uint32_t size = 0U;
+    if (!stream_.ReadVarint32(&size)) {
+      return false;
+    }
+    payload = data_ + stream_.CurrentPosition();
+    len = static_cast<size_t>(size);
+    return stream_.Skip(static_cast<int32_t>(size));
+  }
+
+  bool ReadString(std::string &value) {
+    const uint8_t *payload = nullptr;
+    size_t len = 0U;
+    if (!ReadBytes(payload, len)) {
+      return false;
+    }
+    value.assign(reinterpret_cast<const char_t *>(payload), len);
+    return true;
+  }
+
+  bool ReadVarint(uint64_t &value) {
+    return stream_.ReadVarint64(&value);
+  }
+
+  bool Skip(const uint32_t field, const uint32_t wire_type) {
+    return google::protobuf::internal::WireFormatLite::SkipField(&stream_, (field << 3U) | wire_type);
+  }
+
+ private:
+  const uint8_t *data_;
+  google::protobuf::io::CodedInputStream stream_;
+};
+
+void WriteJsonString(const std::string &value, std::ostream &os) {
+  os << '"';
+  for (const char_t c : value) {
+    switch (c) {
+      case '"':
+        os << "\\\"";
+        break;
+      case '\\':
+        os << "\\\\";
+        break;
+      case '\n':
+        os << "\\n";
+        break;
+      case '\r':
+        os << "\\r";
+        break;
+      case '\t':
+        os << "\\t";
+        break;
+      default:
+        if (static_cast<uint8_t>(c) < 0x20U) {
+          const char_t *const hex = "0123456789abcdef";
+          os << "\\u00" << hex[static_cast<uint8_t>(c) >> 4U] << hex[static_cast<uint8_t>(c) & 0xFU];
+        } else {
+          os << c;
+        }
+        break;
+    }
+  }
+  os << '"';
+}
+
+std::string FixedString(const uint8_t *const data, const size_t max_len) {
+  const char_t *const str = reinterpret_cast<const char_t *>(data);
+  return std::string(str, strnlen(str, max_len));
+}
+
+void WriteSeparator(bool &first, std::ostream &os) {
+  if (!first) {
+    os << ',';
+  }
+  first = false;
+}
+
+bool IsOversize(const std::string &bytes) {
+  return bytes.size() > OmJsonStreamConverter::kMaxInlineBytes;
+}
+}  // namespace
+
+Status OmJsonStreamConverter::Convert(const std::string &om_file, const std::string &json_file) const {
+  ULONGLONG file_size = 0U;
+  if ((mmGetFileSize(om_file.c_str(), &file_size) != EN_OK) || (file_size == 0U)) {
+    GELOGE(FAILED, "[Get][FileSize]of %s failed or file is empty.", om_file.c_str());
+    return FAILED;
+  }
+  int32_t fd = mmOpen(om_file.c_str(), M_RDONLY);
+  if (fd < 0) {
+    GELOGE(FAILED, "[Open][File]%s failed.", om_file.c_str());
+    return FAILED;
+  }
+  const size_t len = static_cast<size_t>(file_size);
+  void *const addr = mmMmap(fd, static_cast<mmSize_t>(len), 0, &fd, PROT_READ, MAP_PRIVATE);
+  (void) mmClose(fd);
+  if ((addr == nullptr) || (addr == MAP_FAILED)) {
+    GELOGE(FAILED, "[Map][File]%s failed, size %zu.", om_file.c_str(), len);
+    return FAILED;
+  }
+  const std::unique_ptr<void, std::function<void(void *)>> mapping(addr, [len](void *const mapped) {
+    (void) munmap(mapped, len);
+  });
+
+  std::unique_ptr<char_t[]> buffer(new (std::nothrow) char_t[kOutputBufferSize]);
+  GE_CHECK_NOTNULL(buffer);
+  std::ofstream ofs;
+  (void) ofs.rdbuf()->pubsetbuf(buffer.get(), static_cast<std::streamsize>(kOutputBufferSize));
+  ofs.open(json_file, std::ios::out | std::ios::trunc);
+  GE_CHK_BOOL_RET_STATUS(ofs.is_open(), FAILED, "[Open][File]%s failed.", json_file.c_str());
+  GE_CHK_STATUS_RET(Convert(static_cast<const uint8_t *>(addr), len, ofs), "[Convert][Om]%s to json failed.",
+                    om_file.c_str());
+  ofs.flush();
+  GE_CHK_BOOL_RET_STATUS(ofs.good(), FAILED, "[Write][File]%s failed.", json_file.c_str());
+  GELOGI("Convert om %s of size %zu to json %s.", om_file.c_str(), len, json_file.c_str());
+  return SUCCESS;
+}
+
+Status OmJsonStreamConverter::Convert(const uint8_t *const data, const size_t len, std::ostream &os) const {
+  GE_CHECK_NOTNULL(data);
+  GE_CHK_BOOL_RET_STATUS(len >= sizeof(ModelFileHeader), PARAM_INVALID,
+                         "[Check][Param]om size %zu is less than the header size %zu.", len, sizeof(ModelFileHeader));
+  ModelFileHeader header;
+  (void) memcpy(&header, data, sizeof(ModelFileHeader));
+  GE_CHK_BOOL_RET_STATUS(header.is_encrypt == static_cast<uint8_t>(ModelEncryptType::UNENCRYPTED),
+                         UNSUPPORTED, "[Check][Param]encrypted om is not supported.");
+  // tiny models use 32 bits partition tables and flow models keep their submodels in FLOW_SUBMODEL partitions
+  GE_CHK_BOOL_RET_STATUS((header.modeltype == kModelTypeIr) || (header.modeltype == kModelTypeStandard), UNSUPPORTED,
+                         "[Check][Param]model type %u is not supported.", static_cast<uint32_t>(header.modeltype));
+  os << '{';
+  GE_CHK_STATUS_RET_NOLOG(WriteHeader(data, len, os));
+
+  // as OmFileLoadHelper: one partition table per model behind the header, each followed by its partitions
+  const uint32_t model_num = std::max(header.model_num, 1U);
+  size_t cur_offset = static_cast<size_t>(header.headsize);
+  std::vector<std::pair<const uint8_t *, size_t>> model_defs;
+  os << ",\"partitions\":[";
+  bool first = true;
+  for (uint32_t model_index = 0U; model_index < model_num; ++model_index) {
+    GE_CHK_BOOL_RET_STATUS((cur_offset <= len) && (sizeof(ModelPartitionTable) <= (len - cur_offset)), PARAM_INVALID,
+                           "[Check][Param]om size %zu has no partition table for model %u.", len, model_index);
+    ModelPartitionTable table_head{};
+    (void) memcpy(&table_head, data + cur_offset, sizeof(ModelPartitionTable));
+    const uint64_t table_size = SizeOfModelPartitionTable(table_head);
+    GE_CHK_BOOL_RET_STATUS(table_size <= (len - cur_offset), PARAM_INVALID,
+                           "[Check][Param]partition num %u of model %u exceeds the om size %zu.", table_head.num,
+                           model_index, len);
+    std::vector<ModelPartitionMemInfo> partitions(table_head.num);
+    (void) memcpy(partitions.data(), data + cur_offset + sizeof(ModelPartitionTable),
+                  sizeof(ModelPartitionMemInfo) * partitions.size());
+    cur_offset += static_cast<size_t>(table_size);
+    for (const auto &partition : partitions) {
+      GE_CHK_BOOL_RET_STATUS(partition.mem_size <= (len - cur_offset), PARAM_INVALID,
+                             "[Check][Param]partition type %d of model %u, size %lu exceeds the om size %zu.",
+                             static_cast<int32_t>(partition.type), model_index, partition.mem_size, len);
+      WriteSeparator(first, os);
+      os << "{\"model_index\":" << model_index << ",\"type\":" << static_cast<int32_t>(partition.type)
+         << ",\"offset\":" << cur_offset << ",\"size\":" << partition.mem_size << '}';
+      if (partition.type == MODEL_DEF) {
+        model_defs.emplace_back(data + cur_offset, static_cast<size_t>(partition.mem_size));
+      }
+      cur_offset += static_cast<size_t>(partition.mem_size);
+    }
+  }
+  os << "],\"models\":[";
+  first = true;
+  for (size_t i = 0U; i < model_defs.size(); ++i) {
+    WriteSeparator(first, os);
+    GE_CHK_STATUS_RET(WriteModelDef(model_defs[i].first, model_defs[i].second, os),
+                      "[Write][ModelDef]%zu at offset %zu failed.", i, static_cast<size_t>(model_defs[i].first - data));
+  }
+  os << "]}";
+  return os.good() ? SUCCESS : FAILED;
+}
+
+Status OmJsonStreamConverter::WriteHeader(const uint8_t *const data, const size_t len, std::ostream &os) const {
+  (void) len;
+  ModelFileHeader header;
+  (void) memcpy(&header, data, sizeof(ModelFileHeader));
+  os << "\"header\":{\"magic\":" << header.magic << ",\"headsize\":" << header.headsize
+     << ",\"version\":" << header.version << ",\"length\":" << header.length
+     << ",\"is_encrypt\":" << static_cast<uint32_t>(header.is_encrypt)
+     << ",\"is_checksum\":" << static_cast<uint32_t>(header.is_checksum)
+     << ",\"modeltype\":" << static_cast<uint32_t>(header.modeltype)
+     << ",\"genmode\":" << static_cast<uint32_t>(header.genmode) << ",\"name\":";
+  WriteJsonString(FixedString(header.name, sizeof(header.name)), os);
+  os << ",\"ops\":" << header.ops << ",\"om_ir_version\":" << header.om_ir_version
+     << ",\"model_num\":" << header.model_num << ",\"platform_version\":";
+  WriteJsonString(FixedString(header.platform_version, sizeof(header.platform_version)), os);
+  os << ",\"platform_type\":" << static_cast<uint32_t>(header.platform_type)
+     << ",\"model_length\":" << header.model_length << '}';
+  return SUCCESS;
+}
+
+Status OmJsonStreamConverter::WriteModelDef(const uint8_t *const data, const size_t len, std::ostream &os) const {
+  GE_CHK_BOOL_RET_STATUS(len <= static_cast<size_t>(kProtoTotalBytesLimit), PARAM_INVALID,
+                         "[Check][Param]model def size %zu is too large.", len);
+  // scalars first, they may be anywhere in the message
+  std::string name;
+  std::string custom_version;
+  uint64_t version = 0U;
+  FieldReader scalar_reader(data, len);
+  uint32_t field = 0U;
+  uint32_t wire_type = 0U;
+  while (scalar_reader.Next(field, wire_type)) {
+    bool ret = true;
+    if ((field == kModelNameField) && (wire_type == kWireLengthDelimited)) {
+      ret = scalar_reader.ReadString(name);
+    } else if ((field == kModelCustomVersionField) && (wire_type == kWireLengthDelimited)) {
+      ret = scalar_reader.ReadString(custom_version);
+    } else if (field == kModelVersionField) {
+      ret = scalar_reader.ReadVarint(version);
+    } else {
+      ret = scalar_reader.Skip(field, wire_type);
+    }
+    GE_CHK_BOOL_RET_STATUS(ret, FAILED, "[Read][Field]%u of ModelDef failed.", field);
+  }
+  os << "{\"name\":";
+  WriteJsonString(name, os);
+  os << ",\"version\":" << version << ",\"custom_version\":";
+  WriteJsonString(custom_version, os);
+
+  uint64_t omitted_bytes = 0U;
+  os << ",\"attr\":{";
+  bool first = true;
+  FieldReader attr_reader(data, len);
+  while (attr_reader.Next(field, wire_type)) {
+    if ((field != kModelAttrField) || (wire_type != kWireLengthDelimited)) {
+      GE_CHK_BOOL_RET_STATUS(attr_reader.Skip(field, wire_type), FAILED, "[Skip][Field]%u of ModelDef failed.", field);
+      continue;
+    }
+    const uint8_t *entry = nullptr;
+    size_t entry_len = 0U;
+    GE_CHK_BOOL_RET_STATUS(attr_reader.ReadBytes(entry, entry_len), FAILED, "[Read][Attr]of ModelDef failed.");
+    GE_CHK_STATUS_RET_NOLOG(WriteAttrEntry(entry, entry_len, first, os, omitted_bytes));
+  }
+  os << "},\"graph\":[";
+  first = true;
+  FieldReader graph_reader(data, len);
+  size_t graph_num = 0U;
+  while (graph_reader.Next(field, wire_type)) {
+    if ((field != kModelGraphField) || (wire_type != kWireLengthDelimited)) {
+      GE_CHK_BOOL_RET_STATUS(graph_reader.Skip(field, wire_type), FAILED, "[Skip][Field]%u of ModelDef failed.",
+                             field);
+      continue;
+    }
+    const uint8_t *graph = nullptr;
+    size_t graph_len = 0U;
+    GE_CHK_BOOL_RET_STATUS(graph_reader.ReadBytes(graph, graph_len), FAILED, "[Read][Graph]%zu failed.", graph_num);
+    WriteSeparator(first, os);
+    GE_CHK_STATUS_RET(WriteGraphDef(graph, graph_len, os), "[Write][Graph]%zu of model %s failed.", graph_num,
+                      name.c_str());
+    ++graph_num;
+  }
+  os << "],\"omitted_bytes\":" << omitted_bytes << '}';
+  GELOGD("Write model %s with %zu graphs.", name.c_str(), graph_num);
+  return SUCCESS;
+}
+
+Status OmJsonStreamConverter::WriteGraphDef(const uint8_t *const data, const size_t len, std::ostream &os) const {
+  std::string name;
+  std::vector<std::string> inputs;
+  std::vector<std::string> outputs;
+  FieldReader scalar_reader(data, len);
+  uint32_t field = 0U;
+  uint32_t wire_type = 0U;
+  while (scalar_reader.Next(field, wire_type)) {
+    bool ret = true;
+    if ((field == kGraphNameField) && (wire_type == kWireLengthDelimited)) {
+      ret = scalar_reader.ReadString(name);
+    } else if ((field == kGraphInputField) && (wire_type == kWireLengthDelimited)) {
+      inputs.emplace_back();
+      ret = scalar_reader.ReadString(inputs.back());
+    } else if ((field == kGraphOutputField) && (wire_type == kWireLengthDelimited)) {
+      outputs.emplace_back();
+      ret = scalar_reader.ReadString(outputs.back());
+    } else {
+      ret = scalar_reader.Skip(field, wire_type);
+    }
+    GE_CHK_BOOL_RET_STATUS(ret, FAILED, "[Read][Field]%u of GraphDef failed.", field);
+  }
+  os << "{\"name\":";
+  WriteJsonString(name, os);
+  for (const auto &io : {std::make_pair("input", &inputs), std::make_pair("output", &outputs)}) {
+    os << ",\"" << io.first << "\":[";
+    bool first = true;
+    for (const auto &value : *io.second) {
+      WriteSeparator(first, os);
+      WriteJsonString(value, os);
+    }
+    os << ']';
+  }
+
+  uint64_t omitted_bytes = 0U;
+  os << ",\"attr\":{";
+  bool first = true;
+  FieldReader attr_reader(data, len);
+  while (attr_reader.Next(field, wire_type)) {
+    if ((field != kGraphAttrField) || (wire_type != kWireLengthDelimited)) {
+      GE_CHK_BOOL_RET_STATUS(attr_reader.Skip(field, wire_type), FAILED, "[Skip][Field]%u of GraphDef failed.", field);
+      continue;
+    }
+    const uint8_t *entry = nullptr;
+    size_t entry_len = 0U;
+    GE_CHK_BOOL_RET_STATUS(attr_reader.ReadBytes(entry, entry_len), FAILED, "[Read][Attr]of graph %s failed.",
+                           name.c_str());
+    GE_CHK_STATUS_RET_NOLOG(WriteAttrEntry(entry, entry_len, first, os, omitted_bytes));
+  }
+
+  // one op at a time, the OpDef is reused so its buffers are allocated once
+  os << "},\"op\":[";
+  first = true;
+  proto::OpDef op_def;
+  size_t op_num = 0U;
+  FieldReader op_reader(data, len);
+  while (op_reader.Next(field, wire_type)) {
+    if ((field != kGraphOpField) || (wire_type != kWireLengthDelimited)) {
+      GE_CHK_BOOL_RET_STATUS(op_reader.Skip(field, wire_type), FAILED, "[Skip][Field]%u of GraphDef failed.", field);
+      continue;
+    }
+    const uint8_t *op = nullptr;
+    size_t op_len = 0U;
+    GE_CHK_BOOL_RET_STATUS(op_reader.ReadBytes(op, op_len) && op_def.ParseFromArray(op, static_cast<int32_t>(op_len)),
+                           FAILED, "[Parse][Op]%zu of graph %s failed.", op_num, name.c_str());
+    StripOp(op_def, omitted_bytes);
+    WriteSeparator(first, os);
+    GE_CHK_STATUS_RET(WriteMessage(op_def, os), "[Write][Op]%s failed.", op_def.name().c_str());
+    ++op_num;
+  }
+  os << "],\"omitted_bytes\":" << omitted_bytes << '}';
+  GELOGD("Write graph %s with %zu ops, omitted bytes %lu.", name.c_str(), op_num, omitted_bytes);
+  return SUCCESS;
+}
+
+Status OmJsonStreamConverter::WriteAttrEntry(const uint8_t *const data, const size_t len, bool &first,
+                                             std::ostream &os, uint64_t &omitted_bytes) const {
+  std::string key;
+  proto::AttrDef value;
+  FieldReader reader(data, len);
+  uint32_t field = 0U;
+  uint32_t wire_type = 0U;
+  while (reader.Next(field, wire_type)) {
+    bool ret = true;
+    if ((field == kMapKeyField) && (wire_type == kWireLengthDelimited)) {
+      ret = reader.ReadString(key);
+    } else if ((field == kMapValueField) && (wire_type == kWireLengthDelimited)) {
+      const uint8_t *payload = nullptr;
+      size_t payload_len = 0U;
+      ret = reader.ReadBytes(payload, payload_len) && value.ParseFromArray(payload, static_cast<int32_t>(payload_len));
+    } else {
+      ret = reader.Skip(field, wire_type);
+    }
+    GE_CHK_BOOL_RET_STATUS(ret, FAILED, "[Read][Field]%u of attr entry failed.", field);
+  }
+  StripAttr(value, omitted_bytes);
+  WriteSeparator(first, os);
+  WriteJsonString(key, os);
+  os << ':';
+  return WriteMessage(value, os);
+}
+
+Status OmJsonStreamConverter::WriteMessage(const google::protobuf::Message &message, std::ostream &os) const {
+  google::protobuf::util::JsonPrintOptions options;
+  options.add_whitespace = option_.add_whitespace;
+  options.preserve_proto_field_names = true;
+  std::string json;
+  const auto status = google::protobuf::util::MessageToJsonString(message, &json, options);
+  GE_CHK_BOOL_RET_STATUS(status.ok(), FAILED, "[Convert][Json]failed, %s.", status.ToString().c_str());
+  os << json;
+  return SUCCESS;
+}
+
+void OmJsonStreamConverter::StripAttr(proto::AttrDef &attr, uint64_t &omitted_bytes) const {
+  if (option_.with_weight_data) {
+    return;
+  }
+  if (attr.has_t() && IsOversize(attr.t().data())) {
+    omitted_bytes += attr.t().data().size();
+    attr.mutable_t()->clear_data();
+  }
+  if (IsOversize(attr.bt())) {
+    omitted_bytes += attr.bt().size();
+    attr.clear_bt();
+  }
+  if (attr.has_func()) {
+    for (auto &sub_attr : *attr.mutable_func()->mutable_attr()) {
+      StripAttr(sub_attr.second, omitted_bytes);
+    }
+  }
+  if (attr.has_list()) {
+    auto *const list = attr.mutable_list();
+    for (auto &tensor : *list->mutable_t()) {
+      if (IsOversize(tensor.data())) {
+        omitted_bytes += tensor.data().size();
+        tensor.clear_data();
+      }
+    }
+    for (auto &bytes : *list->mutable_bt()) {
+      if (IsOversize(bytes)) {
+        omitted_bytes += bytes.size();
+        bytes.clear();
+      }
+    }
+    for (auto &named_attrs : *list->mutable_na()) {
+      for (auto &sub_attr : *named_attrs.mutable_attr()) {
+        StripAttr(sub_attr.second, omitted_bytes);
+      }
+    }
+  }
+}
+
+void OmJsonStreamConverter::StripOp(proto::OpDef &op_def, uint64_t &omitted_bytes) const {
+  for (auto &attr : *op_def.mutable_attr()) {
+    StripAttr(attr.second, omitted_bytes);
+  }
+}
+}  // namespace ge
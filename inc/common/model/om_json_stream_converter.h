@@ -0,0 +1,76 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_COMMON_MODEL_OM_JSON_STREAM_CONVERTER_H_
+#define GE_COMMON_MODEL_OM_JSON_STREAM_CONVERTER_H_
+
+#include <ostream>
+#include <string>
+
+#include "framework/common/ge_inner_error_codes.h"
+
+namespace google {
+namespace protobuf {
+class Message;
+}  // namespace protobuf
+}  // namespace google
+
+namespace ge {
+namespace proto {
+class AttrDef;
+class OpDef;
+}  // namespace proto
+
+struct OmJsonOption {
+  // tensor data and bytes attrs larger than kMaxInlineBytes are omitted and only their size is counted
+  bool with_weight_data = false;
+  bool add_whitespace = false;
+};
+
+/// Streaming conversion of an offline model (om) file into JSON, the streaming counterpart of ConvertOm.
+/// The file is mapped read only and the MODEL_DEF partition is walked at the protobuf wire level: only one OpDef
+/// is decoded at a time and written to the stream before the next one is read, so the memory used does not grow
+/// with the model. Weights, task info and kernels are summarized by their partition size.
+/// Files holding several models (header.model_num > 1) are read table by table as OmFileLoadHelper does. Only IR
+/// and standard models are supported, tiny and flow models are refused with UNSUPPORTED.
+/// Output: {"header": {...}, "partitions": [{"model_index", "type", "offset", "size"}], "models": [{"name",
+/// "version", "custom_version", "attr", "graph": [{"name", "input", "output", "attr", "op": [...],
+/// "omitted_bytes"}]}]}, partition offsets count from the start of the file.
+class OmJsonStreamConverter {
+ public:
+  static constexpr size_t kMaxInlineBytes = 1024U;
+
+  explicit OmJsonStreamConverter(const OmJsonOption &option = OmJsonOption()) : option_(option) {}
+  ~OmJsonStreamConverter() = default;
+
+  Status Convert(const std::string &om_file, const std::string &json_file) const;
+
+  Status Convert(const uint8_t *const data, const size_t len, std::ostream &os) const;
+
+ private:
+  Status WriteHeader(const uint8_t *const data, const size_t len, std::ostream &os) const;
+  Status WriteModelDef(const uint8_t *const data, const size_t len, std::ostream &os) const;
+  Status WriteGraphDef(const uint8_t *const data, const size_t len, std::ostream &os) const;
+  Status WriteMessage(const google::protobuf::Message &message, std::ostream &os) const;
+  Status WriteAttrEntry(const uint8_t *const data, const size_t len, bool &first, std::ostream &os,
+                        uint64_t &omitted_bytes) const;
+  void StripAttr(proto::AttrDef &attr, uint64_t &omitted_bytes) const;
+  void StripOp(proto::OpDef &op_def, uint64_t &omitted_bytes) const;
+
+  OmJsonOption option_;
+};
+}  // namespace ge
+#endif  // GE_COMMON_MODEL_OM_JSON_STREAM_CONVERTER_H_
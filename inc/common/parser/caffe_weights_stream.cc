@@ -0,0 +1,374 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/parser/caffe_weights_stream.h"
+
+#include <sys/mman.h>
+#include <cstring>
+
+#include "common/util/mem_utils.h"
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/debug/log.h"
+#include "graph/aligned_ptr.h"
+#include "mmpa/mmpa_api.h"
+
+namespace ge {
+namespace {
+constexpr uintptr_t kTensorDataAlign = 16U;  // alignment of AlignedPtr
+
+// field numbers of caffe.proto
+constexpr uint32_t kNetLayerField = 100U;
+constexpr uint32_t kNetV1LayersField = 2U;
+constexpr uint32_t kLayerNameField = 1U;
+constexpr uint32_t kLayerTypeField = 2U;
+constexpr uint32_t kLayerBlobsField = 7U;
+constexpr uint32_t kV1LayerNameField = 4U;
+constexpr uint32_t kV1LayerTypeField = 5U;
+constexpr uint32_t kV1LayerBlobsField = 6U;
+constexpr uint32_t kBlobNumField = 1U;
+constexpr uint32_t kBlobChannelsField = 2U;
+constexpr uint32_t kBlobHeightField = 3U;
+constexpr uint32_t kBlobWidthField = 4U;
+constexpr uint32_t kBlobDataField = 5U;
+constexpr uint32_t kBlobShapeField = 7U;
+constexpr uint32_t kBlobDoubleDataField = 8U;
+constexpr uint32_t kBlobShapeDimField = 1U;
+
+constexpr uint32_t kWireVarint = 0U;
+constexpr uint32_t kWireFixed64 = 1U;
+constexpr uint32_t kWireLengthDelimited = 2U;
+constexpr uint32_t kWireFixed32 = 5U;
+constexpr uint32_t kMaxVarintBytes = 10U;
+
+// protobuf wire format reader with 64 bit lengths, values are little endian like the hosts we run on
+class WireReader {
+ public:
+  WireReader(const uint8_t *const data, const size_t len) : pos_(data), end_(data + len) {}
+
+  bool Done() const {
+    return pos_ >= end_;
+  }
+
+  bool ReadVarint(uint64_t &value) {
+    value = 0U;
+    for (uint32_t i = 0U; (i < kMaxVarintBytes) && (pos_ < end_); ++i) {
+      const uint8_t byte = *pos_++;
+      value |= static_cast<uint64_t>(byte & 0x7FU) << (7U * i);
+      if ((byte & 0x80U) == 0U) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool ReadTag(uint32_t &field, uint32_t &wire_type) {
+    uint64_t tag = 0U;
+    if (!ReadVarint(tag)) {
+      return false;
+    }
+    field = static_cast<uint32_t>(tag >> 3U);
+    wire_type = static_cast<uint32_t>(tag & 0x7U);
+    return field != 0U;
+  }
+
+  bool ReadBytes(const uint8_t *&data, size_t &len) {
+    uint64_t size = 0U;
+    if ((!ReadVarint(size)) || (size > static_cast<uint64_t>(end_ - pos_))) {
+      return false;
+    }
+    data = pos_;
+    len = static_cast<size_t>(size);
+    pos_ += len;
+    return true;
+  }
+
+  template <typename T>
+  bool ReadFixed(T &value) {
+    if (static_cast<size_t>(end_ - pos_) < sizeof(T)) {
+      return false;
+    }
+    (void) std::memcpy(&value, pos_, sizeof(T));
+    pos_ += sizeof(T);
+    return true;
+  }
+
+  bool Skip(const uint32_t wire_type) {
+    uint64_t u64 = 0U;
+    uint32_t u32 = 0U;
+    const uint8_t *data = nullptr;
+    size_t len = 0U;
+    switch (wire_type) {
+      case kWireVarint:
+        return ReadVarint(u64);
+      case kWireFixed64:
+        return ReadFixed(u64);
+      case kWireLengthDelimited:
+        return ReadBytes(data, len);
+      case kWireFixed32:
+        return ReadFixed(u32);
+      default:
+        // groups are not used by caffe.proto
+        return false;
+    }
+  }
+
+ private:
+  const uint8_t *pos_;
+  const uint8_t *end_;
+};
+
+std::vector<float> &MutableConverted(CaffeBlobView &blob) {
+  if (blob.converted == nullptr) {
+    blob.converted = MakeShared<std::vector<float>>();
+    if (blob.converted == nullptr) {
+      static std::vector<float> empty;
+      return empty;
+    }
+    // data seen so far moves to the converted buffer
+    if (blob.data != nullptr) {
+      blob.converted->resize(blob.count);
+      (void) std::memcpy(blob.converted->data(), blob.data, blob.count * sizeof(float));
+      blob.data = nullptr;
+    }
+  }
+  return *blob.converted;
+}
+
+Status ParseBlobShape(const uint8_t *const data, const size_t len, std::vector<int64_t> &shape) {
+  WireReader reader(data, len);
+  while (!reader.Done()) {
+    uint32_t field = 0U;
+    uint32_t wire_type = 0U;
+    GE_CHK_BOOL_RET_STATUS(reader.ReadTag(field, wire_type), FAILED, "[Read][Tag]of BlobShape failed.");
+    uint64_t dim = 0U;
+    if ((field == kBlobShapeDimField) && (wire_type == kWireVarint)) {
+      GE_CHK_BOOL_RET_STATUS(reader.ReadVarint(dim), FAILED, "[Read][Dim]of BlobShape failed.");
+      shape.emplace_back(static_cast<int64_t>(dim));
+    } else if ((field == kBlobShapeDimField) && (wire_type == kWireLengthDelimited)) {
+      const uint8_t *packed = nullptr;
+      size_t packed_len = 0U;
+      GE_CHK_BOOL_RET_STATUS(reader.ReadBytes(packed, packed_len), FAILED, "[Read][Dims]of BlobShape failed.");
+      WireReader dim_reader(packed, packed_len);
+      while (!dim_reader.Done()) {
+        GE_CHK_BOOL_RET_STATUS(dim_reader.ReadVarint(dim), FAILED, "[Read][Dim]of BlobShape failed.");
+        shape.emplace_back(static_cast<int64_t>(dim));
+      }
+    } else {
+      GE_CHK_BOOL_RET_STATUS(reader.Skip(wire_type), FAILED, "[Skip][Field]%u of BlobShape failed.", field);
+    }
+  }
+  return SUCCESS;
+}
+
+Status ParseFloatData(WireReader &reader, const uint32_t wire_type, CaffeBlobView &blob) {
+  if (wire_type == kWireFixed32) {
+    float value = 0.0F;
+    GE_CHK_BOOL_RET_STATUS(reader.ReadFixed(value), FAILED, "[Read][Float]of blob failed.");
+    MutableConverted(blob).emplace_back(value);
+    return SUCCESS;
+  }
+  const uint8_t *packed = nullptr;
+  size_t packed_len = 0U;
+  GE_CHK_BOOL_RET_STATUS((wire_type == kWireLengthDelimited) && reader.ReadBytes(packed, packed_len) &&
+                         ((packed_len % sizeof(float)) == 0U), FAILED, "[Read][Floats]of blob failed.");
+  if ((blob.data == nullptr) && (blob.converted == nullptr)) {
+    // the usual case, one packed field which is used in place
+    blob.data = packed;
+    blob.count = packed_len / sizeof(float);
+    return SUCCESS;
+  }
+  std::vector<float> &converted = MutableConverted(blob);
+  const size_t old_size = converted.size();
+  converted.resize(old_size + (packed_len / sizeof(float)));
+  (void) std::memcpy(converted.data() + old_size, packed, packed_len);
+  return SUCCESS;
+}
+
+Status ParseDoubleData(WireReader &reader, const uint32_t wire_type, CaffeBlobView &blob) {
+  double value = 0.0;
+  if (wire_type == kWireFixed64) {
+    GE_CHK_BOOL_RET_STATUS(reader.ReadFixed(value), FAILED, "[Read][Double]of blob failed.");
+    MutableConverted(blob).emplace_back(static_cast<float>(value));
+    return SUCCESS;
+  }
+  const uint8_t *packed = nullptr;
+  size_t packed_len = 0U;
+  GE_CHK_BOOL_RET_STATUS((wire_type == kWireLengthDelimited) && reader.ReadBytes(packed, packed_len),
+                         FAILED, "[Read][Doubles]of blob failed.");
+  WireReader double_reader(packed, packed_len);
+  std::vector<float> &converted = MutableConverted(blob);
+  while (!double_reader.Done()) {
+    GE_CHK_BOOL_RET_STATUS(double_reader.ReadFixed(value), FAILED, "[Read][Double]of blob failed.");
+    converted.emplace_back(static_cast<float>(value));
+  }
+  return SUCCESS;
+}
+
+Status ParseBlob(const uint8_t *const data, const size_t len, CaffeBlobView &blob) {
+  WireReader reader(data, len);
+  std::vector<int64_t> legacy_shape(4U, 0);  // num, channels, height, width
+  bool has_legacy_shape = false;
+  while (!reader.Done()) {
+    uint32_t field = 0U;
+    uint32_t wire_type = 0U;
+    GE_CHK_BOOL_RET_STATUS(reader.ReadTag(field, wire_type), FAILED, "[Read][Tag]of BlobProto failed.");
+    if (field == kBlobDataField) {
+      GE_CHK_STATUS_RET_NOLOG(ParseFloatData(reader, wire_type, blob));
+    } else if (field == kBlobDoubleDataField) {
+      GE_CHK_STATUS_RET_NOLOG(ParseDoubleData(reader, wire_type, blob));
+    } else if ((field == kBlobShapeField) && (wire_type == kWireLengthDelimited)) {
+      const uint8_t *shape_data = nullptr;
+      size_t shape_len = 0U;
+      GE_CHK_BOOL_RET_STATUS(reader.ReadBytes(shape_data, shape_len), FAILED, "[Read][Shape]of BlobProto failed.");
+      GE_CHK_STATUS_RET_NOLOG(ParseBlobShape(shape_data, shape_len, blob.shape));
+    } else if ((field >= kBlobNumField) && (field <= kBlobWidthField) && (wire_type == kWireVarint)) {
+      uint64_t dim = 0U;
+      GE_CHK_BOOL_RET_STATUS(reader.ReadVarint(dim), FAILED, "[Read][Dim]of BlobProto failed.");
+      legacy_shape[field - kBlobNumField] = static_cast<int64_t>(static_cast<int32_t>(dim));
+      has_legacy_shape = true;
+    } else {
+      GE_CHK_BOOL_RET_STATUS(reader.Skip(wire_type), FAILED, "[Skip][Field]%u of BlobProto failed.", field);
+    }
+  }
+  if (blob.converted != nullptr) {
+    blob.count = blob.converted->size();
+  }
+  if (blob.shape.empty()) {
+    blob.shape = has_legacy_shape ? legacy_shape : std::vector<int64_t>{static_cast<int64_t>(blob.count)};
+  }
+  return SUCCESS;
+}
+
+Status ParseLayer(const uint8_t *const data, const size_t len, const bool is_v1, CaffeLayerWeights &layer) {
+  const uint32_t name_field = is_v1 ? kV1LayerNameField : kLayerNameField;
+  const uint32_t type_field = is_v1 ? kV1LayerTypeField : kLayerTypeField;
+  const uint32_t blobs_field = is_v1 ? kV1LayerBlobsField : kLayerBlobsField;
+  WireReader reader(data, len);
+  while (!reader.Done()) {
+    uint32_t field = 0U;
+    uint32_t wire_type = 0U;
+    GE_CHK_BOOL_RET_STATUS(reader.ReadTag(field, wire_type), FAILED, "[Read][Tag]of layer failed.");
+    const uint8_t *field_data = nullptr;
+    size_t field_len = 0U;
+    if ((field == name_field) && (wire_type == kWireLengthDelimited)) {
+      GE_CHK_BOOL_RET_STATUS(reader.ReadBytes(field_data, field_len), FAILED, "[Read][Name]of layer failed.");
+      layer.name.assign(reinterpret_cast<const char_t *>(field_data), field_len);
+    } else if ((field == type_field) && (wire_type == kWireLengthDelimited)) {
+      GE_CHK_BOOL_RET_STATUS(reader.ReadBytes(field_data, field_len), FAILED, "[Read][Type]of layer failed.");
+      layer.type.assign(reinterpret_cast<const char_t *>(field_data), field_len);
+    } else if ((field == type_field) && (wire_type == kWireVarint)) {
+      uint64_t type = 0U;
+      GE_CHK_BOOL_RET_STATUS(reader.ReadVarint(type), FAILED, "[Read][Type]of layer failed.");
+      layer.type = std::to_string(type);
+    } else if ((field == blobs_field) && (wire_type == kWireLengthDelimited)) {
+      GE_CHK_BOOL_RET_STATUS(reader.ReadBytes(field_data, field_len), FAILED, "[Read][Blob]of layer failed.");
+      CaffeBlobView blob;
+      GE_CHK_STATUS_RET(ParseBlob(field_data, field_len, blob), "[Parse][Blob]%zu of layer %s failed.",
+                        layer.blobs.size(), layer.name.c_str());
+      layer.blobs.emplace_back(std::move(blob));
+    } else {
+      GE_CHK_BOOL_RET_STATUS(reader.Skip(wire_type), FAILED, "[Skip][Field]%u of layer failed.", field);
+    }
+  }
+  return SUCCESS;
+}
+}  // namespace
+
+Status CaffeWeightsStream::Open(const std::string &file_path) {
+  ULONGLONG file_size = 0U;
+  if ((mmGetFileSize(file_path.c_str(), &file_size) != EN_OK) || (file_size == 0U)) {
+    GELOGE(FAILED, "[Get][FileSize]of %s failed or file is empty.", file_path.c_str());
+    return FAILED;
+  }
+  int32_t fd = mmOpen(file_path.c_str(), M_RDONLY);
+  if (fd < 0) {
+    GELOGE(FAILED, "[Open][File]%s failed.", file_path.c_str());
+    return FAILED;
+  }
+  const size_t len = static_cast<size_t>(file_size);
+  // copy-on-write: tensors built in place are writable without touching the file
+  void *const addr = mmMmap(fd, static_cast<mmSize_t>(len), 0, &fd, PROT_READ | PROT_WRITE, MAP_PRIVATE);
+  (void) mmClose(fd);
+  if ((addr == nullptr) || (addr == MAP_FAILED)) {
+    GELOGE(FAILED, "[Map][File]%s failed, size %zu.", file_path.c_str(), len);
+    return FAILED;
+  }
+  // the mapping is released with the last tensor built on it
+  const std::shared_ptr<const void> owner(addr, [len](const void *const mapped) {
+    (void) munmap(const_cast<void *>(mapped), len);
+  });
+  GELOGI("Map weights file %s, size %zu.", file_path.c_str(), len);
+  return Open(static_cast<uint8_t *>(addr), len, owner);
+}
+
+Status CaffeWeightsStream::Open(uint8_t *const data, const size_t len, const std::shared_ptr<const void> &owner) {
+  GE_CHECK_NOTNULL(data);
+  data_ = data;
+  len_ = len;
+  owner_ = owner;
+  return SUCCESS;
+}
+
+Status CaffeWeightsStream::ForEachLayer(const LayerVisitor &visitor) const {
+  GE_CHECK_NOTNULL(data_);
+  WireReader reader(data_, len_);
+  size_t layer_num = 0U;
+  while (!reader.Done()) {
+    uint32_t field = 0U;
+    uint32_t wire_type = 0U;
+    GE_CHK_BOOL_RET_STATUS(reader.ReadTag(field, wire_type), FAILED, "[Read][Tag]of NetParameter failed.");
+    if (((field != kNetLayerField) && (field != kNetV1LayersField)) || (wire_type != kWireLengthDelimited)) {
+      GE_CHK_BOOL_RET_STATUS(reader.Skip(wire_type), FAILED, "[Skip][Field]%u of NetParameter failed.", field);
+      continue;
+    }
+    const uint8_t *layer_data = nullptr;
+    size_t layer_len = 0U;
+    GE_CHK_BOOL_RET_STATUS(reader.ReadBytes(layer_data, layer_len), FAILED, "[Read][Layer]%zu failed.", layer_num);
+    CaffeLayerWeights layer;
+    GE_CHK_STATUS_RET(ParseLayer(layer_data, layer_len, field == kNetV1LayersField, layer),
+                      "[Parse][Layer]%zu failed.", layer_num);
+    ++layer_num;
+    if (!layer.blobs.empty()) {
+      GE_CHK_STATUS_RET(visitor(layer), "[Visit][Layer]%s failed.", layer.name.c_str());
+    }
+  }
+  GELOGI("Scan %zu layers from weights of size %zu.", layer_num, len_);
+  return SUCCESS;
+}
+
+Status CaffeWeightsStream::BuildTensor(const CaffeBlobView &blob, GeTensorPtr &tensor) const {
+  const GeTensorDesc tensor_desc(GeShape(blob.shape), FORMAT_NCHW, DT_FLOAT);
+  const size_t size = blob.count * sizeof(float);
+  const uint8_t *const data =
+      (blob.converted != nullptr) ? reinterpret_cast<const uint8_t *>(blob.converted->data()) : blob.data;
+  GE_CHECK_NOTNULL(data);
+  if ((reinterpret_cast<uintptr_t>(data) % kTensorDataAlign) != 0U) {
+    // data not aligned as AlignedPtr guarantees is copied
+    tensor = MakeShared<GeTensor>(tensor_desc, data, size);
+    GE_CHECK_NOTNULL(tensor);
+    return SUCCESS;
+  }
+  // the buffer is kept alive by the tensor, both the converted vector and the copy-on-write mapping are writable
+  const std::shared_ptr<const void> owner =
+      (blob.converted != nullptr) ? std::static_pointer_cast<const void>(blob.converted) : owner_;
+  const auto aligned_ptr = AlignedPtr::BuildFromData(const_cast<uint8_t *>(data),
+                                                     [owner](const uint8_t *const ptr) { (void) ptr; });
+  GE_CHECK_NOTNULL(aligned_ptr);
+  tensor = MakeShared<GeTensor>(tensor_desc, aligned_ptr, size);
+  GE_CHECK_NOTNULL(tensor);
+  return SUCCESS;
+}
+}  // namespace ge
@@ -0,0 +1,77 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_COMMON_PARSER_CAFFE_WEIGHTS_STREAM_H_
+#define GE_COMMON_PARSER_CAFFE_WEIGHTS_STREAM_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "framework/common/ge_inner_error_codes.h"
+#include "graph/ge_tensor.h"
+
+namespace ge {
+// one BlobProto of a layer, the float data points into the caffemodel when it is stored as one packed field
+struct CaffeBlobView {
+  std::vector<int64_t> shape;
+  const uint8_t *data = nullptr;  // little endian float32, may be unaligned
+  size_t count = 0U;
+  // filled instead of data when the blob has to be converted (double_data, unpacked or split float fields)
+  std::shared_ptr<std::vector<float>> converted;
+};
+
+struct CaffeLayerWeights {
+  std::string name;
+  std::string type;  // enum value as decimal string for V1 layers
+  std::vector<CaffeBlobView> blobs;
+};
+
+/// Streaming reader of the weights in a caffemodel.
+/// The file is mapped copy-on-write and the NetParameter is walked at the protobuf wire level: only the name, type and
+/// blobs of each layer are decoded, all other fields (including the large ones of data layers) are skipped by
+/// length. Offsets are 64 bits, so models larger than the 2 GB protobuf / 4 GB uint32 limits are supported.
+/// Tensors built by BuildTensor share the mapping when the blob data is aligned as AlignedPtr requires (16 bytes),
+/// the mapping is released with the last tensor. Weight passes may modify such tensors in place, which only touches
+/// private copies of the pages.
+class CaffeWeightsStream {
+ public:
+  using LayerVisitor = std::function<Status(const CaffeLayerWeights &)>;
+
+  CaffeWeightsStream() = default;
+  ~CaffeWeightsStream() = default;
+
+  Status Open(const std::string &file_path);
+  // the data must stay valid while owner is alive, tensors built in place may be modified through it
+  Status Open(uint8_t *const data, const size_t len, const std::shared_ptr<const void> &owner);
+
+  // calls the visitor for every layer which has blobs, in file order
+  Status ForEachLayer(const LayerVisitor &visitor) const;
+
+  Status BuildTensor(const CaffeBlobView &blob, GeTensorPtr &tensor) const;
+
+  size_t GetSize() const {
+    return len_;
+  }
+
+ private:
+  std::shared_ptr<const void> owner_;
+  const uint8_t *data_ = nullptr;
+  size_t len_ = 0U;
+};
+}  // namespace ge
+#endif  // GE_COMMON_PARSER_CAFFE_WEIGHTS_STREAM_H_
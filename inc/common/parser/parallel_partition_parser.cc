@@ -0,0 +1,206 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/parser/parallel_partition_parser.h"
+
+#include <algorithm>
+#include <future>
+#include <unordered_map>
+
+#include "common/thread_pool.h"
+#include "common/util/error_manager/error_manager.h"
+#include "common/util/mem_utils.h"
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/debug/log.h"
+#include "graph/ge_local_context.h"
+#include "graph/utils/graph_utils.h"
+
+namespace ge {
+namespace {
+constexpr uint32_t kMaxParseThreadNum = 16U;
+
+// runs func(i) for every i in [0, task_num) on the pool and returns the first failure in index order, the tasks run
+// with the thread local and error contexts of the caller
+template <typename Func>
+Status RunOnPool(const std::string &prefix, const uint32_t thread_num, const size_t task_num, const Func &func) {
+  ThreadPool pool(prefix, static_cast<uint32_t>(std::min(static_cast<size_t>(thread_num), task_num)));
+  const GEThreadLocalContext ge_context = GetThreadLocalContext();
+  const error_message::Context error_context = ErrorManager::GetInstance().GetErrorManagerContext();
+  std::vector<std::future<Status>> futures;
+  futures.reserve(task_num);
+  for (size_t i = 0U; i < task_num; ++i) {
+    auto future = pool.commit([&func, &ge_context, &error_context, i]() -> Status {
+      GetThreadLocalContext() = ge_context;
+      ErrorManager::GetInstance().SetErrorContext(error_context);
+      return func(i);
+    });
+    GE_CHK_BOOL_RET_STATUS(future.valid(), FAILED, "[Commit][Task]%zu of %s failed.", i, prefix.c_str());
+    futures.emplace_back(std::move(future));
+  }
+  Status ret = SUCCESS;
+  for (auto &future : futures) {
+    const Status status = future.get();
+    if ((ret == SUCCESS) && (status != SUCCESS)) {
+      ret = status;
+    }
+  }
+  return ret;
+}
+}  // namespace
+
+ParallelPartitionParser::ParallelPartitionParser(const PartitionParseFunc &parse_func, const uint32_t thread_num)
+    : parse_func_(parse_func),
+      thread_num_((thread_num == 0U) ? ThreadPool::GetDefaultThreadNum(kMaxParseThreadNum) : thread_num) {}
+
+Status ParallelPartitionParser::Parse(const std::vector<std::string> &partitioned_serialized,
+                                      const std::map<std::string, std::string> &const_value_map,
+                                      const std::string &graph_name, ComputeGraphPtr &graph) const {
+  std::vector<PartitionParseResult> results;
+  GE_CHK_STATUS_RET(ParsePartitions(partitioned_serialized, const_value_map, true, results),
+                    "[Parse][Partitions]of graph %s failed.", graph_name.c_str());
+  return Stitch(results, graph_name, graph);
+}
+
+Status ParallelPartitionParser::ParseSerial(const std::vector<std::string> &partitioned_serialized,
+                                            const std::map<std::string, std::string> &const_value_map,
+                                            const std::string &graph_name, ComputeGraphPtr &graph) const {
+  std::vector<PartitionParseResult> results;
+  GE_CHK_STATUS_RET(ParsePartitions(partitioned_serialized, const_value_map, false, results),
+                    "[Parse][Partitions]of graph %s failed.", graph_name.c_str());
+  return Stitch(results, graph_name, graph);
+}
+
+Status ParallelPartitionParser::ParseSubgraphs(const std::vector<std::string> &subgraph_names,
+                                               const GetPartitionsFunc &get_partitions,
+                                               std::vector<ComputeGraphPtr> &subgraphs) const {
+  GE_CHK_BOOL_RET_STATUS(get_partitions != nullptr, PARAM_INVALID, "[Check][Param]get partitions func is null.");
+  // the callback belongs to the framework parser and is not known to be thread safe, it is called on this thread
+  std::vector<std::vector<std::string>> partitions(subgraph_names.size());
+  std::vector<std::map<std::string, std::string>> const_value_maps(subgraph_names.size());
+  for (size_t i = 0U; i < subgraph_names.size(); ++i) {
+    GE_CHK_BOOL_RET_STATUS(get_partitions(subgraph_names[i], partitions[i], const_value_maps[i]), FAILED,
+                           "[Get][Partitions]of subgraph %s failed.", subgraph_names[i].c_str());
+  }
+  subgraphs.assign(subgraph_names.size(), nullptr);
+  // one task per subgraph, the partitions of a subgraph are parsed in its task so no task waits on the pool
+  const auto parse_subgraph = [this, &subgraph_names, &partitions, &const_value_maps,
+                               &subgraphs](const size_t index) -> Status {
+    return ParseSerial(partitions[index], const_value_maps[index], subgraph_names[index], subgraphs[index]);
+  };
+  if ((thread_num_ <= 1U) || (subgraph_names.size() <= 1U)) {
+    for (size_t i = 0U; i < subgraph_names.size(); ++i) {
+      GE_CHK_STATUS_RET_NOLOG(parse_subgraph(i));
+    }
+    return SUCCESS;
+  }
+  return RunOnPool("ge_psub_", thread_num_, subgraph_names.size(), parse_subgraph);
+}
+
+Status ParallelPartitionParser::ParsePartitions(const std::vector<std::string> &partitioned_serialized,
+                                                const std::map<std::string, std::string> &const_value_map,
+                                                const bool parallel,
+                                                std::vector<PartitionParseResult> &results) const {
+  GE_CHK_BOOL_RET_STATUS(parse_func_ != nullptr, PARAM_INVALID, "[Check][Param]partition parse func is null.");
+  results.assign(partitioned_serialized.size(), PartitionParseResult());
+  const auto parse_partition = [this, &partitioned_serialized, &const_value_map, &results](const size_t index) {
+    const Status ret = parse_func_(partitioned_serialized[index], const_value_map, results[index]);
+    if (ret != SUCCESS) {
+      GELOGE(ret, "[Parse][Partition]%zu of %zu failed.", index, partitioned_serialized.size());
+      return ret;
+    }
+    GE_CHECK_NOTNULL(results[index].graph);
+    return SUCCESS;
+  };
+  if ((!parallel) || (thread_num_ <= 1U) || (partitioned_serialized.size() <= 1U)) {
+    for (size_t i = 0U; i < partitioned_serialized.size(); ++i) {
+      GE_CHK_STATUS_RET_NOLOG(parse_partition(i));
+    }
+    return SUCCESS;
+  }
+  GELOGI("Parse %zu partitions with %u threads.", partitioned_serialized.size(), thread_num_);
+  return RunOnPool("ge_ppart_", thread_num_, partitioned_serialized.size(), parse_partition);
+}
+
+Status ParallelPartitionParser::Stitch(std::vector<PartitionParseResult> &results, const std::string &graph_name,
+                                       ComputeGraphPtr &graph) {
+  graph = MakeShared<ComputeGraph>(graph_name);
+  GE_CHECK_NOTNULL(graph);
+  std::unordered_map<std::string, NodePtr> name_to_node;
+  for (size_t i = 0U; i < results.size(); ++i) {
+    const ComputeGraphPtr &partition = results[i].graph;
+    const std::vector<NodePtr> nodes(partition->GetDirectNode().begin(), partition->GetDirectNode().end());
+    for (const auto &node : nodes) {
+      GE_CHECK_NOTNULL(node);
+      const auto inserted = name_to_node.emplace(node->GetName(), node);
+      GE_CHK_BOOL_RET_STATUS(inserted.second, FAILED, "[Check][Param]node %s of partition %zu is duplicated.",
+                             node->GetName().c_str(), i);
+      GE_CHK_BOOL_RET_STATUS(graph->AddNode(node) != nullptr, FAILED, "[Add][Node]%s to graph %s failed.",
+                             node->GetName().c_str(), graph_name.c_str());
+      GE_CHK_GRAPH_STATUS_RET(node->SetOwnerComputeGraph(graph), "[Set][Owner]of node %s failed.",
+                              node->GetName().c_str());
+    }
+    for (const auto &input_node : partition->GetInputNodes()) {
+      GE_CHK_BOOL_RET_STATUS(graph->AddInputNode(input_node) != nullptr, FAILED,
+                             "[Add][InputNode]%s to graph %s failed.", input_node->GetName().c_str(),
+                             graph_name.c_str());
+    }
+    auto out_nodes_info = partition->GetGraphOutNodesInfo();
+    graph->AppendGraphOutNodesInfo(out_nodes_info);
+    // subgraphs of all levels are registered on the root graph, the direct ones now belong to the stitched graph
+    for (const auto &subgraph : partition->GetAllSubgraphs()) {
+      GE_CHECK_NOTNULL(subgraph);
+      if (subgraph->GetParentGraph() == partition) {
+        subgraph->SetParentGraph(graph);
+      }
+      GE_CHK_GRAPH_STATUS_RET(graph->AddSubgraph(subgraph->GetName(), subgraph),
+                              "[Add][Subgraph]%s of partition %zu to graph %s failed.", subgraph->GetName().c_str(),
+                              i, graph_name.c_str());
+      partition->RemoveSubgraph(subgraph->GetName());
+    }
+    // the nodes now belong to the stitched graph only, edges are kept
+    for (const auto &node : nodes) {
+      GE_CHK_GRAPH_STATUS_RET(GraphUtils::RemoveJustNode(partition, node),
+                              "[Remove][Node]%s from partition %zu failed.", node->GetName().c_str(), i);
+    }
+  }
+
+  size_t edge_num = 0U;
+  for (size_t i = 0U; i < results.size(); ++i) {
+    for (const auto &edge : results[i].pending_edges) {
+      const auto src_iter = name_to_node.find(edge.src_name);
+      const auto dst_iter = name_to_node.find(edge.dst_name);
+      GE_CHK_BOOL_RET_STATUS((src_iter != name_to_node.end()) && (dst_iter != name_to_node.end()), FAILED,
+                             "[Check][Param]edge %s -> %s of partition %zu refers to an unknown node.",
+                             edge.src_name.c_str(), edge.dst_name.c_str(), i);
+      const NodePtr &src = src_iter->second;
+      const NodePtr &dst = dst_iter->second;
+      graphStatus ret = GRAPH_FAILED;
+      if ((edge.src_index == PendingEdge::kControlIndex) || (edge.dst_index == PendingEdge::kControlIndex)) {
+        ret = GraphUtils::AddEdge(src->GetOutControlAnchor(), dst->GetInControlAnchor());
+      } else {
+        ret = GraphUtils::AddEdge(src->GetOutDataAnchor(edge.src_index), dst->GetInDataAnchor(edge.dst_index));
+      }
+      GE_CHK_BOOL_RET_STATUS(ret == GRAPH_SUCCESS, FAILED, "[Add][Edge]%s:%d -> %s:%d failed.",
+                             edge.src_name.c_str(), edge.src_index, edge.dst_name.c_str(), edge.dst_index);
+      ++edge_num;
+    }
+  }
+  GELOGI("Stitch graph %s from %zu partitions, node num %zu, cross partition edge num %zu.", graph_name.c_str(),
+         results.size(), name_to_node.size(), edge_num);
+  results.clear();
+  return SUCCESS;
+}
+}  // namespace ge
@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_COMMON_PARSER_PARALLEL_PARTITION_PARSER_H_
+#define GE_COMMON_PARSER_PARALLEL_PARTITION_PARSER_H_
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "framework/common/ge_inner_error_codes.h"
+#include "graph/compute_graph.h"
+
+namespace ge {
+// an edge whose source node is in another partition, resolved by name when the partitions are stitched
+struct PendingEdge {
+  static constexpr int32_t kControlIndex = -1;
+  std::string src_name;
+  int32_t src_index = kControlIndex;  // kControlIndex for a control edge
+  std::string dst_name;
+  int32_t dst_index = kControlIndex;
+};
+
+struct PartitionParseResult {
+  // nodes of the partition with the edges inside it, input nodes, output nodes info and subgraphs are carried over
+  // to the stitched graph, the nodes are moved out of this graph
+  ComputeGraphPtr graph;
+  std::vector<PendingEdge> pending_edges;
+};
+
+/// Parses a partitioned serialized model (ModelParser::ParseProtoWithSubgraph with partitioned_serialized) with the
+/// partitions parsed concurrently.
+/// The framework specific parser provides the parse function of one partition, which must not touch state shared
+/// with other partitions. Every partition writes only its own result slot, the node name registry is built from the
+/// slots after all partitions are parsed, so parsing needs no lock. Stitching runs in partition order and the
+/// pending edges in the order they were reported, the result does not depend on the thread timing.
+class ParallelPartitionParser {
+ public:
+  using PartitionParseFunc = std::function<Status(const std::string &serialized,
+                                                  const std::map<std::string, std::string> &const_value_map,
+                                                  PartitionParseResult &result)>;
+  // same signature as domi::GetGraphCallbackV3
+  using GetPartitionsFunc = std::function<bool(const std::string &subgraph_name,
+                                               std::vector<std::string> &partitioned_serialized,
+                                               std::map<std::string, std::string> &const_value_map)>;
+
+  explicit ParallelPartitionParser(const PartitionParseFunc &parse_func, const uint32_t thread_num = 0U);
+  ~ParallelPartitionParser() = default;
+
+  Status Parse(const std::vector<std::string> &partitioned_serialized,
+               const std::map<std::string, std::string> &const_value_map, const std::string &graph_name,
+               ComputeGraphPtr &graph) const;
+
+  // parses each subgraph from the partitions returned by get_partitions, which is called for all subgraphs on the
+  // calling thread first; the subgraphs are then parsed concurrently and their partitions one after another;
+  // subgraphs[i] belongs to subgraph_names[i]
+  Status ParseSubgraphs(const std::vector<std::string> &subgraph_names, const GetPartitionsFunc &get_partitions,
+                        std::vector<ComputeGraphPtr> &subgraphs) const;
+
+ private:
+  Status ParsePartitions(const std::vector<std::string> &partitioned_serialized,
+                         const std::map<std::string, std::string> &const_value_map, const bool parallel,
+                         std::vector<PartitionParseResult> &results) const;
+  static Status Stitch(std::vector<PartitionParseResult> &results, const std::string &graph_name,
+                       ComputeGraphPtr &graph);
+  Status ParseSerial(const std::vector<std::string> &partitioned_serialized,
+                     const std::map<std::string, std::string> &const_value_map, const std::string &graph_name,
+                     ComputeGraphPtr &graph) const;
+
+  PartitionParseFunc parse_func_;
+  uint32_t thread_num_;
+};
+}  // namespace ge
+#endif  // GE_COMMON_PARSER_PARALLEL_PARTITION_PARSER_H_
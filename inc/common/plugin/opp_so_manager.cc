@@ -16,9 +16,11 @@
 
 #include "common/plugin/opp_so_manager.h"
 
+#include <algorithm>
 #include <string>
 
 #include "common/plugin/plugin_manager.h"
+#include "common/thread_pool.h"
 #include "graph/opsproto_manager.h"
 #include "common/util/error_manager/error_manager.h"
 #include "common/util/mem_utils.h"
@@ -33,6 +35,19 @@
 
 namespace ge {
 namespace {
+constexpr uint32_t kMaxReadSoThreadNum = 8U;
+
+std::string ReadSoData(const std::string &so_path) {
+  uint32_t len = 0U;
+  std::string path = so_path;
+  const auto so_data = GetBinFromFile(path, len);
+  if (so_data == nullptr) {
+    GELOGW("Failed to read so %s!", so_path.c_str());
+    return "";
+  }
+  return std::string(so_data.get(), so_data.get() + len);
+}
+
 void CloseHandle(void * const handle) {
   if (handle != nullptr) {
     if (mmDlclose(handle) != 0) {
@@ -63,6 +78,7 @@ void OppSoManager::LoadOpsProtoSo() const {
 
   std::vector<std::string> v_path;
   PluginManager::SplitPath(ops_proto_path, v_path);
+  std::vector<std::string> so_list;
   for (auto i = 0UL; i < v_path.size(); ++i) {
     std::string path = v_path[i] + "lib/" + os_type + "/" + cpu_type + "/";
     char_t resolved_path[MMPA_MAX_PATH] = {};
@@ -71,14 +87,11 @@ void OppSoManager::LoadOpsProtoSo() const {
       GELOGW("[FindSo][Check] Get path with os&cpu type [%s] failed, reason:%s", path.c_str(), strerror(errno));
       path = v_path[i];
     }
-    std::vector<std::string> so_list;
-    PluginManager::GetFileListWithSuffix(path, "rt2.0.so", so_list);
-    for (const auto &so_path : so_list) {
-      if (SaveSo(so_path) != ge::GRAPH_SUCCESS) {
-        GELOGW("Save so failed!");
-      }
-    }
+    std::vector<std::string> path_so_list;
+    PluginManager::GetFileListWithSuffix(path, "rt2.0.so", path_so_list);
+    (void)so_list.insert(so_list.end(), path_so_list.begin(), path_so_list.end());
   }
+  LoadSoList(so_list);
 }
 
 void OppSoManager::LoadOpMasterSo() const {
@@ -95,6 +108,7 @@ void OppSoManager::LoadOpMasterSo() const {
 
   std::vector<std::string> path_vec;
   PluginManager::SplitPath(op_tiling_path, path_vec);
+  std::vector<std::string> so_list;
   for (const auto &path : path_vec) {
     std::string root_path = path + "op_master/lib/" + os_type + "/" + cpu_type + "/";
     char_t resolved_path[MMPA_MAX_PATH] = {};
@@ -106,20 +120,42 @@ void OppSoManager::LoadOpMasterSo() const {
         continue;
       }
     }
-    std::vector<std::string> so_list;
-    PluginManager::GetFileListWithSuffix(root_path, "rt2.0.so", so_list);
-    for (const auto &so_path : so_list) {
-      if (SaveSo(so_path) != ge::GRAPH_SUCCESS) {
-        GELOGW("Save so failed!");
-      }
+    std::vector<std::string> path_so_list;
+    PluginManager::GetFileListWithSuffix(root_path, "rt2.0.so", path_so_list);
+    (void)so_list.insert(so_list.end(), path_so_list.begin(), path_so_list.end());
+  }
+  LoadSoList(so_list);
+}
+
+void OppSoManager::LoadSoList(const std::vector<std::string> &so_list) const {
+  if (so_list.empty()) {
+    return;
+  }
+  // Reading the whole so, which is the registry key, dominates and is done concurrently. dlopen stays serial and
+  // in list order: the libraries are opened RTLD_GLOBAL so the order decides symbol interposition, and the loader
+  // lock serializes concurrent dlopen anyway.
+  const uint32_t thread_num = std::min(ThreadPool::GetDefaultThreadNum(kMaxReadSoThreadNum),
+                                       static_cast<uint32_t>(so_list.size()));
+  ThreadPool pool("ge_readso_", thread_num);
+  std::vector<std::future<std::string>> so_datas;
+  so_datas.reserve(so_list.size());
+  for (const auto &so_path : so_list) {
+    so_datas.emplace_back(pool.commit([&so_path]() -> std::string { return ReadSoData(so_path); }));
+  }
+  for (size_t i = 0U; i < so_list.size(); ++i) {
+    const std::string so_data = so_datas[i].valid() ? so_datas[i].get() : ReadSoData(so_list[i]);
+    if (SaveSo(so_list[i], so_data) != ge::GRAPH_SUCCESS) {
+      GELOGW("Save so failed!");
     }
   }
 }
 
-Status OppSoManager::SaveSo(const std::string &so_path) const {
-  uint32_t len;
-  const auto so_data = GetBinFromFile(const_cast<std::string &>(so_path), len);
-  std::string str_so_data(so_data.get(), so_data.get()+len);
+Status OppSoManager::SaveSo(const std::string &so_path, const std::string &str_so_data) const {
+  // the so data is the registry key, an unreadable so must not match the key of another one
+  if (str_so_data.empty()) {
+    GELOGW("So data of %s is empty!", so_path.c_str());
+    return ge::GRAPH_FAILED;
+  }
   if (gert::OpImplRegistryHolderManager::GetInstance().GetOpImplRegistryHolder(str_so_data) != nullptr) {
     GELOGI("So already loaded!");
     return ge::GRAPH_SUCCESS;
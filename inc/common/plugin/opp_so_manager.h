@@ -18,6 +18,8 @@
 #define GE_COMMON_GE_OPP_SO_MANAGER_H_
 
 #include <map>
+#include <string>
+#include <vector>
 #include "framework/common/ge_inner_error_codes.h"
 
 namespace ge {
@@ -31,7 +33,8 @@ class OppSoManager {
  private:
   void LoadOpsProtoSo() const;
   void LoadOpMasterSo() const;
-  Status SaveSo(const std::string &so_path) const;
+  void LoadSoList(const std::vector<std::string> &so_list) const;
+  Status SaveSo(const std::string &so_path, const std::string &str_so_data) const;
 };
 }  // namespace ge
 
@@ -21,6 +21,7 @@
 #include <iostream>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <type_traits>
 #include <typeinfo>
@@ -101,17 +102,14 @@ class PluginManager {
 
   template <typename R, typename... Types>
   Status GetAllFunctions(const std::string &func_name, std::map<std::string, std::function<R(Types... args)>> &funcs) {
-    for (const auto &handle : handles_) {
-      const auto real_fn = reinterpret_cast<R(*)(Types...)>(mmDlsym(handle.second, func_name.c_str()));
-      if (real_fn == nullptr) {
-        const char *error = mmDlerror();
-        if (error == nullptr) {
-          error = "";
-        }
-        GELOGW("Failed to get function %s in %s! errmsg:%s", func_name.c_str(), handle.first.c_str(), error);
+    const auto symbols = ResolveSymbol(func_name);
+    for (const auto &symbol : *symbols) {
+      if (symbol.addr == nullptr) {
+        GELOGW("Failed to get function %s in %s! errmsg:%s", func_name.c_str(), symbol.so_name.c_str(),
+               symbol.error.c_str());
         return GE_PLGMGR_FUNC_NOT_EXIST;
       } else {
-        funcs[handle.first] = real_fn;
+        funcs[symbol.so_name] = reinterpret_cast<R(*)(Types...)>(symbol.addr);
       }
     }
     return SUCCESS;
@@ -119,15 +117,13 @@ class PluginManager {
 
   template <typename... Types>
   Status InvokeAll(const std::string &func_name, const Types... args) {
-    for (const auto &handle : handles_) {
+    const auto symbols = ResolveSymbol(func_name);
+    for (const auto &symbol : *symbols) {
       // If the funcName is existed, signature of realFn can be casted to any type
-      const auto real_fn = reinterpret_cast<void (*)(Types...)>(mmDlsym(handle.second, func_name.c_str()));
+      const auto real_fn = reinterpret_cast<void (*)(Types...)>(symbol.addr);
       if (real_fn == nullptr) {
-        const char *error = mmDlerror();
-        if (error == nullptr) {
-          error = "";
-        }
-        GELOGW("Failed to invoke function %s in %s! errmsg:%s", func_name.c_str(), handle.first.c_str(), error);
+        GELOGW("Failed to invoke function %s in %s! errmsg:%s", func_name.c_str(), symbol.so_name.c_str(),
+               symbol.error.c_str());
         return GE_PLGMGR_INVOKE_FAILED;
       } else {
         real_fn(args...);
@@ -138,15 +134,13 @@ class PluginManager {
 
   template <typename T>
   Status InvokeAll(const std::string &func_name, const T arg) {
-    for (const auto &handle : handles_) {
+    const auto symbols = ResolveSymbol(func_name);
+    for (const auto &symbol : *symbols) {
       // If the funcName is existed, signature of realFn can be casted to any type
-      const auto real_fn = reinterpret_cast<void (*)(T)>(mmDlsym(handle.second, func_name.c_str()));
+      const auto real_fn = reinterpret_cast<void (*)(T)>(symbol.addr);
       if (real_fn == nullptr) {
-        const char_t *error = mmDlerror();
-        if (error == nullptr) {
-          error = "";
-        }
-        GELOGW("Failed to invoke function %s in %s! errmsg:%s", func_name.c_str(), handle.first.c_str(), error);
+        GELOGW("Failed to invoke function %s in %s! errmsg:%s", func_name.c_str(), symbol.so_name.c_str(),
+               symbol.error.c_str());
         return GE_PLGMGR_INVOKE_FAILED;
       }
       typename std::remove_reference<T>::type arg_temp;
@@ -157,7 +151,7 @@ class PluginManager {
         for (const auto &val : arg_temp) {
           if (arg.find(val.first) != arg.end()) {
             GELOGW("FuncName %s in so %s find the same key: %s, will replace it", func_name.c_str(),
-                   handle.first.c_str(), val.first.c_str());
+                   symbol.so_name.c_str(), val.first.c_str());
             arg[val.first] = val.second;
           }
         }
@@ -169,14 +163,15 @@ class PluginManager {
 
   template <typename... Args>
   void OptionalInvokeAll(const std::string &func_name, const Args... args) const {
-    for (const auto &handle : handles_) {
+    const auto symbols = ResolveSymbol(func_name);
+    for (const auto &symbol : *symbols) {
       // If the funcName is existed, signature of realFn can be casted to any type
-      const auto real_fn = reinterpret_cast<void (*)(Args...)>(mmDlsym(handle.second, func_name.c_str()));
+      const auto real_fn = reinterpret_cast<void (*)(Args...)>(symbol.addr);
       if (real_fn == nullptr) {
-        GELOGI("func %s not exist in so %s", handle.first.c_str(), func_name.c_str());
+        GELOGI("func %s not exist in so %s", symbol.so_name.c_str(), func_name.c_str());
         continue;
       } else {
-        GELOGI("func %s exists in so %s", handle.first.c_str(), func_name.c_str());
+        GELOGI("func %s exists in so %s", symbol.so_name.c_str(), func_name.c_str());
         real_fn(args...);
       }
     }
@@ -184,15 +179,13 @@ class PluginManager {
 
   template <typename T1, typename T2>
   Status InvokeAll(const std::string &func_name, const T1 arg) {
-    for (const auto &handle : handles_) {
+    const auto symbols = ResolveSymbol(func_name);
+    for (const auto &symbol : *symbols) {
       // If the funcName is existed, signature of realFn can be casted to any type
-      const auto real_fn = reinterpret_cast<T2(*)(T1)>(mmDlsym(handle.second, func_name.c_str()));
+      const auto real_fn = reinterpret_cast<T2(*)(T1)>(symbol.addr);
       if (real_fn == nullptr) {
-        const char_t *error = mmDlerror();
-        if (error == nullptr) {
-          error = "";
-        }
-        GELOGW("Failed to invoke function %s in %s! errmsg:%s", func_name.c_str(), handle.first.c_str(), error);
+        GELOGW("Failed to invoke function %s in %s! errmsg:%s", func_name.c_str(), symbol.so_name.c_str(),
+               symbol.error.c_str());
         return GE_PLGMGR_INVOKE_FAILED;
       } else {
         const T2 res = real_fn(arg);
@@ -206,15 +199,13 @@ class PluginManager {
 
   template <typename T>
   Status InvokeAll(const std::string &func_name) {
-    for (const auto &handle : handles_) {
+    const auto symbols = ResolveSymbol(func_name);
+    for (const auto &symbol : *symbols) {
       // If the funcName is existed, signature of realFn can be casted to any type
-      const auto real_fn = reinterpret_cast<T(*)()>(mmDlsym(handle.second, func_name.c_str()));
+      const auto real_fn = reinterpret_cast<T(*)()>(symbol.addr);
       if (real_fn == nullptr) {
-        const char_t *error = mmDlerror();
-        if (error == nullptr) {
-          error = "";
-        }
-        GELOGW("Failed to invoke function %s in %s! errmsg:%s", func_name.c_str(), handle.first.c_str(), error);
+        GELOGW("Failed to invoke function %s in %s! errmsg:%s", func_name.c_str(), symbol.so_name.c_str(),
+               symbol.error.c_str());
         return GE_PLGMGR_INVOKE_FAILED;
       } else {
         const T res = real_fn();
@@ -227,6 +218,56 @@ class PluginManager {
   }
 
  private:
+  struct ResolvedSymbol {
+    std::string so_name;
+    void *handle;
+    void *addr;
+    std::string error;
+  };
+  using ResolvedSymbols = std::vector<ResolvedSymbol>;
+
+  // mmDlsym of every handle is done once per func name, repeated calls only walk the cached addresses.
+  // The entry is resolved again when the loaded handles differ from the ones it was built with (LoadSo added a so).
+  std::shared_ptr<const ResolvedSymbols> ResolveSymbol(const std::string &func_name) const {
+    const std::lock_guard<std::mutex> lock(symbol_mutex_);
+    auto &symbols = symbol_cache_[func_name];
+    if ((symbols != nullptr) && IsSymbolCacheValid(*symbols)) {
+      return symbols;
+    }
+    auto resolved = std::make_shared<ResolvedSymbols>();
+    resolved->reserve(handles_.size());
+    for (const auto &handle : handles_) {
+      ResolvedSymbol symbol{handle.first, handle.second, mmDlsym(handle.second, func_name.c_str()), ""};
+      if (symbol.addr == nullptr) {
+        const char_t *error = mmDlerror();
+        symbol.error = (error == nullptr) ? "" : error;
+      }
+      resolved->emplace_back(std::move(symbol));
+    }
+    symbols = resolved;
+    return symbols;
+  }
+
+  // Called by ClearHandles_ before the handles are closed, a later dlopen may hand out the same handle values.
+  void ClearSymbolCache_() const noexcept {
+    const std::lock_guard<std::mutex> lock(symbol_mutex_);
+    symbol_cache_.clear();
+  }
+
+  bool IsSymbolCacheValid(const ResolvedSymbols &symbols) const {
+    if (symbols.size() != handles_.size()) {
+      return false;
+    }
+    auto symbol = symbols.cbegin();
+    for (const auto &handle : handles_) {
+      if ((symbol->handle != handle.second) || (symbol->so_name != handle.first)) {
+        return false;
+      }
+      ++symbol;
+    }
+    return true;
+  }
+
   void ClearHandles_() noexcept;
   Status ValidateSo(const std::string &file_path, const int64_t size_of_loaded_so, int64_t &file_size) const;
   static bool ParseVersion(std::string &line, std::string &version, const std::string version_name);
@@ -238,6 +279,8 @@ class PluginManager {
                                        std::string &compiler_version);
   std::vector<std::string> so_list_;
   std::map<std::string, void *> handles_;
+  mutable std::mutex symbol_mutex_;
+  mutable std::map<std::string, std::shared_ptr<const ResolvedSymbols>> symbol_cache_;
 };
 
 inline std::string GetModelPath() {
@@ -0,0 +1,160 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/runtime/device_replay_cache.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/checker.h"
+#include "framework/common/debug/ge_log.h"
+
+namespace gert {
+namespace {
+constexpr size_t kHashSeed = 0x9E3779B97F4A7C15UL;
+
+void HashCombine(size_t &seed, const int64_t value) {
+  seed ^= std::hash<int64_t>()(value) + kHashSeed + (seed << 6U) + (seed >> 2U);
+}
+}  // namespace
+
+ShapeSignature::ShapeSignature(const std::vector<std::vector<int64_t>> &input_shapes,
+                               const std::vector<ValueDependentInput> &value_inputs) {
+  size_t dim_num = input_shapes.size();
+  for (const auto &shape : input_shapes) {
+    dim_num += shape.size();
+  }
+  dims_.reserve(dim_num);
+  for (const auto &shape : input_shapes) {
+    dims_.emplace_back(static_cast<int64_t>(shape.size()));
+    dims_.insert(dims_.end(), shape.begin(), shape.end());
+  }
+  for (const int64_t dim : dims_) {
+    HashCombine(hash_, dim);
+  }
+  for (const auto &value_input : value_inputs) {
+    const auto *const data = static_cast<const uint8_t *>(value_input.data);
+    const auto *const index = reinterpret_cast<const uint8_t *>(&value_input.input_index);
+    const auto *const size = reinterpret_cast<const uint8_t *>(&value_input.size);
+    values_.insert(values_.end(), index, index + sizeof(value_input.input_index));
+    values_.insert(values_.end(), size, size + sizeof(value_input.size));
+    if (data != nullptr) {
+      values_.insert(values_.end(), data, data + value_input.size);
+    }
+  }
+  for (const uint8_t value : values_) {
+    HashCombine(hash_, static_cast<int64_t>(value));
+  }
+}
+
+DeviceReplayCache::DeviceReplayCache(const size_t capacity) : capacity_((capacity == 0U) ? 1U : capacity) {}
+
+std::shared_ptr<const ReplayRecord> DeviceReplayCache::Find(const ShapeSignature &signature) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  const auto iter = index_.find(signature);
+  if (iter == index_.end()) {
+    ++miss_count_;
+    return nullptr;
+  }
+  ++hit_count_;
+  lru_list_.splice(lru_list_.begin(), lru_list_, iter->second);
+  return iter->second->second;
+}
+
+ge::graphStatus DeviceReplayCache::Insert(const ShapeSignature &signature, ReplayRecord &&record) {
+  if (record.data_dependent_output_shape) {
+    GELOGD("Output shapes depend on data, the record is not cached.");
+    return ge::GRAPH_NOT_CHANGED;
+  }
+  for (const auto &patch_point : record.patch_points) {
+    GE_ASSERT_TRUE(patch_point.task_index < record.tasks.size(), "Patch task index %u exceeds task num %zu",
+                   patch_point.task_index, record.tasks.size());
+    const auto &args = record.tasks[patch_point.task_index].args;
+    GE_ASSERT_TRUE((args.size() >= sizeof(uint64_t)) && (patch_point.args_offset <= (args.size() - sizeof(uint64_t))),
+                   "Patch offset %u exceeds args size %zu of task %u", patch_point.args_offset, args.size(),
+                   patch_point.task_index);
+  }
+  // replay walks the tasks in order, sorted patch points are applied in one pass
+  std::stable_sort(record.patch_points.begin(), record.patch_points.end(),
+                   [](const ArgsPatchPoint &lhs, const ArgsPatchPoint &rhs) {
+                     return lhs.task_index < rhs.task_index;
+                   });
+  auto cached = std::make_shared<const ReplayRecord>(std::move(record));
+  GE_ASSERT_NOTNULL(cached);
+
+  const std::lock_guard<std::mutex> lock(mutex_);
+  const auto iter = index_.find(signature);
+  if (iter != index_.end()) {
+    iter->second->second = std::move(cached);
+    lru_list_.splice(lru_list_.begin(), lru_list_, iter->second);
+    return ge::GRAPH_SUCCESS;
+  }
+  if (lru_list_.size() >= capacity_) {
+    (void)index_.erase(lru_list_.back().first);
+    lru_list_.pop_back();
+    ++evict_count_;
+  }
+  lru_list_.emplace_front(signature, std::move(cached));
+  index_[signature] = lru_list_.begin();
+  GELOGD("Insert device cache record, size %zu, capacity %zu, evict count %lu.", lru_list_.size(), capacity_,
+         evict_count_);
+  return ge::GRAPH_SUCCESS;
+}
+
+void DeviceReplayCache::Clear() {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  index_.clear();
+  lru_list_.clear();
+}
+
+size_t DeviceReplayCache::GetSize() const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return lru_list_.size();
+}
+
+ge::graphStatus DeviceReplayCache::Replay(const std::shared_ptr<const ReplayRecord> &record,
+                                          const std::vector<uint64_t> &addrs, ReplayContext &context,
+                                          const LaunchFunc &launch_func) {
+  GE_ASSERT_NOTNULL(record);
+  GE_ASSERT_NOTNULL(launch_func);
+  // the args templates are copied once per record, replaying it again only rewrites the patched addresses
+  if (context.record != record) {
+    context.record = nullptr;
+    context.args.resize(record->tasks.size());
+    for (size_t task_index = 0U; task_index < record->tasks.size(); ++task_index) {
+      context.args[task_index].assign(record->tasks[task_index].args.begin(), record->tasks[task_index].args.end());
+    }
+    context.record = record;
+  }
+  size_t patch_index = 0U;
+  for (size_t task_index = 0U; task_index < record->tasks.size(); ++task_index) {
+    const ReplayTask &task = record->tasks[task_index];
+    auto &args = context.args[task_index];
+    for (; (patch_index < record->patch_points.size()) &&
+           (record->patch_points[patch_index].task_index == task_index);
+         ++patch_index) {
+      const ArgsPatchPoint &patch_point = record->patch_points[patch_index];
+      GE_ASSERT_TRUE(patch_point.addr_index < addrs.size(), "Patch address index %u exceeds address num %zu",
+                     patch_point.addr_index, addrs.size());
+      const uint64_t addr = addrs[patch_point.addr_index] + patch_point.addr_offset;
+      (void)memcpy(args.data() + patch_point.args_offset, &addr, sizeof(addr));
+    }
+    GE_ASSERT_GRAPH_SUCCESS(launch_func(task, args.data(), args.size()), "Replay task %zu of type %u failed",
+                            task_index, task.task_type);
+  }
+  return ge::GRAPH_SUCCESS;
+}
+}  // namespace gert
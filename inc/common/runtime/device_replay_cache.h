@@ -0,0 +1,170 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AIR_CXX_COMMON_RUNTIME_DEVICE_REPLAY_CACHE_H_
+#define AIR_CXX_COMMON_RUNTIME_DEVICE_REPLAY_CACHE_H_
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "graph/ge_error_codes.h"
+
+namespace gert {
+/**
+ * tiling依赖其值的输入（值依赖输入），数据需在host侧可读
+ */
+struct ValueDependentInput {
+  uint32_t input_index;
+  const void *data;
+  size_t size;
+};
+
+/**
+ * 输入shape签名，dims按输入顺序展开，每个输入前记录维度数，因此[2,3]+[4]与[2]+[3,4]的签名不同
+ * 图中有值依赖tiling的算子时，值依赖输入的数据也必须加入签名，否则相同shape不同值时会replay过期的tiling data
+ */
+class ShapeSignature {
+ public:
+  ShapeSignature() = default;
+  explicit ShapeSignature(const std::vector<std::vector<int64_t>> &input_shapes,
+                          const std::vector<ValueDependentInput> &value_inputs = {});
+
+  bool operator==(const ShapeSignature &other) const {
+    return (hash_ == other.hash_) && (dims_ == other.dims_) && (values_ == other.values_);
+  }
+  size_t GetHash() const {
+    return hash_;
+  }
+
+ private:
+  std::vector<int64_t> dims_;
+  std::vector<uint8_t> values_;  // 每个值依赖输入依次记录index、长度与数据
+  size_t hash_ = 0U;
+};
+
+struct ShapeSignatureHash {
+  size_t operator()(const ShapeSignature &signature) const {
+    return signature.GetHash();
+  }
+};
+
+/**
+ * 需要在replay时刷新的地址：把addrs[addr_index] + addr_offset写到第task_index个task的args的args_offset处
+ * addrs由执行器在每次执行时给出（输入、输出、workspace基址等），其余args内容在缓存时已经确定
+ */
+struct ArgsPatchPoint {
+  uint32_t task_index;
+  uint32_t args_offset;
+  uint32_t addr_index;
+  uint64_t addr_offset;
+};
+
+/**
+ * 一个已准备好的device task，task_desc由launcher解释（kernel句柄、block dim、tiling key等），
+ * args为下发时的kernel args模板（含tiling data），地址部分在replay时刷新
+ */
+struct ReplayTask {
+  uint32_t task_type;
+  std::vector<uint8_t> task_desc;
+  std::vector<uint8_t> args;
+};
+
+/**
+ * 一个shape签名对应的完整执行记录
+ */
+struct ReplayRecord {
+  std::vector<ReplayTask> tasks;
+  std::vector<ArgsPatchPoint> patch_points;  // 插入缓存时按task_index排序
+  uint64_t workspace_size;                   // workspace整块大小，各task的workspace以patch point的偏移表达
+  std::vector<std::vector<int64_t>> output_shapes;
+  // 图中有输出shape依赖数据的算子（第三类算子），output_shapes无法由签名确定，这样的记录不会被缓存
+  bool data_dependent_output_shape = false;
+};
+
+/**
+ * replay时的可复用数据，每个stream一个
+ * 连续replay同一条记录时args只在第一次从模板拷贝，之后只刷新patch point处的地址
+ */
+struct ReplayContext {
+  std::shared_ptr<const ReplayRecord> record;
+  std::vector<std::vector<uint8_t>> args;
+};
+
+/**
+ * 按输入shape签名缓存已准备好的task、kernel args和workspace布局，命中后只刷新地址即可重新下发，
+ * 不再执行infershape/tiling/args组装。容量按shape签名做LRU淘汰
+ * 记录由执行器在首次执行时生成，task的下发与device侧资源（args内存等）由LaunchFunc的实现管理；
+ * 当前闭源执行器尚未生成记录，RtCacheMode::kDeviceCache也尚未使用本缓存
+ */
+class DeviceReplayCache {
+ public:
+  using LaunchFunc = std::function<ge::graphStatus(const ReplayTask &task, const uint8_t *args, size_t args_size)>;
+  static constexpr size_t kDefaultCapacity = 16U;
+
+  explicit DeviceReplayCache(const size_t capacity = kDefaultCapacity);
+  ~DeviceReplayCache() = default;
+
+  /**
+   * 查找签名对应的记录，命中时该签名变为最近使用
+   * @return 未命中时返回nullptr
+   */
+  std::shared_ptr<const ReplayRecord> Find(const ShapeSignature &signature);
+
+  /**
+   * 插入或替换签名对应的记录，超出容量时淘汰最久未使用的签名
+   * @return 记录的输出shape依赖数据时不缓存，返回GRAPH_NOT_CHANGED
+   */
+  ge::graphStatus Insert(const ShapeSignature &signature, ReplayRecord &&record);
+
+  void Clear();
+
+  /**
+   * 刷新地址后按顺序下发record中的task
+   * @param addrs 本次执行的地址表，patch point的addr_index下标
+   */
+  static ge::graphStatus Replay(const std::shared_ptr<const ReplayRecord> &record, const std::vector<uint64_t> &addrs,
+                                ReplayContext &context, const LaunchFunc &launch_func);
+
+  size_t GetSize() const;
+  size_t GetCapacity() const {
+    return capacity_;
+  }
+  uint64_t GetHitCount() const {
+    return hit_count_;
+  }
+  uint64_t GetMissCount() const {
+    return miss_count_;
+  }
+  uint64_t GetEvictCount() const {
+    return evict_count_;
+  }
+
+ private:
+  using LruList = std::list<std::pair<ShapeSignature, std::shared_ptr<const ReplayRecord>>>;
+  size_t capacity_;
+  mutable std::mutex mutex_;
+  LruList lru_list_;  // 头部为最近使用
+  std::unordered_map<ShapeSignature, LruList::iterator, ShapeSignatureHash> index_;
+  uint64_t hit_count_ = 0U;
+  uint64_t miss_count_ = 0U;
+  uint64_t evict_count_ = 0U;
+};
+}  // namespace gert
+#endif  // AIR_CXX_COMMON_RUNTIME_DEVICE_REPLAY_CACHE_H_
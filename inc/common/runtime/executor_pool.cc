@@ -0,0 +1,202 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/runtime/executor_pool.h"
+
+#include "common/checker.h"
+#include "framework/common/debug/ge_log.h"
+#include "framework/runtime/gert_api.h"
+#include "runtime/mem.h"
+#include "runtime/stream.h"
+
+namespace gert {
+ExecutorLease::ExecutorLease(ExecutorLease &&other) noexcept
+    : pool_(other.pool_), index_(other.index_), executor_(other.executor_), stream_(other.stream_) {
+  other.pool_ = nullptr;
+  other.executor_ = nullptr;
+  other.stream_ = nullptr;
+}
+
+ExecutorLease &ExecutorLease::operator=(ExecutorLease &&other) noexcept {
+  if (this != &other) {
+    Release();
+    pool_ = other.pool_;
+    index_ = other.index_;
+    executor_ = other.executor_;
+    stream_ = other.stream_;
+    other.pool_ = nullptr;
+    other.executor_ = nullptr;
+    other.stream_ = nullptr;
+  }
+  return *this;
+}
+
+ExecutorLease::~ExecutorLease() {
+  Release();
+}
+
+void ExecutorLease::Release() {
+  if (pool_ != nullptr) {
+    pool_->Release(index_);
+  }
+  pool_ = nullptr;
+  executor_ = nullptr;
+  stream_ = nullptr;
+}
+
+ExecutorPool::~ExecutorPool() {
+  (void)Finalize();
+}
+
+ge::graphStatus ExecutorPool::Init(const ge::ModelData &model_data, const ExecutorPoolOption &option) {
+  const ExecutorLoader loader = [&model_data](ge::graphStatus &error_code) {
+    return LoadExecutorFromModelData(model_data, error_code);
+  };
+  return Init(loader, option);
+}
+
+ge::graphStatus ExecutorPool::Init(const ExecutorLoader &loader, const ExecutorPoolOption &option) {
+  GE_ASSERT_TRUE(!running_ && instances_.empty(), "Executor pool is already initialized");
+  GE_ASSERT_TRUE(option.instance_num > 0U, "Instance num of executor pool must be positive");
+  weight_ptr_ = option.weight_ptr;
+  weight_size_ = option.weight_size;
+  if ((weight_ptr_ == nullptr) && (weight_size_ > 0U)) {
+    GE_ASSERT_RT_OK(rtMalloc(&owned_weight_, weight_size_, RT_MEMORY_HBM, GE_MODULE_NAME_U16),
+                    "Malloc shared weight memory of size %zu failed", weight_size_);
+    weight_ptr_ = owned_weight_;
+  }
+  if (weight_ptr_ == nullptr) {
+    GELOGW("[Init][ExecutorPool] No shared weight memory, every one of the %zu instances loads its own weights.",
+           option.instance_num);
+  }
+
+  // instances are loaded one by one, the shared weights are written by the loads and read only afterwards
+  instances_.resize(option.instance_num);
+  for (size_t i = 0U; i < instances_.size(); ++i) {
+    const ge::graphStatus ret = LoadInstance(loader, option, instances_[i]);
+    if (ret != ge::GRAPH_SUCCESS) {
+      GELOGE(ret, "[Load][Instance] Load instance %zu of executor pool failed.", i);
+      DestroyInstances();
+      return ret;
+    }
+  }
+  const std::lock_guard<std::mutex> lock(mutex_);
+  idle_.clear();
+  for (size_t i = instances_.size(); i > 0U; --i) {
+    idle_.emplace_back(i - 1U);
+  }
+  running_ = true;
+  GELOGI("Executor pool initialized, instance num %zu, shared weight size %zu.", instances_.size(), weight_size_);
+  return ge::GRAPH_SUCCESS;
+}
+
+ge::graphStatus ExecutorPool::LoadInstance(const ExecutorLoader &loader, const ExecutorPoolOption &option,
+                                           Instance &instance) {
+  GE_ASSERT_RT_OK(rtStreamCreate(&instance.stream, option.stream_priority));
+  ge::graphStatus error_code = ge::GRAPH_SUCCESS;
+  instance.executor = loader(error_code);
+  GE_ASSERT_TRUE((error_code == ge::GRAPH_SUCCESS) && (instance.executor != nullptr),
+                 "Create executor failed, error code %u", error_code);
+  const ModelLoadArg load_arg(option.rt_session, {weight_ptr_, weight_size_});
+  GE_ASSERT_GRAPH_SUCCESS(instance.executor->Load(ModelExecuteArg(instance.stream), load_arg));
+  return ge::GRAPH_SUCCESS;
+}
+
+ge::graphStatus ExecutorPool::Execute(Tensor **inputs, const size_t input_num, Tensor **outputs,
+                                      const size_t output_num) {
+  for (size_t i = 0U; i < output_num; ++i) {
+    GE_ASSERT_TRUE((outputs[i] != nullptr) && (outputs[i]->GetAddr() != nullptr),
+                   "Output %zu has no memory, use Acquire to read outputs allocated by the executor", i);
+  }
+  ExecutorLease lease = Acquire();
+  GE_ASSERT_TRUE(lease.IsValid(), "Executor pool is not running");
+  GE_ASSERT_GRAPH_SUCCESS(lease.GetExecutor()->Execute(ModelExecuteArg(lease.GetStream()), inputs, input_num,
+                                                       outputs, output_num));
+  GE_ASSERT_RT_OK(rtStreamSynchronize(lease.GetStream()));
+  return ge::GRAPH_SUCCESS;
+}
+
+ExecutorLease ExecutorPool::Acquire() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_cond_.wait(lock, [this]() { return (!running_) || (!idle_.empty()); });
+  return PopIdle();
+}
+
+ExecutorLease ExecutorPool::TryAcquire() {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return PopIdle();
+}
+
+ExecutorLease ExecutorPool::PopIdle() {
+  if ((!running_) || idle_.empty()) {
+    return ExecutorLease();
+  }
+  const size_t index = idle_.back();
+  idle_.pop_back();
+  return ExecutorLease(this, index, instances_[index].executor.get(), instances_[index].stream);
+}
+
+void ExecutorPool::Release(const size_t index) {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    idle_.emplace_back(index);
+  }
+  // Finalize waits for all instances as well
+  idle_cond_.notify_all();
+}
+
+size_t ExecutorPool::GetIdleNum() const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return idle_.size();
+}
+
+ge::graphStatus ExecutorPool::Finalize() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!running_) {
+      return ge::GRAPH_SUCCESS;
+    }
+    running_ = false;
+    idle_cond_.notify_all();
+    idle_cond_.wait(lock, [this]() { return idle_.size() == instances_.size(); });
+  }
+  DestroyInstances();
+  return ge::GRAPH_SUCCESS;
+}
+
+void ExecutorPool::DestroyInstances() {
+  for (auto &instance : instances_) {
+    if (instance.executor != nullptr) {
+      if (instance.executor->UnLoad() != ge::GRAPH_SUCCESS) {
+        GELOGW("[Unload][Instance] Unload executor of executor pool failed.");
+      }
+      instance.executor.reset();
+    }
+    if (instance.stream != nullptr) {
+      (void)rtStreamDestroy(instance.stream);
+      instance.stream = nullptr;
+    }
+  }
+  instances_.clear();
+  idle_.clear();
+  if (owned_weight_ != nullptr) {
+    (void)rtFree(owned_weight_);
+    owned_weight_ = nullptr;
+  }
+  weight_ptr_ = nullptr;
+  weight_size_ = 0U;
+}
+}  // namespace gert
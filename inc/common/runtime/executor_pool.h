@@ -0,0 +1,148 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AIR_CXX_COMMON_RUNTIME_EXECUTOR_POOL_H_
+#define AIR_CXX_COMMON_RUNTIME_EXECUTOR_POOL_H_
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "framework/runtime/model_v2_executor.h"
+
+namespace gert {
+struct ExecutorPoolOption {
+  size_t instance_num = 1U;
+  /**
+   * 所有实例共享的权重内存，为空且weight_size不为0时由池申请weight_size大小的device内存，
+   * 两者都为空时各实例自行申请权重（不共享）
+   */
+  const void *weight_ptr = nullptr;
+  size_t weight_size = 0U;
+  RtSession *rt_session = nullptr;
+  int32_t stream_priority = 0;
+};
+
+class ExecutorPool;
+/**
+ * 独占一个实例直到析构，期间可以在stream上多次Execute并读取实例内部申请的输出内存
+ */
+class ExecutorLease {
+ public:
+  ExecutorLease() = default;
+  ExecutorLease(ExecutorLease &&other) noexcept;
+  ExecutorLease &operator=(ExecutorLease &&other) noexcept;
+  ExecutorLease(const ExecutorLease &) = delete;
+  ExecutorLease &operator=(const ExecutorLease &) = delete;
+  ~ExecutorLease();
+
+  bool IsValid() const {
+    return executor_ != nullptr;
+  }
+  ModelV2Executor *GetExecutor() const {
+    return executor_;
+  }
+  rtStream_t GetStream() const {
+    return stream_;
+  }
+  void Release();
+
+ private:
+  friend class ExecutorPool;
+  ExecutorLease(ExecutorPool *const pool, const size_t index, ModelV2Executor *const executor,
+                const rtStream_t stream)
+      : pool_(pool), index_(index), executor_(executor), stream_(stream) {}
+  ExecutorPool *pool_ = nullptr;
+  size_t index_ = 0U;
+  ModelV2Executor *executor_ = nullptr;
+  rtStream_t stream_ = nullptr;
+};
+
+/**
+ * 同一模型的多实例执行器池，用于ModelV2Executor::Execute不支持并发调用时的N路并发推理
+ * 模型的各实例通过ModelLoadArg::outer_weight_mem共享同一份只读权重，每个实例拥有独立的stream和
+ * 默认allocator（即独立的feature map内存）；请求被分发给空闲实例，没有空闲实例时等待
+ */
+class ExecutorPool {
+ public:
+  using ExecutorLoader = std::function<std::unique_ptr<ModelV2Executor>(ge::graphStatus &error_code)>;
+
+  ExecutorPool() = default;
+  ExecutorPool(const ExecutorPool &) = delete;
+  ExecutorPool &operator=(const ExecutorPool &) = delete;
+  ~ExecutorPool();
+
+  /**
+   * 用LoadExecutorFromModelData创建各实例，model_data在Init返回后即可释放
+   */
+  ge::graphStatus Init(const ge::ModelData &model_data, const ExecutorPoolOption &option);
+  /**
+   * loader每次调用返回一个未Load的执行器，所有实例在Init中串行Load到各自的stream上
+   */
+  ge::graphStatus Init(const ExecutorLoader &loader, const ExecutorPoolOption &option);
+
+  /**
+   * 等待一个空闲实例并同步执行，outputs需要由调用者申请内存：实例内部申请的输出内存会被分发到该实例的下一个请求复用，
+   * 需要使用实例内部输出内存时请用Acquire
+   */
+  ge::graphStatus Execute(Tensor **inputs, const size_t input_num, Tensor **outputs, const size_t output_num);
+
+  /**
+   * 等待并独占一个空闲实例，池已Finalize时返回无效的lease
+   */
+  ExecutorLease Acquire();
+  /**
+   * 不等待，没有空闲实例时返回无效的lease
+   */
+  ExecutorLease TryAcquire();
+
+  /**
+   * 等待所有lease归还后卸载所有实例
+   */
+  ge::graphStatus Finalize();
+
+  size_t GetInstanceNum() const {
+    return instances_.size();
+  }
+  size_t GetIdleNum() const;
+  const void *GetWeightPtr() const {
+    return weight_ptr_;
+  }
+
+ private:
+  friend class ExecutorLease;
+  struct Instance {
+    std::unique_ptr<ModelV2Executor> executor;
+    rtStream_t stream = nullptr;
+  };
+  ge::graphStatus LoadInstance(const ExecutorLoader &loader, const ExecutorPoolOption &option, Instance &instance);
+  ExecutorLease PopIdle();
+  void Release(const size_t index);
+  void DestroyInstances();
+
+  mutable std::mutex mutex_;
+  std::condition_variable idle_cond_;
+  std::vector<Instance> instances_;
+  std::vector<size_t> idle_;  // 栈，最近归还的实例优先，其cache和内存池更热
+  bool running_ = false;
+  const void *weight_ptr_ = nullptr;
+  size_t weight_size_ = 0U;
+  void *owned_weight_ = nullptr;
+};
+}  // namespace gert
+#endif  // AIR_CXX_COMMON_RUNTIME_EXECUTOR_POOL_H_
@@ -0,0 +1,146 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/runtime/sampled_memory_tracer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <new>
+
+#include "framework/common/debug/ge_log.h"
+#include "mmpa/mmpa_api.h"
+
+namespace gert {
+namespace {
+constexpr size_t kMinRingCapacity = 16U;
+
+// rings of all threads, a ring stays here after its thread exits until it is drained
+struct RingRegistry {
+  std::mutex mutex;
+  std::vector<std::shared_ptr<void>> owners;
+};
+
+RingRegistry &GetRegistry() {
+  static RingRegistry registry;
+  return registry;
+}
+
+size_t SizeBucket(const int64_t size) {
+  size_t bucket = 0U;
+  for (uint64_t value = static_cast<uint64_t>(size) >> 1U; value != 0U; value >>= 1U) {
+    ++bucket;
+  }
+  return std::min(bucket, kMemoryTraceSizeBucketNum - 1U);
+}
+}  // namespace
+
+std::atomic<uint32_t> SampledMemoryTracer::sample_interval_{0U};
+std::atomic<size_t> SampledMemoryTracer::ring_capacity_{SampledMemoryTracer::kDefaultRingCapacity};
+
+SampledMemoryTracer::ThreadRing::ThreadRing(const size_t cap)
+    : capacity(cap), events(new (std::nothrow) MemoryTraceEvent[cap]) {}
+
+void SampledMemoryTracer::Enable(const uint32_t sample_interval, const size_t ring_capacity) {
+  size_t capacity = kMinRingCapacity;
+  while (capacity < ring_capacity) {
+    capacity <<= 1U;
+  }
+  ring_capacity_.store(capacity, std::memory_order_relaxed);
+  sample_interval_.store(sample_interval, std::memory_order_relaxed);
+  GELOGI("Sampled memory tracer enabled, sample interval %u, ring capacity %zu.", sample_interval, capacity);
+}
+
+uint64_t SampledMemoryTracer::Now() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+SampledMemoryTracer::ThreadRing *SampledMemoryTracer::GetThreadRing() {
+  // created on the first sampled event of the thread, the only time the registry lock is taken on this path
+  struct RingHolder {
+    RingHolder() {
+      void *const memory = mmAlignMalloc(static_cast<mmSize>(sizeof(ThreadRing)),
+                                         static_cast<mmSize>(alignof(ThreadRing)));
+      if (memory == nullptr) {
+        return;
+      }
+      std::shared_ptr<ThreadRing> new_ring(new (memory) ThreadRing(ring_capacity_.load()),
+                                           [](ThreadRing *const thread_ring) {
+                                             thread_ring->~ThreadRing();
+                                             mmAlignFree(thread_ring);
+                                           });
+      if (new_ring->events == nullptr) {
+        return;
+      }
+      RingRegistry &registry = GetRegistry();
+      const std::lock_guard<std::mutex> lock(registry.mutex);
+      registry.owners.emplace_back(new_ring);
+      ring = std::move(new_ring);
+    }
+    ~RingHolder() {
+      if (ring != nullptr) {
+        ring->thread_exited.store(true, std::memory_order_release);
+      }
+    }
+    std::shared_ptr<ThreadRing> ring;
+  };
+  thread_local RingHolder holder;
+  return holder.ring.get();
+}
+
+size_t SampledMemoryTracer::Collect(MemoryTraceReport &report) {
+  RingRegistry &registry = GetRegistry();
+  const std::lock_guard<std::mutex> lock(registry.mutex);
+  report.sample_interval = sample_interval_.load(std::memory_order_relaxed);
+  const size_t timeline_begin = report.timeline.size();
+  size_t collected = 0U;
+  auto iter = registry.owners.begin();
+  while (iter != registry.owners.end()) {
+    ThreadRing &ring = *static_cast<ThreadRing *>(iter->get());
+    const bool exited = ring.thread_exited.load(std::memory_order_acquire);
+    const uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    const uint64_t head = ring.head.load(std::memory_order_acquire);
+    for (uint64_t pos = tail; pos < head; ++pos) {
+      const MemoryTraceEvent &event = ring.events[pos & (ring.capacity - 1U)];
+      AllocationSiteStat &stat = report.sites[event.site];
+      if (event.size >= 0) {
+        ++stat.alloc_count;
+        stat.alloc_bytes += static_cast<uint64_t>(event.size);
+        if (event.size > 0) {
+          ++stat.size_buckets[SizeBucket(event.size)];
+        }
+      } else {
+        ++stat.free_count;
+        stat.free_bytes += static_cast<uint64_t>(-event.size);
+      }
+      report.timeline.push_back({event.time_stamp, event.total_allocate_memory, event.total_reserve_memory});
+    }
+    ring.tail.store(head, std::memory_order_release);
+    collected += static_cast<size_t>(head - tail);
+    report.dropped_count += ring.dropped.exchange(0U, std::memory_order_relaxed);
+    // the thread is gone and everything it pushed has been read
+    iter = exited ? registry.owners.erase(iter) : (iter + 1);
+  }
+  // the rings are merged one after another, the timeline is ordered by time again
+  std::sort(report.timeline.begin() + static_cast<std::ptrdiff_t>(timeline_begin), report.timeline.end(),
+            [](const MemoryTimelinePoint &lhs, const MemoryTimelinePoint &rhs) {
+              return lhs.time_stamp < rhs.time_stamp;
+            });
+  return collected;
+}
+}  // namespace gert
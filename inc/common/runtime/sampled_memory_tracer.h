@@ -0,0 +1,159 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AIR_CXX_COMMON_RUNTIME_SAMPLED_MEMORY_TRACER_H_
+#define AIR_CXX_COMMON_RUNTIME_SAMPLED_MEMORY_TRACER_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ * 强制内联与调用点地址：在强制内联的函数中取得的是其调用者的返回地址，即申请内存的调用点；不支持的编译器上调用点为0
+ */
+#if defined(__GNUC__)
+#define GERT_TRACE_ALWAYS_INLINE __attribute__((always_inline)) inline
+#define GERT_TRACE_RETURN_ADDRESS() __builtin_return_address(0)
+#elif defined(_MSC_VER)
+#define GERT_TRACE_ALWAYS_INLINE __forceinline
+#define GERT_TRACE_RETURN_ADDRESS() _ReturnAddress()
+#else
+#define GERT_TRACE_ALWAYS_INLINE inline
+#define GERT_TRACE_RETURN_ADDRESS() nullptr
+#endif
+
+namespace gert {
+/**
+ * 一次被采样的申请（size > 0）或释放（size < 0）
+ */
+struct MemoryTraceEvent {
+  uint64_t addr;
+  int64_t size;
+  uint64_t site;  // 调用点地址
+  uint64_t total_allocate_memory;
+  uint64_t total_reserve_memory;
+  uint64_t time_stamp;  // steady clock, ns
+};
+
+constexpr size_t kMemoryTraceSizeBucketNum = 48U;  // 按size的log2分桶
+
+struct AllocationSiteStat {
+  uint64_t alloc_count = 0U;
+  uint64_t free_count = 0U;
+  uint64_t alloc_bytes = 0U;
+  uint64_t free_bytes = 0U;
+  std::array<uint64_t, kMemoryTraceSizeBucketNum> size_buckets{};  // 第i个桶为[2^i, 2^(i+1))
+};
+
+struct MemoryTimelinePoint {
+  uint64_t time_stamp;
+  uint64_t total_allocate_memory;
+  uint64_t total_reserve_memory;
+};
+
+/**
+ * 汇总结果，计数都是采样后的值，乘以sample_interval为全量的估计值
+ */
+struct MemoryTraceReport {
+  uint32_t sample_interval = 0U;
+  std::map<uint64_t, AllocationSiteStat> sites;
+  std::vector<MemoryTimelinePoint> timeline;
+  uint64_t dropped_count = 0U;
+};
+
+/**
+ * 低开销的device内存申请跟踪，替代DeviceMemoryRecorder::SetRecorder的全局锁队列：
+ * 每个线程一个单生产者单消费者的无锁环形缓冲，每个线程每sample_interval次事件记录一次，缓冲满时丢弃并计数，不阻塞申请；
+ * Collect由汇总线程调用，取出所有线程的事件并合并为按调用点的size直方图与已申请/已预留内存的时间线
+ * 事件来自DeviceMemoryRecorder::TraceRecorder与sim runtime的rtMalloc/rtFree；闭源runtime库中的allocator目前仍调用
+ * SetRecorder，接入TraceRecorder前其申请不会产生事件
+ */
+class SampledMemoryTracer {
+ public:
+  static constexpr size_t kDefaultRingCapacity = 4096U;
+  static constexpr size_t kCacheLineSize = 64U;
+
+  /**
+   * @param sample_interval 每个线程每sample_interval次事件采样一次，0为关闭
+   * @param ring_capacity 每个线程的缓冲容量，向上取2的幂，对之后新建的缓冲生效
+   */
+  static void Enable(const uint32_t sample_interval, const size_t ring_capacity = kDefaultRingCapacity);
+  static void Disable() {
+    sample_interval_.store(0U, std::memory_order_relaxed);
+  }
+  static bool IsEnabled() {
+    return sample_interval_.load(std::memory_order_relaxed) != 0U;
+  }
+
+  static void Record(const void *const addr, const int64_t size, const uint64_t total_allocate_memory,
+                     const uint64_t total_reserve_memory, const void *const site) {
+    const uint32_t sample_interval = sample_interval_.load(std::memory_order_relaxed);
+    if (sample_interval == 0U) {
+      return;
+    }
+    ThreadRing *const ring = GetThreadRing();
+    if ((ring == nullptr) || (++ring->countdown < sample_interval)) {
+      return;
+    }
+    ring->countdown = 0U;
+    ring->Push({reinterpret_cast<uintptr_t>(addr), size, reinterpret_cast<uintptr_t>(site), total_allocate_memory,
+                total_reserve_memory, Now()});
+  }
+
+  /**
+   * 取出所有线程缓冲中的事件并合并到report中，可以周期性调用以累积，每次追加的timeline按时间排序
+   * @return 本次取出的事件数
+   */
+  static size_t Collect(MemoryTraceReport &report);
+
+ private:
+  // 按kCacheLineSize对齐申请（见GetThreadRing），C++17之前的new不保证alignas
+  struct ThreadRing {
+    explicit ThreadRing(const size_t cap);
+    void Push(const MemoryTraceEvent &event) {
+      const uint64_t pos = head.load(std::memory_order_relaxed);
+      if ((pos - tail.load(std::memory_order_acquire)) >= capacity) {
+        dropped.fetch_add(1U, std::memory_order_relaxed);
+        return;
+      }
+      events[pos & (capacity - 1U)] = event;
+      head.store(pos + 1U, std::memory_order_release);
+    }
+    const size_t capacity;
+    std::unique_ptr<MemoryTraceEvent[]> events;
+    // 生产者的cache line：所属线程每次事件都会写
+    alignas(kCacheLineSize) std::atomic<uint64_t> head{0U};
+    std::atomic<uint64_t> dropped{0U};
+    uint32_t countdown = 0U;  // 只由所属线程访问
+    // 消费者的cache line
+    alignas(kCacheLineSize) std::atomic<uint64_t> tail{0U};
+    std::atomic<bool> thread_exited{false};
+  };
+
+  static ThreadRing *GetThreadRing();
+  static uint64_t Now();
+
+  static std::atomic<uint32_t> sample_interval_;
+  static std::atomic<size_t> ring_capacity_;
+};
+}  // namespace gert
+#endif  // AIR_CXX_COMMON_RUNTIME_SAMPLED_MEMORY_TRACER_H_
@@ -0,0 +1,345 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/runtime/work_stealing_scheduler.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "common/checker.h"
+#include "framework/common/debug/ge_log.h"
+
+namespace gert {
+namespace {
+constexpr uint64_t kSeedMultiplier = 0x9E3779B97F4A7C15UL;
+constexpr int32_t kDecimalBase = 10;
+
+uint64_t NextRandom(uint64_t &seed) {
+  // xorshift64
+  seed ^= seed << 13U;
+  seed ^= seed >> 7U;
+  seed ^= seed << 17U;
+  return seed;
+}
+
+// Kahn topological order, fails when the graph has a cycle or a successor out of range
+ge::graphStatus SortTasks(const ScheduleTaskGraph &graph, std::vector<uint32_t> &order) {
+  const size_t task_num = graph.successors.size();
+  std::vector<uint32_t> in_degrees(task_num, 0U);
+  for (const auto &successors : graph.successors) {
+    for (const uint32_t successor : successors) {
+      GE_ASSERT_TRUE(successor < task_num, "Successor %u exceeds task num %zu", successor, task_num);
+      ++in_degrees[successor];
+    }
+  }
+  order.clear();
+  order.reserve(task_num);
+  for (uint32_t i = 0U; i < static_cast<uint32_t>(task_num); ++i) {
+    if (in_degrees[i] == 0U) {
+      order.emplace_back(i);
+    }
+  }
+  for (size_t i = 0U; i < order.size(); ++i) {
+    for (const uint32_t successor : graph.successors[order[i]]) {
+      if (--in_degrees[successor] == 0U) {
+        order.emplace_back(successor);
+      }
+    }
+  }
+  GE_ASSERT_TRUE(order.size() == task_num, "Task graph has a cycle, only %zu of %zu tasks are sorted",
+                 order.size(), task_num);
+  return ge::GRAPH_SUCCESS;
+}
+}  // namespace
+
+WorkStealingScheduler::WorkStealingScheduler(const WorkStealingScheduleOption &option) : option_(option) {}
+
+WorkStealingScheduler::~WorkStealingScheduler() {
+  Stop();
+}
+
+ge::graphStatus WorkStealingScheduler::Start(const size_t worker_num) {
+  GE_ASSERT_TRUE(worker_num > 0U, "Worker num of work stealing scheduler must be positive");
+  GE_ASSERT_TRUE(workers_.empty(), "Work stealing scheduler is already started");
+  for (const int32_t cpu : option_.cpu_ids) {
+    GE_ASSERT_TRUE((cpu >= 0) && (cpu < CPU_SETSIZE), "Cpu id %d is out of range [0, %d)", cpu, CPU_SETSIZE);
+  }
+  if (option_.cpu_ids.empty() && (option_.numa_node >= 0) &&
+      (GetNumaNodeCpus(option_.numa_node, numa_cpus_) != ge::GRAPH_SUCCESS)) {
+    GELOGW("[Start][Scheduler] Get cpus of numa node %d failed, workers are not bound.", option_.numa_node);
+    numa_cpus_.clear();
+  }
+  stop_ = false;
+  queues_.clear();
+  for (size_t i = 0U; i < worker_num; ++i) {
+    queues_.emplace_back(new (std::nothrow) WorkerQueue());
+    GE_ASSERT_NOTNULL(queues_.back());
+  }
+  for (size_t i = 0U; i < worker_num; ++i) {
+    workers_.emplace_back(&WorkStealingScheduler::WorkerLoop, this, i);
+  }
+  GELOGI("Work stealing scheduler started, worker num %zu, bound cpu num %zu, critical path first %d.", worker_num,
+         option_.cpu_ids.empty() ? numa_cpus_.size() : option_.cpu_ids.size(),
+         static_cast<int32_t>(option_.critical_path_first));
+  return ge::GRAPH_SUCCESS;
+}
+
+void WorkStealingScheduler::Stop() {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_cond_.notify_all();
+  for (auto &worker : workers_) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+  workers_.clear();
+}
+
+void WorkStealingScheduler::BindCpu(const size_t worker_id) const {
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  if (!option_.cpu_ids.empty()) {
+    CPU_SET(option_.cpu_ids[worker_id % option_.cpu_ids.size()], &cpu_set);
+  } else if (!numa_cpus_.empty()) {
+    for (const int32_t cpu : numa_cpus_) {
+      CPU_SET(cpu, &cpu_set);
+    }
+  } else {
+    return;
+  }
+  if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0) {
+    GELOGW("[Bind][Cpu] Bind worker %zu of work stealing scheduler failed.", worker_id);
+  }
+}
+
+void WorkStealingScheduler::WorkerLoop(const size_t worker_id) {
+  BindCpu(worker_id);
+  uint64_t seed = (static_cast<uint64_t>(worker_id) + 1U) * kSeedMultiplier;
+  std::vector<uint32_t> ready;
+  while (true) {
+    uint32_t task = kInvalidTask;
+    if (PopLocal(worker_id, task) || Steal(worker_id, task, seed)) {
+      Execute(worker_id, task, ready);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    // sleeping_num_ is raised before ready_num_ is checked, Push either sees the sleeper or the sleeper sees the task
+    ++sleeping_num_;
+    work_cond_.wait(lock, [this]() { return stop_ || (ready_num_.load() > 0U); });
+    --sleeping_num_;
+    if (stop_) {
+      return;
+    }
+  }
+}
+
+void WorkStealingScheduler::Push(const size_t worker_id, const uint32_t task) {
+  {
+    WorkerQueue &queue = *queues_[worker_id];
+    const std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back(task);
+  }
+  ++ready_num_;
+  if (sleeping_num_.load() > 0U) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    work_cond_.notify_one();
+  }
+}
+
+bool WorkStealingScheduler::PopLocal(const size_t worker_id, uint32_t &task) {
+  WorkerQueue &queue = *queues_[worker_id];
+  const std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.tasks.empty()) {
+    return false;
+  }
+  task = queue.tasks.back();
+  queue.tasks.pop_back();
+  --ready_num_;
+  return true;
+}
+
+bool WorkStealingScheduler::Steal(const size_t worker_id, uint32_t &task, uint64_t &seed) {
+  const size_t queue_num = queues_.size();
+  if ((queue_num <= 1U) || (ready_num_.load() == 0U)) {
+    return false;
+  }
+  const size_t start = static_cast<size_t>(NextRandom(seed) % queue_num);
+  for (size_t i = 0U; i < queue_num; ++i) {
+    const size_t victim = (start + i) % queue_num;
+    if (victim == worker_id) {
+      continue;
+    }
+    WorkerQueue &queue = *queues_[victim];
+    const std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tasks.empty()) {
+      task = queue.tasks.front();
+      queue.tasks.pop_front();
+      --ready_num_;
+      steal_count_.fetch_add(1U, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingScheduler::Execute(const size_t worker_id, uint32_t task, std::vector<uint32_t> &ready) {
+  while (task != kInvalidTask) {
+    if (!failed_.load(std::memory_order_acquire)) {
+      const ge::graphStatus ret = (*task_func_)(task, worker_id);
+      if ((ret != ge::GRAPH_SUCCESS) && (!failed_.exchange(true))) {
+        first_error_ = ret;
+      }
+    }
+    // after a failure the remaining tasks are only drained, so Run still sees every task done
+    ready.clear();
+    for (const uint32_t successor : graph_->successors[task]) {
+      if (pending_inputs_[successor].fetch_sub(1U, std::memory_order_acq_rel) == 1U) {
+        ready.emplace_back(successor);
+      }
+    }
+    uint32_t next = kInvalidTask;
+    if (!ready.empty()) {
+      std::sort(ready.begin(), ready.end(),
+                [this](const uint32_t lhs, const uint32_t rhs) { return GetPriority(lhs) < GetPriority(rhs); });
+      next = ready.back();
+      ready.pop_back();
+      for (const uint32_t ready_task : ready) {
+        Push(worker_id, ready_task);
+      }
+    }
+    if (remaining_.fetch_sub(1U, std::memory_order_acq_rel) == 1U) {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      done_cond_.notify_all();
+    }
+    task = next;
+  }
+}
+
+ge::graphStatus WorkStealingScheduler::Run(const ScheduleTaskGraph &graph, const std::vector<uint64_t> &priorities,
+                                           const TaskFunc &task_func) {
+  const std::lock_guard<std::mutex> run_lock(run_mutex_);
+  GE_ASSERT_TRUE(!workers_.empty(), "Work stealing scheduler is not started");
+  const size_t task_num = graph.successors.size();
+  if (task_num == 0U) {
+    return ge::GRAPH_SUCCESS;
+  }
+  GE_ASSERT_TRUE(task_num < kInvalidTask, "Task num %zu is too large", task_num);
+  GE_ASSERT_TRUE(priorities.empty() || (priorities.size() == task_num), "Priority num %zu mismatch task num %zu",
+                 priorities.size(), task_num);
+  // tasks on a cycle never become ready, Run would wait forever
+  GE_ASSERT_GRAPH_SUCCESS(SortTasks(graph, sorted_tasks_));
+  if (pending_capacity_ < task_num) {
+    pending_inputs_.reset(new (std::nothrow) std::atomic<uint32_t>[task_num]);
+    GE_ASSERT_NOTNULL(pending_inputs_);
+    pending_capacity_ = task_num;
+  }
+  for (size_t i = 0U; i < task_num; ++i) {
+    pending_inputs_[i].store(0U, std::memory_order_relaxed);
+  }
+  for (const auto &successors : graph.successors) {
+    for (const uint32_t successor : successors) {
+      pending_inputs_[successor].fetch_add(1U, std::memory_order_relaxed);
+    }
+  }
+
+  graph_ = &graph;
+  priorities_ = (option_.critical_path_first && (!priorities.empty())) ? &priorities : nullptr;
+  task_func_ = &task_func;
+  failed_.store(false);
+  first_error_ = ge::GRAPH_SUCCESS;
+  remaining_.store(task_num);
+
+  std::vector<uint32_t> sources;
+  for (uint32_t i = 0U; i < static_cast<uint32_t>(task_num); ++i) {
+    if (pending_inputs_[i].load(std::memory_order_relaxed) == 0U) {
+      sources.emplace_back(i);
+    }
+  }
+  GE_ASSERT_TRUE(!sources.empty(), "Task graph has no source task");
+  std::sort(sources.begin(), sources.end(),
+            [this](const uint32_t lhs, const uint32_t rhs) { return GetPriority(lhs) < GetPriority(rhs); });
+  // the highest priorities land on different workers, every queue is filled in ascending order
+  for (size_t i = 0U; i < sources.size(); ++i) {
+    Push((sources.size() - 1U - i) % queues_.size(), sources[i]);
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cond_.wait(lock, [this]() { return remaining_.load() == 0U; });
+  graph_ = nullptr;
+  priorities_ = nullptr;
+  task_func_ = nullptr;
+  return first_error_;
+}
+
+ge::graphStatus WorkStealingScheduler::CalcCriticalPathPriorities(const ScheduleTaskGraph &graph,
+                                                                  std::vector<uint64_t> &priorities) {
+  const size_t task_num = graph.successors.size();
+  GE_ASSERT_TRUE(graph.costs.empty() || (graph.costs.size() == task_num), "Cost num %zu mismatch task num %zu",
+                 graph.costs.size(), task_num);
+  std::vector<uint32_t> order;
+  GE_ASSERT_GRAPH_SUCCESS(SortTasks(graph, order));
+
+  priorities.assign(task_num, 0U);
+  for (auto iter = order.rbegin(); iter != order.rend(); ++iter) {
+    uint64_t longest_successor = 0U;
+    for (const uint32_t successor : graph.successors[*iter]) {
+      longest_successor = std::max(longest_successor, priorities[successor]);
+    }
+    priorities[*iter] = longest_successor + (graph.costs.empty() ? 1U : graph.costs[*iter]);
+  }
+  return ge::GRAPH_SUCCESS;
+}
+
+ge::graphStatus WorkStealingScheduler::GetNumaNodeCpus(const int32_t numa_node, std::vector<int32_t> &cpus) {
+  const std::string path = "/sys/devices/system/node/node" + std::to_string(numa_node) + "/cpulist";
+  std::ifstream ifs(path);
+  GE_ASSERT_TRUE(ifs.is_open(), "Open %s failed", path.c_str());
+  std::string cpu_list;
+  std::getline(ifs, cpu_list);
+  // format like "0-3,8-11"
+  cpus.clear();
+  std::stringstream ss(cpu_list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    if (range.empty()) {
+      continue;
+    }
+    char *end = nullptr;
+    const int64_t first = std::strtol(range.c_str(), &end, kDecimalBase);
+    int64_t last = first;
+    if ((end != nullptr) && (*end == '-')) {
+      last = std::strtol(end + 1, &end, kDecimalBase);
+    }
+    if ((end == nullptr) || ((*end != '\0') && (*end != '\n')) || (first < 0) || (last < first)) {
+      GELOGE(ge::GRAPH_FAILED, "[Parse][CpuList] Invalid cpu range %s in %s.", range.c_str(), path.c_str());
+      return ge::GRAPH_FAILED;
+    }
+    for (int64_t cpu = first; (cpu <= last) && (cpu < CPU_SETSIZE); ++cpu) {
+      cpus.emplace_back(static_cast<int32_t>(cpu));
+    }
+  }
+  GE_ASSERT_TRUE(!cpus.empty(), "No cpu in %s", path.c_str());
+  return ge::GRAPH_SUCCESS;
+}
+}  // namespace gert
@@ -0,0 +1,139 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AIR_CXX_COMMON_RUNTIME_WORK_STEALING_SCHEDULER_H_
+#define AIR_CXX_COMMON_RUNTIME_WORK_STEALING_SCHEDULER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "graph/ge_error_codes.h"
+
+namespace gert {
+struct WorkStealingScheduleOption {
+  /**
+   * worker绑定的CPU，第i个worker绑定cpu_ids[i % size]，为空时不绑核，取值范围：0 <= cpu_id < CPU_SETSIZE
+   */
+  std::vector<int32_t> cpu_ids;
+  /**
+   * cpu_ids为空且numa_node >= 0时，所有worker绑定到该NUMA节点的CPU集合
+   */
+  int32_t numa_node = -1;
+  /**
+   * ready节点按exe graph上到出口的关键路径长度排序，关键路径上的节点优先在本worker上执行
+   */
+  bool critical_path_first = true;
+};
+
+/**
+ * 调度用的任务图，节点id为下标，由exe graph的执行节点拓扑生成
+ */
+struct ScheduleTaskGraph {
+  std::vector<std::vector<uint32_t>> successors;
+  std::vector<uint64_t> costs;  // 节点的估计耗时，为空时每个节点按1计算
+};
+
+/**
+ * kTopologicalMultiThread执行器的work stealing调度器，没有中心调度线程：
+ * 每个worker有一个本地双端队列，节点完成后ready的后继中优先级最高的在本worker上直接继续执行，
+ * 其余按优先级压入本地队列尾部，本worker从尾部取（LIFO，数据更热），空闲worker从其他worker的队列头部窃取
+ * 闭源的kTopologicalMultiThread执行器尚未接入本调度器，MultiThreadExecutorOption也没有对应的调度策略，
+ * 目前只能由调用方直接使用
+ */
+class WorkStealingScheduler {
+ public:
+  using TaskFunc = std::function<ge::graphStatus(const uint32_t task_id, const size_t worker_id)>;
+
+  explicit WorkStealingScheduler(const WorkStealingScheduleOption &option = WorkStealingScheduleOption());
+  WorkStealingScheduler(const WorkStealingScheduler &) = delete;
+  WorkStealingScheduler &operator=(const WorkStealingScheduler &) = delete;
+  ~WorkStealingScheduler();
+
+  ge::graphStatus Start(const size_t worker_num);
+  void Stop();
+
+  /**
+   * 执行graph中的所有节点，graph有环时返回失败，同一时刻只能有一个Run；某个节点失败后不再执行新的节点，返回第一个失败的错误码
+   * @param priorities 节点优先级，值越大越先执行，为空时按节点id
+   */
+  ge::graphStatus Run(const ScheduleTaskGraph &graph, const std::vector<uint64_t> &priorities,
+                      const TaskFunc &task_func);
+
+  /**
+   * 关键路径优先级：节点到任一出口节点路径上cost之和的最大值（包括节点自身）
+   */
+  static ge::graphStatus CalcCriticalPathPriorities(const ScheduleTaskGraph &graph, std::vector<uint64_t> &priorities);
+
+  static ge::graphStatus GetNumaNodeCpus(const int32_t numa_node, std::vector<int32_t> &cpus);
+
+  size_t GetWorkerNum() const {
+    return workers_.size();
+  }
+  uint64_t GetStealCount() const {
+    return steal_count_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct alignas(64) WorkerQueue {
+    std::mutex mutex;
+    std::deque<uint32_t> tasks;
+  };
+  static constexpr uint32_t kInvalidTask = UINT32_MAX;
+
+  void WorkerLoop(const size_t worker_id);
+  void BindCpu(const size_t worker_id) const;
+  bool PopLocal(const size_t worker_id, uint32_t &task);
+  bool Steal(const size_t worker_id, uint32_t &task, uint64_t &seed);
+  void Push(const size_t worker_id, const uint32_t task);
+  void Execute(const size_t worker_id, uint32_t task, std::vector<uint32_t> &ready);
+  uint64_t GetPriority(const uint32_t task) const {
+    return (priorities_ == nullptr) ? task : (*priorities_)[task];
+  }
+
+  WorkStealingScheduleOption option_;
+  std::vector<int32_t> numa_cpus_;
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable work_cond_;
+  std::condition_variable done_cond_;
+  std::atomic<size_t> ready_num_{0U};
+  std::atomic<size_t> sleeping_num_{0U};
+  bool stop_ = false;
+
+  // 当前Run的状态
+  std::mutex run_mutex_;
+  const ScheduleTaskGraph *graph_ = nullptr;
+  const std::vector<uint64_t> *priorities_ = nullptr;
+  const TaskFunc *task_func_ = nullptr;
+  std::unique_ptr<std::atomic<uint32_t>[]> pending_inputs_;  // 每个节点未完成的输入数
+  size_t pending_capacity_ = 0U;
+  std::vector<uint32_t> sorted_tasks_;  // 只用于Run前的环检查，复用内存
+  std::atomic<size_t> remaining_{0U};
+  std::atomic<bool> failed_{false};
+  ge::graphStatus first_error_ = ge::GRAPH_SUCCESS;
+  std::atomic<uint64_t> steal_count_{0U};
+};
+}  // namespace gert
+#endif  // AIR_CXX_COMMON_RUNTIME_WORK_STEALING_SCHEDULER_H_
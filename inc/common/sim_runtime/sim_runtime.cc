@@ -0,0 +1,632 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/sim_runtime/sim_runtime.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <thread>
+#include <securec.h>
+
+#include "common/blocking_queue.h"
+#include "common/runtime/sampled_memory_tracer.h"
+#include "framework/common/debug/ge_log.h"
+#include "mmpa/mmpa_api.h"
+#include "runtime/event.h"
+#include "runtime/rt_model.h"
+#include "runtime/stream.h"
+
+namespace ge {
+namespace sim {
+namespace {
+using SimClock = std::chrono::steady_clock;
+constexpr uint32_t kSimStreamDepth = 1024U;
+constexpr uint64_t kMemcpyMaxLen = 0x7FFFFFFFU;
+
+void CopyMemory(void *const dst, const void *const src, const uint64_t cnt) {
+  uint64_t offset = 0U;
+  while (offset < cnt) {
+    const uint64_t len = std::min(cnt - offset, kMemcpyMaxLen);
+    if (memcpy_s(static_cast<uint8_t *>(dst) + offset, len, static_cast<const uint8_t *>(src) + offset, len) != EOK) {
+      GELOGE(FAILED, "[Sim][Memcpy]copy failed, dst %p, src %p, offset %lu, len %lu", dst, src, offset, len);
+      return;
+    }
+    offset += len;
+  }
+}
+
+void SetMemory(void *const dst, const uint32_t val, const uint64_t cnt) {
+  uint64_t offset = 0U;
+  while (offset < cnt) {
+    const uint64_t len = std::min(cnt - offset, kMemcpyMaxLen);
+    if (memset_s(static_cast<uint8_t *>(dst) + offset, len, static_cast<int32_t>(val), len) != EOK) {
+      GELOGE(FAILED, "[Sim][Memset]set failed, dst %p, offset %lu, len %lu", dst, offset, len);
+      return;
+    }
+    offset += len;
+  }
+}
+}  // namespace
+
+class SimStream {
+ public:
+  SimStream() : tasks_(kSimStreamDepth), worker_(&SimStream::Run, this) {}
+
+  ~SimStream() {
+    tasks_.Stop();
+    if (worker_.joinable()) {
+      worker_.join();
+    }
+  }
+
+  bool Push(std::function<void()> task) {
+    return tasks_.Push(std::move(task));
+  }
+
+  void Synchronize() {
+    std::promise<void> done;
+    auto done_future = done.get_future();
+    if (!Push([&done]() { done.set_value(); })) {
+      return;
+    }
+    done_future.wait();
+  }
+
+ private:
+  void Run() {
+    (void)mmSetCurrentThreadName("ge_sim_stream");
+    std::function<void()> task;
+    while (tasks_.Pop(task)) {
+      task();
+    }
+  }
+
+  BlockingQueue<std::function<void()>> tasks_;
+  std::thread worker_;
+};
+
+class SimEvent {
+ public:
+  // the record only counts once its completion task is queued, a failed submit leaves the event unchanged
+  template <typename SubmitFunc>
+  rtError_t Record(const SubmitFunc &submit) {
+    const std::lock_guard<std::mutex> record_lock(record_mutex_);
+    const uint64_t seq = GetRecordedSeq() + 1U;
+    const rtError_t ret = submit(seq);
+    if (ret == RT_ERROR_NONE) {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      recorded_seq_ = seq;
+    }
+    return ret;
+  }
+
+  uint64_t GetRecordedSeq() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return recorded_seq_;
+  }
+
+  void Complete(const uint64_t seq) {
+    {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      if (seq > completed_seq_) {
+        completed_seq_ = seq;
+        timestamp_ = SimClock::now();
+      }
+    }
+    cond_.notify_all();
+  }
+
+  void Wait(const uint64_t seq) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this, seq]() -> bool { return completed_seq_ >= seq; });
+  }
+
+  bool IsCompleted() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return completed_seq_ >= recorded_seq_;
+  }
+
+  SimClock::time_point GetTimestamp() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return timestamp_;
+  }
+
+ private:
+  std::mutex record_mutex_;  // serializes Record, held across the submit
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  uint64_t recorded_seq_ = 0U;
+  uint64_t completed_seq_ = 0U;
+  SimClock::time_point timestamp_ = SimClock::now();
+};
+
+SimRuntime &SimRuntime::GetInstance() {
+  static SimRuntime instance;
+  return instance;
+}
+
+SimRuntime::SimRuntime() = default;
+
+SimRuntime::~SimRuntime() {
+  // streams must be joined before the events their pending tasks reference
+  streams_.clear();
+  events_.clear();
+  for (const auto &allocation : allocations_) {
+    mmAlignFree(const_cast<void *>(allocation.first));
+  }
+  allocations_.clear();
+}
+
+void SimRuntime::SetConfig(const SimRuntimeConfig &config) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  config_ = config;
+}
+
+SimRuntimeConfig SimRuntime::GetConfig() const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return config_;
+}
+
+void SimRuntime::SetModelKernel(const rtModel_t model, const SimKernelDesc &kernel) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  const auto iter = models_.find(model);
+  if (iter == models_.end()) {
+    GELOGW("[Sim][Model]model %p is not created by rtModelCreate, kernel is ignored", model);
+    return;
+  }
+  *iter->second = kernel;
+}
+
+SimMemStat SimRuntime::GetMemStat() const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return mem_stat_;
+}
+
+rtStream_t SimRuntime::GetDefaultStream() {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (default_stream_ != nullptr) {
+      return default_stream_;
+    }
+  }
+  rtStream_t stream = nullptr;
+  (void)CreateStream(&stream);
+  const std::lock_guard<std::mutex> lock(mutex_);
+  if (default_stream_ == nullptr) {
+    default_stream_ = stream;
+    return default_stream_;
+  }
+  (void)streams_.erase(stream);
+  return default_stream_;
+}
+
+std::shared_ptr<SimStream> SimRuntime::GetStream(const rtStream_t stream) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  const auto iter = streams_.find(stream);
+  return (iter == streams_.end()) ? nullptr : iter->second;
+}
+
+std::shared_ptr<SimEvent> SimRuntime::GetEvent(const rtEvent_t event) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  const auto iter = events_.find(event);
+  return (iter == events_.end()) ? nullptr : iter->second;
+}
+
+rtError_t SimRuntime::Submit(const rtStream_t stream, std::function<void()> task) {
+  if (stream == nullptr) {
+    task();
+    return RT_ERROR_NONE;
+  }
+  const auto sim_stream = GetStream(stream);
+  if (sim_stream == nullptr) {
+    GELOGE(FAILED, "[Sim][Stream]stream %p does not exist", stream);
+    return kSimRtParamInvalid;
+  }
+  return sim_stream->Push(std::move(task)) ? RT_ERROR_NONE : kSimRtParamInvalid;
+}
+
+void SimRuntime::Delay(const uint64_t duration_us) const {
+  if (duration_us == 0U) {
+    return;
+  }
+  const auto deadline = SimClock::now() + std::chrono::microseconds(duration_us);
+  if (GetConfig().busy_wait) {
+    while (SimClock::now() < deadline) {
+    }
+    return;
+  }
+  std::this_thread::sleep_until(deadline);
+}
+
+uint64_t SimRuntime::CopyCost(const rtMemcpyKind_t kind, const uint64_t cnt) const {
+  const auto config = GetConfig();
+  SimCopyModel model;
+  switch (kind) {
+    case RT_MEMCPY_HOST_TO_DEVICE:
+    case RT_MEMCPY_HOST_TO_DEVICE_EX:
+      model = config.h2d;
+      break;
+    case RT_MEMCPY_DEVICE_TO_HOST:
+    case RT_MEMCPY_DEVICE_TO_HOST_EX:
+      model = config.d2h;
+      break;
+    case RT_MEMCPY_DEVICE_TO_DEVICE:
+    case RT_MEMCPY_ADDR_DEVICE_TO_DEVICE:
+      model = config.d2d;
+      break;
+    default:
+      model = config.h2h;
+      break;
+  }
+  // bytes / (MB/s) is microseconds when 1MB = 1e6 bytes
+  const uint64_t transfer_us = (model.bandwidth_mbps == 0U) ? 0U : (cnt / model.bandwidth_mbps);
+  return model.latency_us + transfer_us;
+}
+
+rtError_t SimRuntime::Malloc(void **const dev_ptr, const uint64_t size, const void *const site) {
+  if ((dev_ptr == nullptr) || (size == 0U)) {
+    GELOGE(FAILED, "[Sim][Malloc]invalid param, dev_ptr is %s, size %lu",
+           (dev_ptr == nullptr) ? "null" : "not null", size);
+    return kSimRtParamInvalid;
+  }
+  const std::lock_guard<std::mutex> lock(mutex_);
+  if ((config_.device_mem_limit != 0U) && (mem_stat_.allocated_size + size > config_.device_mem_limit)) {
+    GELOGE(FAILED, "[Sim][Malloc]out of device memory, allocated %lu, required %lu, limit %lu",
+           mem_stat_.allocated_size, size, config_.device_mem_limit);
+    return kSimRtMemoryAllocation;
+  }
+  void *const ptr = mmAlignMalloc(static_cast<mmSize>(size), static_cast<mmSize>(config_.mem_align_size));
+  if (ptr == nullptr) {
+    GELOGE(FAILED, "[Sim][Malloc]host allocation failed, size %lu", size);
+    return kSimRtMemoryAllocation;
+  }
+  allocations_[ptr] = size;
+  mem_stat_.allocated_size += size;
+  mem_stat_.peak_allocated_size = std::max(mem_stat_.peak_allocated_size, mem_stat_.allocated_size);
+  ++mem_stat_.malloc_count;
+  // nothing is cached, the reserved memory is the allocated memory
+  gert::SampledMemoryTracer::Record(ptr, static_cast<int64_t>(size), mem_stat_.allocated_size,
+                                    mem_stat_.allocated_size, site);
+  *dev_ptr = ptr;
+  return RT_ERROR_NONE;
+}
+
+rtError_t SimRuntime::Free(void *const dev_ptr, const void *const site) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  const auto iter = allocations_.find(dev_ptr);
+  if (iter == allocations_.end()) {
+    GELOGE(FAILED, "[Sim][Free]%p is not allocated by rtMalloc", dev_ptr);
+    return kSimRtParamInvalid;
+  }
+  mem_stat_.allocated_size -= iter->second;
+  ++mem_stat_.free_count;
+  gert::SampledMemoryTracer::Record(dev_ptr, -static_cast<int64_t>(iter->second), mem_stat_.allocated_size,
+                                    mem_stat_.allocated_size, site);
+  (void)allocations_.erase(iter);
+  mmAlignFree(dev_ptr);
+  return RT_ERROR_NONE;
+}
+
+rtError_t SimRuntime::GetMemInfo(size_t *const free_size, size_t *const total_size) const {
+  if ((free_size == nullptr) || (total_size == nullptr)) {
+    return kSimRtParamInvalid;
+  }
+  const std::lock_guard<std::mutex> lock(mutex_);
+  const uint64_t total = (config_.device_mem_limit == 0U) ? UINT64_MAX : config_.device_mem_limit;
+  *total_size = static_cast<size_t>(total);
+  *free_size = static_cast<size_t>(total - mem_stat_.allocated_size);
+  return RT_ERROR_NONE;
+}
+
+rtError_t SimRuntime::Memcpy(void *const dst, const uint64_t dest_max, const void *const src, const uint64_t cnt,
+                             const rtMemcpyKind_t kind, const rtStream_t stream) {
+  if ((dst == nullptr) || (src == nullptr) || (cnt > dest_max)) {
+    GELOGE(FAILED, "[Sim][Memcpy]invalid param, dst %p, src %p, dest_max %lu, cnt %lu", dst, src, dest_max, cnt);
+    return kSimRtParamInvalid;
+  }
+  const uint64_t cost_us = CopyCost(kind, cnt);
+  return Submit(stream, [this, dst, src, cnt, cost_us]() {
+    Delay(cost_us);
+    CopyMemory(dst, src, cnt);
+  });
+}
+
+rtError_t SimRuntime::Memset(void *const dst, const uint64_t dest_max, const uint32_t val, const uint64_t cnt,
+                             const rtStream_t stream) {
+  if ((dst == nullptr) || (cnt > dest_max)) {
+    GELOGE(FAILED, "[Sim][Memset]invalid param, dst %p, dest_max %lu, cnt %lu", dst, dest_max, cnt);
+    return kSimRtParamInvalid;
+  }
+  const uint64_t cost_us = CopyCost(RT_MEMCPY_DEVICE_TO_DEVICE, cnt);
+  return Submit(stream, [this, dst, val, cnt, cost_us]() {
+    Delay(cost_us);
+    SetMemory(dst, val, cnt);
+  });
+}
+
+rtError_t SimRuntime::CreateStream(rtStream_t *const stream) {
+  if (stream == nullptr) {
+    return kSimRtParamInvalid;
+  }
+  const auto sim_stream = std::make_shared<SimStream>();
+  const std::lock_guard<std::mutex> lock(mutex_);
+  *stream = sim_stream.get();
+  streams_[*stream] = sim_stream;
+  return RT_ERROR_NONE;
+}
+
+rtError_t SimRuntime::DestroyStream(const rtStream_t stream) {
+  std::shared_ptr<SimStream> sim_stream;
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    const auto iter = streams_.find(stream);
+    if (iter == streams_.end()) {
+      GELOGE(FAILED, "[Sim][Stream]stream %p does not exist", stream);
+      return kSimRtParamInvalid;
+    }
+    sim_stream = iter->second;
+    (void)streams_.erase(iter);
+    if (default_stream_ == stream) {
+      default_stream_ = nullptr;
+    }
+  }
+  // pending tasks are drained before the worker is joined
+  sim_stream->Synchronize();
+  return RT_ERROR_NONE;
+}
+
+rtError_t SimRuntime::SynchronizeStream(const rtStream_t stream) {
+  const auto sim_stream = GetStream((stream == nullptr) ? GetDefaultStream() : stream);
+  if (sim_stream == nullptr) {
+    GELOGE(FAILED, "[Sim][Stream]stream %p does not exist", stream);
+    return kSimRtParamInvalid;
+  }
+  sim_stream->Synchronize();
+  return RT_ERROR_NONE;
+}
+
+rtError_t SimRuntime::CreateEvent(rtEvent_t *const event) {
+  if (event == nullptr) {
+    return kSimRtParamInvalid;
+  }
+  const auto sim_event = std::make_shared<SimEvent>();
+  const std::lock_guard<std::mutex> lock(mutex_);
+  *event = sim_event.get();
+  events_[*event] = sim_event;
+  return RT_ERROR_NONE;
+}
+
+rtError_t SimRuntime::DestroyEvent(const rtEvent_t event) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  // tasks still referencing the event keep it alive through their own reference
+  return (events_.erase(event) == 0U) ? kSimRtParamInvalid : RT_ERROR_NONE;
+}
+
+rtError_t SimRuntime::RecordEvent(const rtEvent_t event, const rtStream_t stream) {
+  const auto sim_event = GetEvent(event);
+  if (sim_event == nullptr) {
+    GELOGE(FAILED, "[Sim][Event]event %p does not exist", event);
+    return kSimRtParamInvalid;
+  }
+  const rtStream_t target = (stream == nullptr) ? GetDefaultStream() : stream;
+  return sim_event->Record([this, target, &sim_event](const uint64_t seq) {
+    return Submit(target, [sim_event, seq]() { sim_event->Complete(seq); });
+  });
+}
+
+rtError_t SimRuntime::StreamWaitEvent(const rtStream_t stream, const rtEvent_t event) {
+  const auto sim_event = GetEvent(event);
+  if (sim_event == nullptr) {
+    GELOGE(FAILED, "[Sim][Event]event %p does not exist", event);
+    return kSimRtParamInvalid;
+  }
+  // wait for the last record issued before this call, as the device does
+  const uint64_t seq = sim_event->GetRecordedSeq();
+  return Submit((stream == nullptr) ? GetDefaultStream() : stream,
+                [sim_event, seq]() { sim_event->Wait(seq); });
+}
+
+rtError_t SimRuntime::SynchronizeEvent(const rtEvent_t event) {
+  const auto sim_event = GetEvent(event);
+  if (sim_event == nullptr) {
+    return kSimRtParamInvalid;
+  }
+  sim_event->Wait(sim_event->GetRecordedSeq());
+  return RT_ERROR_NONE;
+}
+
+rtError_t SimRuntime::QueryEvent(const rtEvent_t event) {
+  const auto sim_event = GetEvent(event);
+  if (sim_event == nullptr) {
+    return kSimRtParamInvalid;
+  }
+  return sim_event->IsCompleted() ? RT_ERROR_NONE : kSimRtEventNotComplete;
+}
+
+rtError_t SimRuntime::EventElapsedTime(float32_t *const time_interval, const rtEvent_t start, const rtEvent_t end) {
+  const auto start_event = GetEvent(start);
+  const auto end_event = GetEvent(end);
+  if ((time_interval == nullptr) || (start_event == nullptr) || (end_event == nullptr)) {
+    return kSimRtParamInvalid;
+  }
+  const std::chrono::duration<float32_t, std::milli> elapsed = end_event->GetTimestamp() -
+                                                               start_event->GetTimestamp();
+  *time_interval = elapsed.count();
+  return RT_ERROR_NONE;
+}
+
+rtError_t SimRuntime::CreateModel(rtModel_t *const model) {
+  if (model == nullptr) {
+    return kSimRtParamInvalid;
+  }
+  auto kernel = std::unique_ptr<SimKernelDesc>(new (std::nothrow) SimKernelDesc());
+  if (kernel == nullptr) {
+    return kSimRtMemoryAllocation;
+  }
+  const std::lock_guard<std::mutex> lock(mutex_);
+  kernel->duration_us = config_.kernel_duration_us;
+  *model = kernel.get();
+  models_[*model] = std::move(kernel);
+  return RT_ERROR_NONE;
+}
+
+rtError_t SimRuntime::DestroyModel(const rtModel_t model) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return (models_.erase(model) == 0U) ? kSimRtParamInvalid : RT_ERROR_NONE;
+}
+
+rtError_t SimRuntime::ExecuteModel(const rtModel_t model, const rtStream_t stream) {
+  SimKernelDesc kernel;
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    const auto iter = models_.find(model);
+    if (iter == models_.end()) {
+      GELOGE(FAILED, "[Sim][Model]model %p does not exist", model);
+      return kSimRtParamInvalid;
+    }
+    kernel = *iter->second;
+  }
+  return Submit((stream == nullptr) ? GetDefaultStream() : stream, [this, model, kernel]() {
+    Delay(kernel.duration_us);
+    if (kernel.func != nullptr) {
+      kernel.func(model);
+    }
+  });
+}
+}  // namespace sim
+}  // namespace ge
+
+using ge::sim::SimRuntime;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+rtError_t rtMalloc(void **devPtr, uint64_t size, rtMemType_t type, const uint16_t moduleId) {
+  (void)type;
+  (void)moduleId;
+  return SimRuntime::GetInstance().Malloc(devPtr, size, GERT_TRACE_RETURN_ADDRESS());
+}
+
+rtError_t rtFree(void *devPtr) {
+  return SimRuntime::GetInstance().Free(devPtr, GERT_TRACE_RETURN_ADDRESS());
+}
+
+rtError_t rtMallocHost(void **hostPtr, uint64_t size, const uint16_t moduleId) {
+  (void)moduleId;
+  if ((hostPtr == nullptr) || (size == 0U)) {
+    return ge::sim::kSimRtParamInvalid;
+  }
+  *hostPtr = mmAlignMalloc(static_cast<mmSize>(size), static_cast<mmSize>(SimRuntime::GetInstance().GetConfig()
+                                                                              .mem_align_size));
+  return (*hostPtr == nullptr) ? ge::sim::kSimRtMemoryAllocation : RT_ERROR_NONE;
+}
+
+rtError_t rtFreeHost(void *hostPtr) {
+  mmAlignFree(hostPtr);
+  return RT_ERROR_NONE;
+}
+
+rtError_t rtMemGetInfo(size_t *freeSize, size_t *totalSize) {
+  return SimRuntime::GetInstance().GetMemInfo(freeSize, totalSize);
+}
+
+rtError_t rtMemcpy(void *dst, uint64_t destMax, const void *src, uint64_t cnt, rtMemcpyKind_t kind) {
+  return SimRuntime::GetInstance().Memcpy(dst, destMax, src, cnt, kind, nullptr);
+}
+
+rtError_t rtMemcpyAsync(void *dst, uint64_t destMax, const void *src, uint64_t cnt, rtMemcpyKind_t kind,
+                        rtStream_t stm) {
+  auto &runtime = SimRuntime::GetInstance();
+  return runtime.Memcpy(dst, destMax, src, cnt, kind, (stm == nullptr) ? runtime.GetDefaultStream() : stm);
+}
+
+rtError_t rtMemset(void *devPtr, uint64_t destMax, uint32_t val, uint64_t cnt) {
+  return SimRuntime::GetInstance().Memset(devPtr, destMax, val, cnt, nullptr);
+}
+
+rtError_t rtMemsetAsync(void *ptr, uint64_t destMax, uint32_t val, uint64_t cnt, rtStream_t stm) {
+  auto &runtime = SimRuntime::GetInstance();
+  return runtime.Memset(ptr, destMax, val, cnt, (stm == nullptr) ? runtime.GetDefaultStream() : stm);
+}
+
+rtError_t rtStreamCreate(rtStream_t *stm, int32_t priority) {
+  (void)priority;
+  return SimRuntime::GetInstance().CreateStream(stm);
+}
+
+rtError_t rtStreamCreateWithFlags(rtStream_t *stm, int32_t priority, uint32_t flags) {
+  (void)flags;
+  return rtStreamCreate(stm, priority);
+}
+
+rtError_t rtStreamDestroy(rtStream_t stm) {
+  return SimRuntime::GetInstance().DestroyStream(stm);
+}
+
+rtError_t rtStreamSynchronize(rtStream_t stm) {
+  return SimRuntime::GetInstance().SynchronizeStream(stm);
+}
+
+rtError_t rtStreamWaitEvent(rtStream_t stm, rtEvent_t evt) {
+  return SimRuntime::GetInstance().StreamWaitEvent(stm, evt);
+}
+
+rtError_t rtEventCreate(rtEvent_t *evt) {
+  return SimRuntime::GetInstance().CreateEvent(evt);
+}
+
+rtError_t rtEventCreateWithFlag(rtEvent_t *evt, uint32_t flag) {
+  (void)flag;
+  return rtEventCreate(evt);
+}
+
+rtError_t rtEventDestroy(rtEvent_t evt) {
+  return SimRuntime::GetInstance().DestroyEvent(evt);
+}
+
+rtError_t rtEventRecord(rtEvent_t evt, rtStream_t stm) {
+  return SimRuntime::GetInstance().RecordEvent(evt, stm);
+}
+
+rtError_t rtEventSynchronize(rtEvent_t evt) {
+  return SimRuntime::GetInstance().SynchronizeEvent(evt);
+}
+
+rtError_t rtEventQuery(rtEvent_t evt) {
+  return SimRuntime::GetInstance().QueryEvent(evt);
+}
+
+rtError_t rtEventElapsedTime(float32_t *timeInterval, rtEvent_t startEvent, rtEvent_t endEvent) {
+  return SimRuntime::GetInstance().EventElapsedTime(timeInterval, startEvent, endEvent);
+}
+
+rtError_t rtModelCreate(rtModel_t *mdl, uint32_t flag) {
+  (void)flag;
+  return SimRuntime::GetInstance().CreateModel(mdl);
+}
+
+rtError_t rtModelDestroy(rtModel_t mdl) {
+  return SimRuntime::GetInstance().DestroyModel(mdl);
+}
+
+rtError_t rtModelExecute(rtModel_t mdl, rtStream_t stm, uint32_t flag) {
+  (void)flag;
+  return SimRuntime::GetInstance().ExecuteModel(mdl, stm);
+}
+#if defined(__cplusplus)
+}
+#endif
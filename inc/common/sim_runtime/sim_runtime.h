@@ -0,0 +1,137 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_COMMON_SIM_RUNTIME_SIM_RUNTIME_H_
+#define GE_COMMON_SIM_RUNTIME_SIM_RUNTIME_H_
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "runtime/base.h"
+#include "runtime/mem.h"
+
+/*
+ * Host-only implementation of the runtime api subset used by the sample pipeline
+ * (rtMalloc, rtMemcpy(Async), stream, event and rtModelExecute). Link sim_runtime.cc instead of
+ * libruntime.so to run SampleProcess/ModelProcess, executors and allocators without an NPU:
+ *  - device memory is host memory, copies are delayed according to a latency/bandwidth model;
+ *  - every stream is a worker thread consuming its tasks in order;
+ *  - every event is a completion fence recorded on a stream;
+ *  - a model execution is a synthetic kernel with a configurable duration and an optional host callback.
+ */
+namespace ge {
+namespace sim {
+constexpr rtError_t kSimRtParamInvalid = 107000;      // same value as ACL_ERROR_RT_PARAM_INVALID
+constexpr rtError_t kSimRtMemoryAllocation = 207001;  // same value as ACL_ERROR_RT_MEMORY_ALLOCATION
+constexpr rtError_t kSimRtEventNotComplete = 207018;  // returned by rtEventQuery while the record is pending
+
+struct SimCopyModel {
+  uint64_t latency_us = 0U;       // fixed cost of one copy task
+  uint64_t bandwidth_mbps = 0U;   // MB per second, 0 means infinite bandwidth
+};
+
+struct SimRuntimeConfig {
+  SimCopyModel h2d;
+  SimCopyModel d2h;
+  SimCopyModel d2d;
+  SimCopyModel h2h;
+  uint64_t mem_align_size = 512U;         // alignment of device allocations
+  uint64_t device_mem_limit = 0U;         // total device memory, 0 means unlimited
+  uint64_t kernel_duration_us = 0U;       // default duration of rtModelExecute
+  bool busy_wait = false;                 // spin instead of sleep, more accurate for short tasks
+};
+
+struct SimMemStat {
+  uint64_t allocated_size = 0U;
+  uint64_t peak_allocated_size = 0U;
+  uint64_t malloc_count = 0U;
+  uint64_t free_count = 0U;
+};
+
+// called on the stream worker thread when the model is executed, may touch the model io device memory
+using SimKernelFunc = std::function<void(rtModel_t model)>;
+
+struct SimKernelDesc {
+  uint64_t duration_us = 0U;
+  SimKernelFunc func = nullptr;
+};
+
+class SimStream;
+class SimEvent;
+
+class SimRuntime {
+ public:
+  static SimRuntime &GetInstance();
+
+  void SetConfig(const SimRuntimeConfig &config);
+  SimRuntimeConfig GetConfig() const;
+  void SetModelKernel(const rtModel_t model, const SimKernelDesc &kernel);
+  SimMemStat GetMemStat() const;
+  // stream used by async api called with a null stream
+  rtStream_t GetDefaultStream();
+
+  // site is the caller of rtMalloc/rtFree, reported to gert::SampledMemoryTracer when it is enabled
+  rtError_t Malloc(void **const dev_ptr, const uint64_t size, const void *const site = nullptr);
+  rtError_t Free(void *const dev_ptr, const void *const site = nullptr);
+  rtError_t GetMemInfo(size_t *const free_size, size_t *const total_size) const;
+  rtError_t Memcpy(void *const dst, const uint64_t dest_max, const void *const src, const uint64_t cnt,
+                   const rtMemcpyKind_t kind, const rtStream_t stream);
+  rtError_t Memset(void *const dst, const uint64_t dest_max, const uint32_t val, const uint64_t cnt,
+                   const rtStream_t stream);
+
+  rtError_t CreateStream(rtStream_t *const stream);
+  rtError_t DestroyStream(const rtStream_t stream);
+  rtError_t SynchronizeStream(const rtStream_t stream);
+
+  rtError_t CreateEvent(rtEvent_t *const event);
+  rtError_t DestroyEvent(const rtEvent_t event);
+  rtError_t RecordEvent(const rtEvent_t event, const rtStream_t stream);
+  rtError_t StreamWaitEvent(const rtStream_t stream, const rtEvent_t event);
+  rtError_t SynchronizeEvent(const rtEvent_t event);
+  rtError_t QueryEvent(const rtEvent_t event);
+  rtError_t EventElapsedTime(float32_t *const time_interval, const rtEvent_t start, const rtEvent_t end);
+
+  rtError_t CreateModel(rtModel_t *const model);
+  rtError_t DestroyModel(const rtModel_t model);
+  rtError_t ExecuteModel(const rtModel_t model, const rtStream_t stream);
+
+ private:
+  SimRuntime();
+  ~SimRuntime();
+  std::shared_ptr<SimStream> GetStream(const rtStream_t stream);
+  std::shared_ptr<SimEvent> GetEvent(const rtEvent_t event);
+  // run the task on the stream, a null stream means the caller thread (synchronous api)
+  // so async api must map a null stream to GetDefaultStream() first
+  rtError_t Submit(const rtStream_t stream, std::function<void()> task);
+  void Delay(const uint64_t duration_us) const;
+  uint64_t CopyCost(const rtMemcpyKind_t kind, const uint64_t cnt) const;
+
+  mutable std::mutex mutex_;
+  SimRuntimeConfig config_;
+  SimMemStat mem_stat_;
+  std::map<const void *, uint64_t> allocations_;
+  std::map<rtStream_t, std::shared_ptr<SimStream>> streams_;
+  std::map<rtEvent_t, std::shared_ptr<SimEvent>> events_;
+  std::map<rtModel_t, std::unique_ptr<SimKernelDesc>> models_;
+  rtStream_t default_stream_ = nullptr;
+};
+}  // namespace sim
+}  // namespace ge
+
+#endif  // GE_COMMON_SIM_RUNTIME_SIM_RUNTIME_H_
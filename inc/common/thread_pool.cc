@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/thread_pool.h"
+
+#include <algorithm>
+
+#include "mmpa/mmpa_api.h"
+
+namespace ge {
+namespace {
+constexpr size_t kMaxThreadNameLen = 15U;
+}
+
+ThreadPool::ThreadPool(const std::string &thread_name_prefix, const uint32_t size)
+    : is_stoped_(false), thread_name_prefix_(thread_name_prefix) {
+  idle_thrd_num_ = (size < 1U) ? 1U : size;
+
+  for (uint32_t i = 0U; i < idle_thrd_num_; ++i) {
+    pool_.emplace_back(&ThreadPool::ThreadFunc, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  is_stoped_.store(true);
+  {
+    const std::lock_guard<std::mutex> lock{m_lock_};
+    cond_var_.notify_all();
+  }
+
+  for (std::thread &thd : pool_) {
+    if (thd.joinable()) {
+      try {
+        thd.join();
+      } catch (...) {
+        GELOGW("exception");
+      }
+    }
+  }
+}
+
+uint32_t ThreadPool::GetDefaultThreadNum(const uint32_t max_thread_num) {
+  const uint32_t hw_num = std::max(std::thread::hardware_concurrency(), 1U);
+  return (max_thread_num == 0U) ? hw_num : std::min(hw_num, max_thread_num);
+}
+
+void ThreadPool::ThreadFunc(ThreadPool *const thread_pool, const uint32_t thread_idx) {
+  if (thread_pool == nullptr) {
+    return;
+  }
+  if (!thread_pool->thread_name_prefix_.empty()) {
+    std::string thread_name = thread_pool->thread_name_prefix_ + std::to_string(thread_idx);
+    thread_name = thread_name.substr(0U, kMaxThreadNameLen);
+    (void)mmSetCurrentThreadName(thread_name.c_str());
+  }
+  while (!thread_pool->is_stoped_) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock{thread_pool->m_lock_};
+      thread_pool->cond_var_.wait(
+          lock, [thread_pool]() -> bool { return thread_pool->is_stoped_.load() || !thread_pool->tasks_.empty(); });
+      if (thread_pool->is_stoped_ && thread_pool->tasks_.empty()) {
+        return;
+      }
+      task = std::move(thread_pool->tasks_.front());
+      thread_pool->tasks_.pop();
+    }
+    --thread_pool->idle_thrd_num_;
+    task();
+    ++thread_pool->idle_thrd_num_;
+  }
+}
+}  // namespace ge
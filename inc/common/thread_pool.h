@@ -0,0 +1,84 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_COMMON_THREAD_POOL_H_
+#define GE_COMMON_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/util/mem_utils.h"
+#include "framework/common/debug/ge_log.h"
+
+namespace ge {
+using ThreadTask = std::function<void()>;
+
+class ThreadPool {
+ public:
+  explicit ThreadPool(const std::string &thread_name_prefix, const uint32_t size = 4U);
+  ~ThreadPool();
+
+  template <class Func, class... Args>
+  auto commit(Func &&func, Args &&... args) -> std::future<decltype(func(args...))> {
+    using retType = decltype(func(args...));
+    std::future<retType> fail_future;
+    if (is_stoped_.load()) {
+      GELOGE(ge::FAILED, "[Commit][Task]thread pool %s has been stopped.", thread_name_prefix_.c_str());
+      return fail_future;
+    }
+
+    const auto bind_func = std::bind(std::forward<Func>(func), std::forward<Args>(args)...);
+    const auto task = ge::MakeShared<std::packaged_task<retType()>>(bind_func);
+    if (task == nullptr) {
+      GELOGE(ge::FAILED, "[Commit][Task]make shared failed.");
+      return fail_future;
+    }
+    std::future<retType> future = task->get_future();
+    {
+      const std::lock_guard<std::mutex> lock{m_lock_};
+      tasks_.emplace([task]() { (*task)(); });
+    }
+    cond_var_.notify_one();
+    return future;
+  }
+
+  uint32_t GetThreadNum() const { return static_cast<uint32_t>(pool_.size()); }
+
+  // number of workers to use when the caller does not specify one
+  static uint32_t GetDefaultThreadNum(const uint32_t max_thread_num);
+
+  static void ThreadFunc(ThreadPool *const thread_pool, const uint32_t thread_idx);
+
+ private:
+  std::vector<std::thread> pool_;
+  std::queue<ThreadTask> tasks_;
+  std::mutex m_lock_;
+  std::condition_variable cond_var_;
+  std::atomic<bool> is_stoped_;
+  std::atomic<uint32_t> idle_thrd_num_;
+  std::string thread_name_prefix_;
+};
+}  // namespace ge
+
+#endif  // GE_COMMON_THREAD_POOL_H_
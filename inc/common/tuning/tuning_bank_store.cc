@@ -0,0 +1,297 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/tuning/tuning_bank_store.h"
+
+#include <cstring>
+#include <fstream>
+#include <sys/mman.h>
+
+#include "common/checker.h"
+#include "mmpa/mmpa_api.h"
+#include "register/tuning_bank_key_registry.h"
+
+namespace tuningtiling {
+namespace {
+constexpr char kBankMagic[sizeof(TuningBankHeader::magic)] = {'T', 'U', 'N', 'E', 'B', 'A', 'N', 'K'};
+constexpr uint32_t kBankVersion = 1U;
+constexpr uint64_t kMinSlotNum = 8U;
+constexpr size_t kRecordAlign = 8U;
+constexpr uint64_t kFnvOffsetBasis = 14695981039346656037UL;
+constexpr uint64_t kFnvPrime = 1099511628211UL;
+
+size_t AlignUp(const size_t size) {
+  return (size + kRecordAlign - 1U) & ~(kRecordAlign - 1U);
+}
+
+uint64_t FnvUpdate(uint64_t hash, const uint8_t *const data, const size_t len) {
+  for (size_t i = 0U; i < len; ++i) {
+    hash ^= static_cast<uint64_t>(data[i]);
+    hash *= kFnvPrime;
+  }
+  return hash;
+}
+
+const OpBankKeyFuncInfo *FindFuncInfo(const std::string &op_type) {
+  auto &func_infos = OpBankKeyFuncRegistry::RegisteredOpFuncInfo();
+  const auto iter = func_infos.find(ge::AscendString(op_type.c_str()));
+  return (iter == func_infos.end()) ? nullptr : &iter->second;
+}
+
+// record payload at the given offset, nullptr if it does not fit in the file
+const TuningBankRecordHead *GetRecord(const uint8_t *const data, const size_t len, const uint64_t offset) {
+  if ((offset == 0U) || (offset > len) || ((len - offset) < sizeof(TuningBankRecordHead))) {
+    return nullptr;
+  }
+  const auto record = reinterpret_cast<const TuningBankRecordHead *>(data + offset);
+  const uint64_t payload = AlignUp(record->op_type_len) + AlignUp(record->key_len) +
+                           static_cast<uint64_t>(record->value_len);
+  return (payload <= (len - offset - sizeof(TuningBankRecordHead))) ? record : nullptr;
+}
+
+const uint8_t *GetOpType(const TuningBankRecordHead *const record) {
+  return reinterpret_cast<const uint8_t *>(record) + sizeof(TuningBankRecordHead);
+}
+const uint8_t *GetKey(const TuningBankRecordHead *const record) {
+  return GetOpType(record) + AlignUp(record->op_type_len);
+}
+const uint8_t *GetValue(const TuningBankRecordHead *const record) {
+  return GetKey(record) + AlignUp(record->key_len);
+}
+}  // namespace
+
+uint64_t TuningBankStore::Hash(const char *const op_type, const size_t op_type_len, const void *const key,
+                               const size_t key_len) {
+  static const uint8_t kSeparator = 0U;
+  uint64_t hash = FnvUpdate(kFnvOffsetBasis, reinterpret_cast<const uint8_t *>(op_type), op_type_len);
+  hash = FnvUpdate(hash, &kSeparator, 1U);
+  return FnvUpdate(hash, static_cast<const uint8_t *>(key), key_len);
+}
+
+ge::graphStatus TuningBankBuilder::Add(const std::string &op_type, const void *const key, const size_t key_len,
+                                       const std::string &value) {
+  GE_ASSERT_TRUE((key != nullptr) && (key_len > 0U) && (key_len <= UINT32_MAX) && (value.size() <= UINT32_MAX),
+                 "Bank key or value of op type %s is invalid", op_type.c_str());
+  Record record;
+  record.op_type = op_type;
+  record.key.assign(static_cast<const uint8_t *>(key), static_cast<const uint8_t *>(key) + key_len);
+  record.value = value;
+  records_.emplace_back(std::move(record));
+  return ge::GRAPH_SUCCESS;
+}
+
+ge::graphStatus TuningBankBuilder::AddFromJson(const std::string &op_type, const nlohmann::json &bank_key,
+                                               const std::string &value) {
+  const OpBankKeyFuncInfo *const func_info = FindFuncInfo(op_type);
+  GE_ASSERT_NOTNULL(func_info, "Bank key of op type %s is not registered", op_type.c_str());
+  const auto &load_func = func_info->GetBankKeyLoadFunc();
+  GE_ASSERT_NOTNULL(load_func, "Bank key load func of op type %s is not registered", op_type.c_str());
+  std::shared_ptr<void> key;
+  size_t key_len = 0U;
+  GE_ASSERT_TRUE(load_func(key, key_len, bank_key), "Load bank key of op type %s from json failed", op_type.c_str());
+  return Add(op_type, key.get(), key_len, value);
+}
+
+ge::graphStatus TuningBankBuilder::Save(const std::string &file_path) const {
+  uint64_t slot_num = kMinSlotNum;
+  while (slot_num < (static_cast<uint64_t>(records_.size()) * 2U)) {
+    slot_num <<= 1U;
+  }
+  std::vector<TuningBankSlot> slots(static_cast<size_t>(slot_num), TuningBankSlot{0U, 0U});
+  std::vector<uint8_t> payload;
+  const uint64_t payload_offset = sizeof(TuningBankHeader) + (sizeof(TuningBankSlot) * slot_num);
+  uint64_t record_num = 0U;
+  for (const auto &record : records_) {
+    const uint64_t hash = TuningBankStore::Hash(record.op_type.data(), record.op_type.size(), record.key.data(),
+                                                record.key.size());
+    const uint64_t offset = payload_offset + payload.size();
+    TuningBankRecordHead head{static_cast<uint32_t>(record.op_type.size()), static_cast<uint32_t>(record.key.size()),
+                              static_cast<uint32_t>(record.value.size()), 0U};
+    const size_t begin = payload.size();
+    payload.resize(begin + sizeof(head) + AlignUp(head.op_type_len) + AlignUp(head.key_len) + AlignUp(head.value_len));
+    uint8_t *const dst = payload.data() + begin;
+    (void)memcpy(dst, &head, sizeof(head));
+    (void)memcpy(dst + sizeof(head), record.op_type.data(), head.op_type_len);
+    (void)memcpy(dst + sizeof(head) + AlignUp(head.op_type_len), record.key.data(), head.key_len);
+    (void)memcpy(dst + sizeof(head) + AlignUp(head.op_type_len) + AlignUp(head.key_len), record.value.data(),
+                 head.value_len);
+
+    // linear probing, a later record of the same op type and key replaces the earlier one
+    for (uint64_t index = hash & (slot_num - 1U);; index = (index + 1U) & (slot_num - 1U)) {
+      TuningBankSlot &slot = slots[static_cast<size_t>(index)];
+      if (slot.record_offset == 0U) {
+        slot = TuningBankSlot{hash, offset};
+        ++record_num;
+        break;
+      }
+      if (slot.hash == hash) {
+        const auto exist = reinterpret_cast<const TuningBankRecordHead *>(payload.data() +
+                                                                           (slot.record_offset - payload_offset));
+        if ((exist->op_type_len == head.op_type_len) && (exist->key_len == head.key_len) &&
+            (memcmp(GetOpType(exist), record.op_type.data(), head.op_type_len) == 0) &&
+            (memcmp(GetKey(exist), record.key.data(), head.key_len) == 0)) {
+          slot.record_offset = offset;
+          break;
+        }
+      }
+    }
+  }
+
+  TuningBankHeader header{};
+  (void)memcpy(header.magic, kBankMagic, sizeof(header.magic));
+  header.version = kBankVersion;
+  header.slot_num = slot_num;
+  header.record_num = record_num;
+  header.file_size = payload_offset + payload.size();
+  std::ofstream ofs(file_path, std::ios::out | std::ios::binary | std::ios::trunc);
+  GE_ASSERT_TRUE(ofs.is_open(), "Open tuning bank file %s failed", file_path.c_str());
+  (void)ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  (void)ofs.write(reinterpret_cast<const char *>(slots.data()),
+                  static_cast<std::streamsize>(sizeof(TuningBankSlot) * slots.size()));
+  (void)ofs.write(reinterpret_cast<const char *>(payload.data()), static_cast<std::streamsize>(payload.size()));
+  GE_ASSERT_TRUE(ofs.good(), "Write tuning bank file %s failed", file_path.c_str());
+  GELOGI("Save tuning bank %s, record num %lu, slot num %lu, size %lu.", file_path.c_str(), record_num, slot_num,
+         header.file_size);
+  return ge::GRAPH_SUCCESS;
+}
+
+ge::graphStatus TuningBankStore::Load(const std::string &file_path) {
+  ULONGLONG file_size = 0U;
+  GE_ASSERT_TRUE((mmGetFileSize(file_path.c_str(), &file_size) == EN_OK) && (file_size > 0U),
+                 "Get size of tuning bank file %s failed or file is empty", file_path.c_str());
+  int32_t fd = mmOpen(file_path.c_str(), M_RDONLY);
+  GE_ASSERT_TRUE(fd >= 0, "Open tuning bank file %s failed", file_path.c_str());
+  const size_t len = static_cast<size_t>(file_size);
+  void *const addr = mmMmap(fd, static_cast<mmSize_t>(len), 0, &fd, PROT_READ, MAP_PRIVATE);
+  (void)mmClose(fd);
+  GE_ASSERT_TRUE((addr != nullptr) && (addr != MAP_FAILED), "Map tuning bank file %s failed", file_path.c_str());
+  const std::shared_ptr<const void> owner(addr, [len](const void *const mapped) {
+    (void)munmap(const_cast<void *>(mapped), len);
+  });
+  return Load(static_cast<const uint8_t *>(addr), len, owner);
+}
+
+ge::graphStatus TuningBankStore::Load(const uint8_t *const data, const size_t len,
+                                      const std::shared_ptr<const void> &owner) {
+  GE_ASSERT_NOTNULL(data);
+  GE_ASSERT_TRUE(len >= sizeof(TuningBankHeader), "Tuning bank size %zu is less than the header", len);
+  const auto header = reinterpret_cast<const TuningBankHeader *>(data);
+  GE_ASSERT_TRUE((memcmp(header->magic, kBankMagic, sizeof(kBankMagic)) == 0) && (header->version == kBankVersion),
+                 "Tuning bank magic or version %u is invalid", header->version);
+  GE_ASSERT_TRUE((header->file_size == len) && (header->slot_num > 0U) &&
+                 ((header->slot_num & (header->slot_num - 1U)) == 0U) &&
+                 (header->slot_num <= ((len - sizeof(TuningBankHeader)) / sizeof(TuningBankSlot))),
+                 "Tuning bank slot num %lu or size %zu is invalid", header->slot_num, len);
+  const auto slots = reinterpret_cast<const TuningBankSlot *>(data + sizeof(TuningBankHeader));
+  std::unordered_map<std::string, const OpBankKeyFuncInfo *> func_infos;
+  for (uint64_t index = 0U; index < header->slot_num; ++index) {
+    if (slots[index].record_offset == 0U) {
+      continue;
+    }
+    const TuningBankRecordHead *const record = GetRecord(data, len, slots[index].record_offset);
+    GE_ASSERT_NOTNULL(record, "Record of slot %lu exceeds the tuning bank", index);
+    std::string op_type(reinterpret_cast<const char *>(GetOpType(record)), record->op_type_len);
+    if (func_infos.count(op_type) == 0U) {
+      const OpBankKeyFuncInfo *const func_info = FindFuncInfo(op_type);
+      (void)func_infos.emplace(std::move(op_type), func_info);
+    }
+  }
+  owner_ = owner;
+  data_ = data;
+  len_ = len;
+  header_ = header;
+  slots_ = slots;
+  func_infos_ = std::move(func_infos);
+  GELOGI("Load tuning bank, record num %lu, slot num %lu, size %zu.", header->record_num, header->slot_num, len);
+  return ge::GRAPH_SUCCESS;
+}
+
+bool TuningBankStore::Find(const std::string &op_type, const void *const key, const size_t key_len,
+                           const uint8_t *&value, size_t &value_len) const {
+  if ((header_ == nullptr) || (key == nullptr)) {
+    return false;
+  }
+  const uint64_t hash = Hash(op_type.data(), op_type.size(), key, key_len);
+  const uint64_t mask = header_->slot_num - 1U;
+  for (uint64_t probe = 0U, index = hash & mask; probe < header_->slot_num; ++probe, index = (index + 1U) & mask) {
+    const TuningBankSlot &slot = slots_[index];
+    if (slot.record_offset == 0U) {
+      return false;
+    }
+    if (slot.hash != hash) {
+      continue;
+    }
+    const TuningBankRecordHead *const record = GetRecord(data_, len_, slot.record_offset);
+    if ((record != nullptr) && (record->op_type_len == op_type.size()) && (record->key_len == key_len) &&
+        (memcmp(GetOpType(record), op_type.data(), op_type.size()) == 0) &&
+        (memcmp(GetKey(record), key, key_len) == 0)) {
+      value = GetValue(record);
+      value_len = record->value_len;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool TuningBankStore::Find(const std::string &op_type, const gert::TilingContext *const context,
+                           const uint8_t *&value, size_t &value_len) const {
+  // an op type without records can not hit, no key is converted for it
+  const auto iter = func_infos_.find(op_type);
+  if (iter == func_infos_.end()) {
+    return false;
+  }
+  // registered after Load, resolved on every lookup
+  const OpBankKeyFuncInfo *const func_info = (iter->second != nullptr) ? iter->second : FindFuncInfo(op_type);
+  if ((func_info == nullptr) || (func_info->GetBankKeyConvertFunc() == nullptr)) {
+    return false;
+  }
+  // the registered convert func creates the key itself, this is the only allocation of the lookup
+  std::shared_ptr<void> key;
+  size_t key_len = 0U;
+  if (!func_info->GetBankKeyConvertFunc()(context, key, key_len)) {
+    GELOGW("Convert bank key of op type %s failed.", op_type.c_str());
+    return false;
+  }
+  return Find(op_type, key.get(), key_len, value, value_len);
+}
+
+ge::graphStatus TuningBankStore::ExportJson(nlohmann::json &bank_json) const {
+  GE_ASSERT_NOTNULL(header_, "Tuning bank is not loaded");
+  bank_json = nlohmann::json::array();
+  for (uint64_t index = 0U; index < header_->slot_num; ++index) {
+    if (slots_[index].record_offset == 0U) {
+      continue;
+    }
+    const TuningBankRecordHead *const record = GetRecord(data_, len_, slots_[index].record_offset);
+    GE_ASSERT_NOTNULL(record, "Record of slot %lu exceeds the tuning bank", index);
+    const std::string op_type(reinterpret_cast<const char *>(GetOpType(record)), record->op_type_len);
+    const OpBankKeyFuncInfo *const func_info = FindFuncInfo(op_type);
+    GE_ASSERT_TRUE((func_info != nullptr) && (func_info->GetBankKeyParseFunc() != nullptr),
+                   "Bank key parse func of op type %s is not registered", op_type.c_str());
+    // the parse func reads the key as its struct, give it an aligned copy
+    const size_t word_num = AlignUp(record->key_len) / sizeof(uint64_t);
+    const std::shared_ptr<void> key(new (std::nothrow) uint64_t[word_num], std::default_delete<uint64_t[]>());
+    GE_ASSERT_NOTNULL(key);
+    (void)memcpy(key.get(), GetKey(record), record->key_len);
+    nlohmann::json bank_key;
+    GE_ASSERT_TRUE(func_info->GetBankKeyParseFunc()(key, record->key_len, bank_key),
+                   "Parse bank key of op type %s failed", op_type.c_str());
+    bank_json.push_back({{"op_type", op_type}, {"bank_key", bank_key},
+                         {"value", std::string(reinterpret_cast<const char *>(GetValue(record)), record->value_len)}});
+  }
+  return ge::GRAPH_SUCCESS;
+}
+}  // namespace tuningtiling
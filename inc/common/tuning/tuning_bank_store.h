@@ -0,0 +1,123 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INC_COMMON_TUNING_TUNING_BANK_STORE_H_
+#define INC_COMMON_TUNING_TUNING_BANK_STORE_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "graph/ge_error_codes.h"
+
+namespace gert {
+class TilingContext;
+}  // namespace gert
+
+namespace tuningtiling {
+class OpBankKeyFuncInfo;
+
+/**
+ * 编译后的tuning bank文件格式，所有整数为小端：
+ * | TuningBankHeader | TuningBankSlot * slot_num | record ... |
+ * record: TuningBankRecordHead + op_type + bank key + tuned value，每段按8字节对齐
+ * bank key为注册的POD bank key结构体的原始字节，索引为开放寻址（线性探测）的哈希表，哈希覆盖op type与bank key
+ * 哈希与比较按原始字节进行，填充字节也参与比较，因此bank key结构体须满足以下之一：
+ * 1. 无填充字节（需要对齐时显式声明reserved成员并置0）
+ * 2. 对象经值初始化后逐成员赋值，填充字节保持为0；DECLARE_STRUCT_RELATE_WITH_OP生成的load函数即如此，
+ *    自定义的OpBankKeyConvertFun同样须使用std::make_shared<T>()或memset后再赋值，不能整体拷贝临时对象
+ */
+struct TuningBankHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+  uint64_t slot_num;  // 2的幂
+  uint64_t record_num;
+  uint64_t file_size;
+};
+
+struct TuningBankSlot {
+  uint64_t hash;
+  uint64_t record_offset;  // 0表示空槽，相对文件头
+};
+
+struct TuningBankRecordHead {
+  uint32_t op_type_len;
+  uint32_t key_len;
+  uint32_t value_len;
+  uint32_t reserved;
+};
+
+/**
+ * 生成编译后的bank文件，JSON只作为导入格式：通过注册的OpBankLoadFun把JSON的bank key转换为POD结构体
+ */
+class TuningBankBuilder {
+ public:
+  ge::graphStatus Add(const std::string &op_type, const void *const key, const size_t key_len,
+                      const std::string &value);
+  ge::graphStatus AddFromJson(const std::string &op_type, const nlohmann::json &bank_key, const std::string &value);
+  ge::graphStatus Save(const std::string &file_path) const;
+  size_t GetRecordNum() const {
+    return records_.size();
+  }
+
+ private:
+  struct Record {
+    std::string op_type;
+    std::vector<uint8_t> key;
+    std::string value;
+  };
+  std::vector<Record> records_;
+};
+
+/**
+ * 只读映射编译后的bank文件，加载只做一次mmap与头部校验，并解析一次bank中各op type注册的bank key函数
+ * 按bank key查找的Find为O(1)且不申请内存，返回的value指向映射区域，有效期与store相同；
+ * 按tiling context查找的Find除注册的OpBankKeyConvertFun创建key的申请外不申请内存
+ */
+class TuningBankStore {
+ public:
+  ge::graphStatus Load(const std::string &file_path);
+  ge::graphStatus Load(const uint8_t *const data, const size_t len, const std::shared_ptr<const void> &owner);
+
+  bool Find(const std::string &op_type, const void *const key, const size_t key_len, const uint8_t *&value,
+            size_t &value_len) const;
+  // bank key由注册的OpBankKeyConvertFun从tiling context得到
+  bool Find(const std::string &op_type, const gert::TilingContext *const context, const uint8_t *&value,
+            size_t &value_len) const;
+
+  // 通过注册的OpBankParseFun把全部记录导出为JSON: [{"op_type", "bank_key", "value"}]
+  ge::graphStatus ExportJson(nlohmann::json &bank_json) const;
+
+  uint64_t GetRecordNum() const {
+    return (header_ == nullptr) ? 0U : header_->record_num;
+  }
+
+  static uint64_t Hash(const char *const op_type, const size_t op_type_len, const void *const key,
+                       const size_t key_len);
+
+ private:
+  std::shared_ptr<const void> owner_;
+  const uint8_t *data_ = nullptr;
+  size_t len_ = 0U;
+  const TuningBankHeader *header_ = nullptr;
+  const TuningBankSlot *slots_ = nullptr;
+  // bank中出现的op type到注册的bank key函数，Load时生成，之后只读；加载时尚未注册的为nullptr
+  std::unordered_map<std::string, const OpBankKeyFuncInfo *> func_infos_;
+};
+}  // namespace tuningtiling
+#endif  // INC_COMMON_TUNING_TUNING_BANK_STORE_H_
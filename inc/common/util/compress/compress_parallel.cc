@@ -0,0 +1,154 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "compress_parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+const size_t VECTOR_SIZE = 16;
+const size_t MIN_BLOCKS_PER_THREAD = 1024;
+
+size_t GetThreadNum(size_t threadNum, size_t taskNum)
+{
+    if (threadNum == 0) {
+        threadNum = std::max(static_cast<size_t>(std::thread::hardware_concurrency()), static_cast<size_t>(1));
+    }
+    return std::max(std::min(threadNum, taskNum), static_cast<size_t>(1));
+}
+
+// runs func(i) for i in [0, taskNum) on threadNum threads, tasks are taken in order by the free threads
+template <typename Func>
+void ParallelFor(size_t taskNum, size_t threadNum, const Func& func)
+{
+    std::atomic<size_t> next(0);
+    auto worker = [&next, taskNum, &func]() {
+        for (size_t i = next++; i < taskNum; i = next++) {
+            func(i);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threadNum; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+}  // namespace
+
+bool IsZeroBlock(const char* block, size_t size)
+{
+    size_t pos = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; pos + VECTOR_SIZE <= size; pos += VECTOR_SIZE) {
+        const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + pos));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(data, zero)) != 0xFFFF) {
+            return false;
+        }
+    }
+#elif defined(__ARM_NEON)
+    for (; pos + VECTOR_SIZE <= size; pos += VECTOR_SIZE) {
+        const uint8x16_t data = vld1q_u8(reinterpret_cast<const uint8_t*>(block + pos));
+        const uint64x2_t lanes = vreinterpretq_u64_u8(data);
+        if ((vgetq_lane_u64(lanes, 0) | vgetq_lane_u64(lanes, 1)) != 0) {
+            return false;
+        }
+    }
+#else
+    for (; pos + sizeof(uint64_t) <= size; pos += sizeof(uint64_t)) {
+        uint64_t data = 0;
+        (void)memcpy(&data, block + pos, sizeof(uint64_t));
+        if (data != 0) {
+            return false;
+        }
+    }
+#endif
+    for (; pos < size; ++pos) {
+        if (block[pos] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t CountZeroBlocks(const char* input, size_t inputSize, size_t blockSize, size_t threadNum)
+{
+    if ((input == nullptr) || (inputSize == 0) || (blockSize == 0)) {
+        return 0;
+    }
+    const size_t blockNum = (inputSize + blockSize - 1) / blockSize;
+    // every thread takes a contiguous range of blocks, small inputs are not worth a thread
+    const size_t rangeNum = GetThreadNum(threadNum, (blockNum + MIN_BLOCKS_PER_THREAD - 1) / MIN_BLOCKS_PER_THREAD);
+    const size_t blocksPerRange = (blockNum + rangeNum - 1) / rangeNum;
+    std::vector<size_t> zeroNums(rangeNum, 0);
+    ParallelFor(rangeNum, rangeNum, [&](size_t range) {
+        const size_t begin = range * blocksPerRange;
+        const size_t end = std::min(begin + blocksPerRange, blockNum);
+        size_t zeroNum = 0;
+        for (size_t i = begin; i < end; ++i) {
+            const size_t offset = i * blockSize;
+            if (IsZeroBlock(input + offset, std::min(blockSize, inputSize - offset))) {
+                ++zeroNum;
+            }
+        }
+        zeroNums[range] = zeroNum;
+    });
+    size_t total = 0;
+    for (const size_t zeroNum : zeroNums) {
+        total += zeroNum;
+    }
+    return total;
+}
+
+CmpStatus CompressWeightsParallel(CompressJob* jobs, size_t jobNum, size_t threadNum)
+{
+    if ((jobs == nullptr) && (jobNum != 0)) {
+        return RET_ERROR;
+    }
+    // the largest weights first so that one of them does not start last
+    std::vector<size_t> order(jobNum);
+    for (size_t i = 0; i < jobNum; ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [jobs](size_t lhs, size_t rhs) {
+        return jobs[lhs].compressConfig.inputSize > jobs[rhs].compressConfig.inputSize;
+    });
+    ParallelFor(jobNum, GetThreadNum(threadNum, jobNum), [jobs, &order](size_t i) {
+        CompressJob& job = jobs[order[i]];
+        job.compressedLength = 0;
+        job.status = CompressWeights(job.input, job.compressConfig, job.indexs, job.output, job.compressedLength);
+    });
+    for (size_t i = 0; i < jobNum; ++i) {
+        if (jobs[i].status != RET_SUCCESS) {
+            return RET_ERROR;
+        }
+    }
+    return RET_SUCCESS;
+}
@@ -0,0 +1,43 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef COMPRESS_PARALLEL_H
+#define COMPRESS_PARALLEL_H
+
+#include <cstddef>
+#include "compress.h"
+
+// one CompressWeights call, every job owns its input, index and output buffers
+struct CompressJob {
+    char* input;
+    CompressConfig compressConfig;
+    char* indexs;
+    char* output;
+    size_t compressedLength; // out
+    CmpStatus status; // out
+};
+
+// true if all bytes of the block are zero, checked 16 bytes at a time with SSE2/NEON when available
+bool IsZeroBlock(const char* block, size_t size);
+
+// number of zero blocks of blockSize bytes (the fractal size), blocks are scanned by threadNum threads,
+// a tail shorter than blockSize counts as one block
+size_t CountZeroBlocks(const char* input, size_t inputSize, size_t blockSize, size_t threadNum);
+
+// runs the jobs on threadNum threads (0: hardware concurrency), jobs are independent so the compressed data of
+// each job is the same as with a serial CompressWeights call; returns RET_ERROR if any job failed
+CmpStatus CompressWeightsParallel(CompressJob* jobs, size_t jobNum, size_t threadNum);
+#endif  // COMPRESS_PARALLEL_H
@@ -0,0 +1,225 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/util/error_manager/deferred_error.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace error_message {
+namespace {
+constexpr size_t kMaxSpecLen = 32U;
+constexpr char_t const *kSpecFlags = "-+ #0";
+constexpr char_t const *kLengthModifiers = "hlLqjzt";
+
+class SpecBuilder {
+ public:
+  void Append(const char_t c) {
+    if (len_ < (kMaxSpecLen - 1U)) {
+      spec_[len_++] = c;
+      spec_[len_] = '\0';
+    }
+  }
+  void Append(const char_t *str) {
+    while (*str != '\0') {
+      Append(*str);
+      ++str;
+    }
+  }
+  const char_t *Get() const {
+    return &spec_[0];
+  }
+
+ private:
+  char_t spec_[kMaxSpecLen] = {'\0'};
+  size_t len_ = 0U;
+};
+
+template <typename T>
+void AppendFormatted(std::string &msg, const char_t *const spec, const int32_t width, const int32_t precision,
+                     const T value) {
+  char_t buf[LIMIT_PER_MESSAGE];
+  int32_t ret;
+  if ((width >= 0) && (precision >= 0)) {
+    ret = std::snprintf(&buf[0], sizeof(buf), spec, width, precision, value);
+  } else if (width >= 0) {
+    ret = std::snprintf(&buf[0], sizeof(buf), spec, width, value);
+  } else if (precision >= 0) {
+    ret = std::snprintf(&buf[0], sizeof(buf), spec, precision, value);
+  } else {
+    ret = std::snprintf(&buf[0], sizeof(buf), spec, value);
+  }
+  if (ret > 0) {
+    (void) msg.append(&buf[0], std::min(static_cast<size_t>(ret), sizeof(buf) - 1U));
+  }
+}
+
+int32_t ArgAsInt(const DeferredErrorRecord &record, size_t &arg_idx) {
+  if (arg_idx >= record.arg_num) {
+    return 0;
+  }
+  const DeferredArg &arg = record.args[arg_idx++];
+  return (arg.type == DeferredArgType::kUnsigned) ? static_cast<int32_t>(arg.value.u)
+                                                  : static_cast<int32_t>(arg.value.i);
+}
+}  // namespace
+
+DeferredErrorContext &DeferredErrorContext::GetThreadInstance() {
+  static thread_local DeferredErrorContext context;
+  return context;
+}
+
+void DeferredErrorContext::FlushFrom(const size_t keep_num, const size_t keep_dropped) {
+  const size_t dropped = (dropped_ > keep_dropped) ? (dropped_ - keep_dropped) : 0U;
+  if ((keep_num >= size_) && (dropped == 0U)) {
+    return;
+  }
+  // reporting may record new errors, so the pending ones are taken out first
+  const auto begin = records_.begin();
+  const std::vector<DeferredErrorRecord> pending(begin + static_cast<std::ptrdiff_t>(std::min(keep_num, size_)),
+                                                 begin + static_cast<std::ptrdiff_t>(size_));
+  Truncate(keep_num, keep_dropped);
+  for (const auto &record : pending) {
+    Report(record);
+  }
+  if (dropped > 0U) {
+    char_t msg[LIMIT_PER_MESSAGE];
+    if (std::snprintf(&msg[0], sizeof(msg), "%zu more deferred errors were dropped, at most %zu are kept", dropped,
+                      kMaxDeferredRecords) > 0) {
+      (void) ErrorManager::GetInstance().ReportInterErrMessage("E19999", std::string(&msg[0]));
+    }
+  }
+}
+
+void DeferredErrorContext::Report(const DeferredErrorRecord &record) const {
+  std::string msg = FormatRecord(record);
+  char_t location[LIMIT_PER_MESSAGE];
+  if (std::snprintf(&location[0], sizeof(location), "[FUNC:%s][FILE:%s][LINE:%zu]", record.func,
+                    TrimPath(record.file), record.line) > 0) {
+    (void) msg.append(&location[0]);
+  }
+  (void) ErrorManager::GetInstance().ReportInterErrMessage(std::string(&record.error_code[0]), msg);
+}
+
+// the arguments were captured by type, so every conversion is rebuilt with the length of the stored value
+std::string DeferredErrorContext::FormatRecord(const DeferredErrorRecord &record) {
+  std::string msg;
+  size_t arg_idx = 0U;
+  const char_t *pos = record.fmt;
+  while (*pos != '\0') {
+    if (*pos != '%') {
+      msg.push_back(*pos++);
+      continue;
+    }
+    ++pos;
+    if (*pos == '%') {
+      msg.push_back(*pos++);
+      continue;
+    }
+
+    SpecBuilder spec;
+    spec.Append('%');
+    while ((*pos != '\0') && (std::strchr(kSpecFlags, *pos) != nullptr)) {
+      spec.Append(*pos++);
+    }
+    int32_t width = -1;
+    if (*pos == '*') {
+      spec.Append(*pos++);
+      width = ArgAsInt(record, arg_idx);
+    } else {
+      while ((*pos >= '0') && (*pos <= '9')) {
+        spec.Append(*pos++);
+      }
+    }
+    int32_t precision = -1;
+    if (*pos == '.') {
+      spec.Append(*pos++);
+      if (*pos == '*') {
+        spec.Append(*pos++);
+        precision = ArgAsInt(record, arg_idx);
+      } else {
+        while ((*pos >= '0') && (*pos <= '9')) {
+          spec.Append(*pos++);
+        }
+      }
+    }
+    while ((*pos != '\0') && (std::strchr(kLengthModifiers, *pos) != nullptr)) {
+      ++pos;
+    }
+    const char_t conversion = *pos;
+    if (conversion == '\0') {
+      break;
+    }
+    ++pos;
+    if (arg_idx >= record.arg_num) {
+      (void) msg.append("<missing>");
+      continue;
+    }
+
+    const DeferredArg &arg = record.args[arg_idx++];
+    switch (conversion) {
+      case 'd':
+      case 'i':
+      case 'u':
+      case 'o':
+      case 'x':
+      case 'X': {
+        spec.Append("ll");
+        spec.Append(conversion);
+        if (arg.type == DeferredArgType::kUnsigned) {
+          AppendFormatted(msg, spec.Get(), width, precision, static_cast<unsigned long long>(arg.value.u));
+        } else {
+          AppendFormatted(msg, spec.Get(), width, precision, static_cast<long long>(arg.value.i));
+        }
+        break;
+      }
+      case 'c':
+        spec.Append(conversion);
+        AppendFormatted(msg, spec.Get(), width, precision, static_cast<int32_t>(arg.value.i));
+        break;
+      case 'f':
+      case 'F':
+      case 'e':
+      case 'E':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A':
+        spec.Append(conversion);
+        AppendFormatted(msg, spec.Get(), width, precision, arg.value.d);
+        break;
+      case 'p':
+        spec.Append(conversion);
+        AppendFormatted(msg, spec.Get(), width, precision, arg.value.p);
+        break;
+      case 's':
+        if (arg.type == DeferredArgType::kString) {
+          // the stored bytes are not terminated, copy them out so that the original spec can be kept
+          char_t str[kDeferredStrStorage + 1U];
+          (void) std::memcpy(&str[0], &record.str_storage[arg.value.str.offset], arg.value.str.len);
+          str[arg.value.str.len] = '\0';
+          spec.Append(conversion);
+          AppendFormatted(msg, spec.Get(), width, precision, static_cast<const char_t *>(&str[0]));
+        }
+        break;
+      default:
+        (void) msg.append("<unsupported>");
+        break;
+    }
+  }
+  return msg;
+}
+}  // namespace error_message
@@ -0,0 +1,251 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEFERRED_ERROR_H_
+#define DEFERRED_ERROR_H_
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include "common/util/error_manager/error_manager.h"
+
+///
+/// @brief Record an inner error without formatting it
+/// The format, the arguments and the source location are kept in a thread local buffer, the message is only
+/// built and reported to ErrorManager by error_message::FlushDeferredErrors(). Use it on recoverable paths
+/// that may fail many times (fuzzy compile, shape mismatch retries) together with DeferredErrorScope.
+/// String arguments are copied at record time, at most kMaxDeferredArgs arguments are supported.
+/// The buffer holds kMaxDeferredRecords records, later ones are only counted and reported as one message.
+/// Records still pending when the thread exits are reported then.
+///
+#define REPORT_INNER_ERROR_DEFERRED(error_code, fmt, ...)                                                            \
+  do {                                                                                                               \
+    if (false) {                                                                                                     \
+      (void) error_message::FormatErrorMessage(nullptr, 0U, fmt, ##__VA_ARGS__);                                     \
+    }                                                                                                                \
+    error_message::DeferredErrorContext::GetThreadInstance().Record((error_code), (fmt), &__FUNCTION__[0],           \
+                                                                    __FILE__, static_cast<size_t>(__LINE__),         \
+                                                                    ##__VA_ARGS__);                                  \
+  } while (false)
+
+namespace error_message {
+constexpr size_t kMaxDeferredArgs = 8U;
+constexpr size_t kMaxDeferredRecords = 32U;
+constexpr size_t kDeferredStrStorage = 256U;
+constexpr size_t kDeferredErrorCodeLen = 16U;
+
+enum class DeferredArgType : uint8_t {
+  kSigned,
+  kUnsigned,
+  kDouble,
+  kPointer,
+  kString
+};
+
+struct DeferredArg {
+  DeferredArgType type;
+  union {
+    int64_t i;
+    uint64_t u;
+    double d;
+    const void *p;
+    struct {
+      uint16_t offset;
+      uint16_t len;
+    } str;
+  } value;
+};
+
+struct DeferredErrorRecord {
+  char_t error_code[kDeferredErrorCodeLen];
+  const char_t *fmt;
+  const char_t *func;
+  const char_t *file;
+  size_t line;
+  size_t arg_num;
+  DeferredArg args[kMaxDeferredArgs];
+  size_t str_used;
+  char_t str_storage[kDeferredStrStorage];
+};
+
+class DeferredErrorContext {
+ public:
+  static DeferredErrorContext &GetThreadInstance();
+
+  template <typename... Args>
+  void Record(const std::string &error_code, const char_t *const fmt, const char_t *const func,
+              const char_t *const file, const size_t line, const Args &... args) {
+    static_assert(sizeof...(Args) <= kMaxDeferredArgs, "too many arguments for REPORT_INNER_ERROR_DEFERRED");
+    if (size_ == kMaxDeferredRecords) {
+      ++dropped_;
+      return;
+    }
+    DeferredErrorRecord &record = records_[size_++];
+    const size_t code_len = std::min(error_code.size(), kDeferredErrorCodeLen - 1U);
+    (void) std::memcpy(&record.error_code[0], error_code.data(), code_len);
+    record.error_code[code_len] = '\0';
+    record.fmt = fmt;
+    record.func = func;
+    record.file = file;
+    record.line = line;
+    record.arg_num = 0U;
+    record.str_used = 0U;
+    const int32_t unused[] = {0, (AddArg(record, args), 0)...};
+    (void) unused;
+  }
+
+  // format the pending records of the current thread and report them to ErrorManager in record order,
+  // must be called before ErrorManager::GetErrorMessage/OutputErrMessage reads the messages
+  void Flush() {
+    FlushFrom(0U, 0U);
+  }
+
+  // report the records and the overflow made after the first keep_num records and keep_dropped overflows and drop
+  // them, the earlier ones stay pending
+  void FlushFrom(const size_t keep_num, const size_t keep_dropped);
+
+  // drop the pending records of the current thread, the failed attempt has been recovered
+  void Discard() {
+    size_ = 0U;
+    dropped_ = 0U;
+  }
+
+  // drop the records and the overflow made after the first keep_num records and keep_dropped overflows
+  void Truncate(const size_t keep_num, const size_t keep_dropped) {
+    size_ = std::min(size_, keep_num);
+    dropped_ = std::min(dropped_, keep_dropped);
+  }
+
+  size_t Size() const {
+    return size_;
+  }
+
+  // records which did not fit in the buffer
+  size_t Dropped() const {
+    return dropped_;
+  }
+
+  static std::string FormatRecord(const DeferredErrorRecord &record);
+
+ private:
+  DeferredErrorContext() = default;
+  // errors of a thread which never read them are not lost
+  ~DeferredErrorContext() {
+    Flush();
+  }
+
+  void Report(const DeferredErrorRecord &record) const;
+
+  template <typename T>
+  static typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+  AddArg(DeferredErrorRecord &record, const T &arg) {
+    DeferredArg &deferred_arg = record.args[record.arg_num++];
+    deferred_arg.type = DeferredArgType::kSigned;
+    deferred_arg.value.i = static_cast<int64_t>(arg);
+  }
+
+  template <typename T>
+  static typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value>::type
+  AddArg(DeferredErrorRecord &record, const T &arg) {
+    DeferredArg &deferred_arg = record.args[record.arg_num++];
+    deferred_arg.type = DeferredArgType::kUnsigned;
+    deferred_arg.value.u = static_cast<uint64_t>(arg);
+  }
+
+  template <typename T>
+  static typename std::enable_if<std::is_enum<T>::value>::type AddArg(DeferredErrorRecord &record, const T &arg) {
+    AddArg(record, static_cast<typename std::underlying_type<T>::type>(arg));
+  }
+
+  template <typename T>
+  static typename std::enable_if<std::is_floating_point<T>::value>::type AddArg(DeferredErrorRecord &record,
+                                                                                const T &arg) {
+    DeferredArg &deferred_arg = record.args[record.arg_num++];
+    deferred_arg.type = DeferredArgType::kDouble;
+    deferred_arg.value.d = static_cast<double>(arg);
+  }
+
+  template <typename T>
+  static typename std::enable_if<std::is_pointer<T>::value &&
+                                 !std::is_same<typename std::decay<typename std::remove_pointer<T>::type>::type,
+                                               char_t>::value>::type
+  AddArg(DeferredErrorRecord &record, const T &arg) {
+    DeferredArg &deferred_arg = record.args[record.arg_num++];
+    deferred_arg.type = DeferredArgType::kPointer;
+    deferred_arg.value.p = static_cast<const void *>(arg);
+  }
+
+  // the string may not outlive the call, so its bytes are copied into the record
+  static void AddArg(DeferredErrorRecord &record, const char_t *const arg) {
+    DeferredArg &deferred_arg = record.args[record.arg_num++];
+    deferred_arg.type = DeferredArgType::kString;
+    const char_t *const str = (arg == nullptr) ? "(null)" : arg;
+    const size_t remain = kDeferredStrStorage - record.str_used;
+    const size_t len = (remain == 0U) ? 0U : strnlen(str, remain - 1U);
+    (void) std::memcpy(&record.str_storage[record.str_used], str, len);
+    deferred_arg.value.str.offset = static_cast<uint16_t>(record.str_used);
+    deferred_arg.value.str.len = static_cast<uint16_t>(len);
+    record.str_used += len;
+  }
+
+  // a full buffer counts new records instead of reporting old ones, so a recovered retry loop never reports its
+  // failures and recording never allocates
+  std::array<DeferredErrorRecord, kMaxDeferredRecords> records_;
+  size_t size_ = 0U;
+  size_t dropped_ = 0U;
+};
+
+inline void FlushDeferredErrors() {
+  DeferredErrorContext::GetThreadInstance().Flush();
+}
+
+///
+/// @brief Errors deferred inside the scope are discarded if the scope is marked recovered, otherwise they are
+/// reported when the scope ends. Records made before the scope started are not affected, so scopes may be nested.
+///
+class DeferredErrorScope {
+ public:
+  DeferredErrorScope()
+      : start_size_(DeferredErrorContext::GetThreadInstance().Size()),
+        start_dropped_(DeferredErrorContext::GetThreadInstance().Dropped()) {}
+
+  ~DeferredErrorScope() {
+    auto &context = DeferredErrorContext::GetThreadInstance();
+    if (recovered_) {
+      context.Truncate(start_size_, start_dropped_);
+      return;
+    }
+    context.FlushFrom(start_size_, start_dropped_);
+  }
+
+  void Recovered() {
+    recovered_ = true;
+  }
+
+  DeferredErrorScope(const DeferredErrorScope &) = delete;
+  DeferredErrorScope &operator=(const DeferredErrorScope &) = delete;
+
+ private:
+  size_t start_size_;
+  size_t start_dropped_;
+  bool recovered_ = false;
+};
+}  // namespace error_message
+#endif  // DEFERRED_ERROR_H_
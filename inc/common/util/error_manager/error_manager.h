@@ -37,6 +37,10 @@ inline std::string TrimPath(const std::string &str) {
   }
   return str;
 }
+inline const char_t *TrimPath(const char_t *const str) {
+  const char_t *const pos = std::strrchr(str, '/');
+  return (pos != nullptr) ? (pos + 1) : str;
+}
 #else
 int32_t FormatErrorMessage(char_t *str_dst, size_t dst_max, const char_t *format, ...);
 inline std::string TrimPath(const std::string &str) {
@@ -45,6 +49,10 @@ inline std::string TrimPath(const std::string &str) {
   }
   return str;
 }
+inline const char_t *TrimPath(const char_t *const str) {
+  const char_t *const pos = std::strrchr(str, '\\');
+  return (pos != nullptr) ? (pos + 1) : str;
+}
 #endif
 }
 
@@ -66,15 +74,16 @@ constexpr size_t const LIMIT_PER_MESSAGE = 1024U;
 #define REPORT_ENV_ERROR(error_code, key, value)                                            \
   ErrorManager::GetInstance().ATCReportErrMessage(error_code, key, value)
 
+// the message is formatted once into a stack buffer and the location is appended behind it
 #define REPORT_INNER_ERROR(error_code, fmt, ...)                                                                       \
   do {                                                                                                                 \
-    std::vector<char> error_string(LIMIT_PER_MESSAGE, '\0');                                                           \
-    if (error_message::FormatErrorMessage(error_string.data(), error_string.size(), fmt, ##__VA_ARGS__) > 0) {         \
-      if (error_message::FormatErrorMessage(error_string.data(), error_string.size(),                                  \
-                                            "%s[FUNC:%s][FILE:%s][LINE:%zu]", error_string.data(),                     \
-                                            &__FUNCTION__[0], error_message::TrimPath(std::string(__FILE__)).c_str(),  \
-                                            static_cast<size_t>(__LINE__)) > 0) {                                      \
-        (void) ErrorManager::GetInstance().ReportInterErrMessage(error_code, std::string(error_string.data()));        \
+    error_message::char_t error_string[LIMIT_PER_MESSAGE];                                                             \
+    const int32_t msg_len = error_message::FormatErrorMessage(&error_string[0], LIMIT_PER_MESSAGE, fmt, ##__VA_ARGS__);\
+    if ((msg_len > 0) && (static_cast<size_t>(msg_len) < LIMIT_PER_MESSAGE)) {                                         \
+      if (error_message::FormatErrorMessage(&error_string[msg_len], LIMIT_PER_MESSAGE - static_cast<size_t>(msg_len),  \
+                                            "[FUNC:%s][FILE:%s][LINE:%zu]", &__FUNCTION__[0],                          \
+                                            error_message::TrimPath(__FILE__), static_cast<size_t>(__LINE__)) > 0) {   \
+        (void) ErrorManager::GetInstance().ReportInterErrMessage(error_code, std::string(&error_string[0]));           \
       }                                                                                                                \
     }                                                                                                                  \
   } while (false)
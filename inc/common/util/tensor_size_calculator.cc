@@ -0,0 +1,94 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/util/tensor_size_calculator.h"
+
+#include <algorithm>
+
+namespace ge {
+constexpr int64_t TensorSizeCalculator::kMemAlignSize;
+constexpr int64_t TensorSizeCalculator::kCubeSize;
+constexpr size_t TensorSizeCalculator::kMaxMemoDimNum;
+constexpr size_t TensorSizeCalculator::kNchwDimNum;
+constexpr size_t TensorSizeCalculator::kNcdhwDimNum;
+
+namespace {
+constexpr size_t kMemoEntryNum = 256U;  // power of 2
+
+struct SizeMemoEntry {
+  uint64_t hash = 0U;
+  int64_t dims[TensorSizeCalculator::kMaxMemoDimNum] = {};
+  uint32_t dim_num = 0U;
+  int32_t format = -1;
+  int32_t data_type = -1;
+  int64_t mem_size = 0;
+};
+
+// direct mapped, a colliding shape simply replaces the entry
+struct SizeMemo {
+  SizeMemoEntry entries[kMemoEntryNum];
+};
+
+uint64_t HashKey(const std::vector<int64_t> &dims, const Format format, const DataType data_type) {
+  uint64_t hash = (static_cast<uint64_t>(static_cast<uint32_t>(format)) << 32U) ^
+                  static_cast<uint64_t>(static_cast<uint32_t>(data_type)) ^ dims.size();
+  for (const int64_t dim : dims) {
+    hash ^= static_cast<uint64_t>(dim) + 0x9e3779b97f4a7c15ULL + (hash << 6U) + (hash >> 2U);
+  }
+  return hash;
+}
+
+bool IsSameKey(const SizeMemoEntry &entry, const uint64_t hash, const std::vector<int64_t> &dims,
+               const Format format, const DataType data_type) {
+  return (entry.hash == hash) && (entry.format == static_cast<int32_t>(format)) &&
+         (entry.data_type == static_cast<int32_t>(data_type)) && (entry.dim_num == dims.size()) &&
+         std::equal(dims.begin(), dims.end(), &entry.dims[0]);
+}
+}  // namespace
+
+graphStatus TensorSizeCalculator::CalcTensorMemorySizeInBytes(const std::vector<int64_t> &dims, const Format format,
+                                                              const DataType data_type, int64_t &mem_size) {
+  if (dims.size() > kMaxMemoDimNum) {
+    int64_t size = 0;
+    if (CalcTensorSize(dims.data(), dims.size(), format, data_type, size) != GRAPH_SUCCESS) {
+      return GRAPH_FAILED;
+    }
+    mem_size = AlignMemSize(size);
+    return GRAPH_SUCCESS;
+  }
+
+  static thread_local SizeMemo memo;
+  const uint64_t hash = HashKey(dims, format, data_type);
+  SizeMemoEntry &entry = memo.entries[hash & (kMemoEntryNum - 1U)];
+  if (IsSameKey(entry, hash, dims, format, data_type)) {
+    mem_size = entry.mem_size;
+    return GRAPH_SUCCESS;
+  }
+
+  int64_t size = 0;
+  if (CalcTensorSize(dims.data(), dims.size(), format, data_type, size) != GRAPH_SUCCESS) {
+    return GRAPH_FAILED;
+  }
+  mem_size = AlignMemSize(size);
+  entry.hash = hash;
+  (void) std::copy(dims.begin(), dims.end(), &entry.dims[0]);
+  entry.dim_num = static_cast<uint32_t>(dims.size());
+  entry.format = static_cast<int32_t>(format);
+  entry.data_type = static_cast<int32_t>(data_type);
+  entry.mem_size = mem_size;
+  return GRAPH_SUCCESS;
+}
+}  // namespace ge
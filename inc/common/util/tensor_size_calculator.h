@@ -0,0 +1,234 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_COMMON_UTIL_TENSOR_SIZE_CALCULATOR_H_
+#define GE_COMMON_UTIL_TENSOR_SIZE_CALCULATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+#include "graph/ge_error_codes.h"
+#include "graph/types.h"
+
+namespace ge {
+// how the padded element count of a format is derived from the origin (NCHW/NCDHW/ND) dims
+enum class TensorSizeRule : uint8_t {
+  kPlain,       // no padding, product of the dims
+  kNc1hwc0,     // N, C1, H, W, C0
+  kNdc1hwc0,    // N, D, C1, H, W, C0
+  kFractalNz,   // batch, N1, M1, 16, C0
+  kUnsupported
+};
+
+namespace tensor_size_detail {
+constexpr uint32_t ElementBitsOf(const DataType data_type) {
+  return (data_type == DT_FLOAT || data_type == DT_INT32 || data_type == DT_UINT32 || data_type == DT_QINT32 ||
+          data_type == DT_COMPLEX32) ? 32U :
+         (data_type == DT_FLOAT16 || data_type == DT_BF16 || data_type == DT_INT16 || data_type == DT_UINT16 ||
+          data_type == DT_QINT16 || data_type == DT_QUINT16) ? 16U :
+         (data_type == DT_INT8 || data_type == DT_UINT8 || data_type == DT_BOOL || data_type == DT_QINT8 ||
+          data_type == DT_QUINT8 || data_type == DT_DUAL_SUB_INT8 || data_type == DT_DUAL_SUB_UINT8) ? 8U :
+         (data_type == DT_INT64 || data_type == DT_UINT64 || data_type == DT_DOUBLE || data_type == DT_COMPLEX64 ||
+          data_type == DT_RESOURCE || data_type == DT_VARIANT) ? 64U :
+         (data_type == DT_COMPLEX128) ? 128U :
+         (data_type == DT_DUAL) ? 40U :
+         (data_type == DT_INT4) ? 4U :
+         (data_type == DT_INT2 || data_type == DT_UINT2) ? 2U :
+         (data_type == DT_UINT1) ? 1U : 0U;
+}
+
+constexpr TensorSizeRule SizeRuleOf(const Format format) {
+  return (format == FORMAT_ND || format == FORMAT_NCHW || format == FORMAT_NHWC || format == FORMAT_HWCN ||
+          format == FORMAT_CHWN || format == FORMAT_NCDHW || format == FORMAT_NDHWC) ? TensorSizeRule::kPlain :
+         (format == FORMAT_NC1HWC0) ? TensorSizeRule::kNc1hwc0 :
+         (format == FORMAT_NDC1HWC0) ? TensorSizeRule::kNdc1hwc0 :
+         (format == FORMAT_FRACTAL_NZ) ? TensorSizeRule::kFractalNz : TensorSizeRule::kUnsupported;
+}
+
+// the tables are generated at compile time from the rules above, the recursion prepends the indexes
+template <size_t N, size_t... Index>
+struct ElementBitsTable : ElementBitsTable<N - 1U, N - 1U, Index...> {};
+
+template <size_t... Index>
+struct ElementBitsTable<0U, Index...> {
+  static constexpr uint8_t kValues[sizeof...(Index)] = {static_cast<uint8_t>(ElementBitsOf(
+      static_cast<DataType>(Index)))...};
+};
+
+template <size_t... Index>
+constexpr uint8_t ElementBitsTable<0U, Index...>::kValues[sizeof...(Index)];
+
+template <size_t N, size_t... Index>
+struct SizeRuleTable : SizeRuleTable<N - 1U, N - 1U, Index...> {};
+
+template <size_t... Index>
+struct SizeRuleTable<0U, Index...> {
+  static constexpr TensorSizeRule kValues[sizeof...(Index)] = {SizeRuleOf(static_cast<Format>(Index))...};
+};
+
+template <size_t... Index>
+constexpr TensorSizeRule SizeRuleTable<0U, Index...>::kValues[sizeof...(Index)];
+
+using ElementBits = ElementBitsTable<static_cast<size_t>(DT_MAX)>;
+using SizeRules = SizeRuleTable<static_cast<size_t>(FORMAT_RESERVED)>;
+}  // namespace tensor_size_detail
+
+/// Table driven size calculation of tensors.
+/// The rules per format and the element width per data type are resolved at compile time, so calls with a
+/// statically known format and data type reduce to a few multiplications. CalcTensorMemorySizeInBytes additionally
+/// keeps a per thread memo of recent (shape, format, data type) results, shapes repeat a lot in memory assignment and
+/// tiling. A GRAPH_FAILED result means the format is not covered by the table or the shape is not static, callers
+/// fall back to TensorUtils then.
+/// NC1HWC0 takes the origin NCHW dims and NDC1HWC0 the origin NCDHW dims, as TensorUtils sizes 4D NC1HWC0 dims.
+/// Dims of another origin format (NHWC, HWCN, ...) must be permuted by the caller first; the calculator cannot tell
+/// them apart from NCHW dims of the same rank. FRACTAL_NZ takes the origin matrix dims, at least 2D. FRACTAL_Z is
+/// sized from its storage shape by TensorUtils and is not covered, neither are formats carrying a sub-format or an
+/// explicit C0.
+class TensorSizeCalculator {
+ public:
+  static constexpr int64_t kMemAlignSize = 32;
+  static constexpr int64_t kCubeSize = 16;
+  static constexpr size_t kMaxMemoDimNum = 8U;
+  static constexpr size_t kNchwDimNum = 4U;
+  static constexpr size_t kNcdhwDimNum = 5U;
+
+  // bits of one element, 0 for types without a fixed size
+  static constexpr uint32_t GetElementBits(const DataType data_type) {
+    return ((data_type >= 0) && (data_type < DT_MAX)) ? tensor_size_detail::ElementBits::kValues[data_type] : 0U;
+  }
+
+  static constexpr TensorSizeRule GetSizeRule(const Format primary_format) {
+    return ((primary_format >= 0) && (primary_format < FORMAT_RESERVED)) ?
+           tensor_size_detail::SizeRules::kValues[primary_format] : TensorSizeRule::kUnsupported;
+  }
+
+  // channel block of the 5D/fractal formats: 32 bytes and at least the cube size
+  static constexpr int64_t GetC0(const DataType data_type) {
+    return (GetElementBits(data_type) == 0U) ? kCubeSize :
+           ((256 / static_cast<int64_t>(GetElementBits(data_type))) > kCubeSize) ?
+           (256 / static_cast<int64_t>(GetElementBits(data_type))) : kCubeSize;
+  }
+
+  static inline bool MulOverflow(const int64_t lhs, const int64_t rhs, int64_t &result) {
+    return __builtin_mul_overflow(lhs, rhs, &result);
+  }
+
+  static inline int64_t CeilDiv(const int64_t value, const int64_t unit) {
+    return (value + unit - 1) / unit;
+  }
+
+  static inline bool IsStatic(const int64_t *const dims, const size_t dim_num) {
+    for (size_t i = 0U; i < dim_num; ++i) {
+      if (dims[i] < 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static inline graphStatus MulAll(const std::initializer_list<int64_t> values, int64_t &count) {
+    count = 1;
+    for (const int64_t value : values) {
+      if (MulOverflow(count, value, count)) {
+        return GRAPH_FAILED;
+      }
+    }
+    return GRAPH_SUCCESS;
+  }
+
+  static inline graphStatus CalcElementCount(const int64_t *const dims, const size_t dim_num, int64_t &count) {
+    count = 1;
+    for (size_t i = 0U; i < dim_num; ++i) {
+      if ((dims[i] < 0) || MulOverflow(count, dims[i], count)) {
+        return GRAPH_FAILED;
+      }
+    }
+    return GRAPH_SUCCESS;
+  }
+
+  static inline graphStatus CalcSizeByElementCount(const int64_t count, const DataType data_type, int64_t &size) {
+    const int64_t bits = static_cast<int64_t>(GetElementBits(data_type));
+    int64_t total_bits = 0;
+    if ((bits == 0) || MulOverflow(count, bits, total_bits)) {
+      return GRAPH_FAILED;
+    }
+    size = CeilDiv(total_bits, 8);
+    return GRAPH_SUCCESS;
+  }
+
+  // element count of a tensor of the origin dims (NCHW/NCDHW order) stored in the format, including the padding of
+  // the format, the switch folds away when the format is a compile time constant
+  static inline graphStatus CalcPaddedElementCount(const int64_t *const dims, const size_t dim_num,
+                                                   const Format format, const DataType data_type, int64_t &count) {
+    // the sub-format changes the fractal layout and the C0 format overrides GetC0, neither is in the table
+    if (HasSubFormat(format) || HasC0Format(format)) {
+      return GRAPH_FAILED;
+    }
+    const int64_t c0 = GetC0(data_type);
+    switch (GetSizeRule(static_cast<Format>(GetPrimaryFormat(format)))) {
+      case TensorSizeRule::kPlain:
+        return CalcElementCount(dims, dim_num, count);
+      case TensorSizeRule::kNc1hwc0:
+        if ((dim_num != kNchwDimNum) || (!IsStatic(dims, dim_num))) {
+          return GRAPH_FAILED;
+        }
+        return MulAll({dims[0U], CeilDiv(dims[1U], c0), dims[2U], dims[3U], c0}, count);
+      case TensorSizeRule::kNdc1hwc0:
+        if ((dim_num != kNcdhwDimNum) || (!IsStatic(dims, dim_num))) {
+          return GRAPH_FAILED;
+        }
+        return MulAll({dims[0U], dims[2U], CeilDiv(dims[1U], c0), dims[3U], dims[4U], c0}, count);
+      case TensorSizeRule::kFractalNz: {
+        // a fractal needs both matrix dims
+        if ((dim_num < 2U) || (!IsStatic(dims, dim_num))) {
+          return GRAPH_FAILED;
+        }
+        const int64_t m = dims[dim_num - 2U];
+        const int64_t n = dims[dim_num - 1U];
+        int64_t batch = 1;
+        if ((dim_num > 2U) && (CalcElementCount(dims, dim_num - 2U, batch) != GRAPH_SUCCESS)) {
+          return GRAPH_FAILED;
+        }
+        return MulAll({batch, CeilDiv(n, c0) * c0, CeilDiv(m, kCubeSize) * kCubeSize}, count);
+      }
+      default:
+        return GRAPH_FAILED;
+    }
+  }
+
+  // bytes of the tensor data in the format, not aligned
+  static inline graphStatus CalcTensorSize(const int64_t *const dims, const size_t dim_num, const Format format,
+                                           const DataType data_type, int64_t &size) {
+    int64_t count = 0;
+    if (CalcPaddedElementCount(dims, dim_num, format, data_type, count) != GRAPH_SUCCESS) {
+      return GRAPH_FAILED;
+    }
+    return CalcSizeByElementCount(count, data_type, size);
+  }
+
+  // CalcTensorSize rounded up to kMemAlignSize plus one kMemAlignSize guard, the size
+  // TensorUtils::GetTensorMemorySizeInBytes reserves, memoized per thread
+  static graphStatus CalcTensorMemorySizeInBytes(const std::vector<int64_t> &dims, const Format format,
+                                                 const DataType data_type, int64_t &mem_size);
+
+  static inline int64_t AlignMemSize(const int64_t size) {
+    return (CeilDiv(size, kMemAlignSize) * kMemAlignSize) + kMemAlignSize;
+  }
+};
+}  // namespace ge
+#endif  // GE_COMMON_UTIL_TENSOR_SIZE_CALCULATOR_H_
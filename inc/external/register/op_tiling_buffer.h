@@ -0,0 +1,219 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INC_EXTERNAL_REGISTER_OP_TILING_BUFFER_H_
+#define INC_EXTERNAL_REGISTER_OP_TILING_BUFFER_H_
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <vector>
+#include "external/register/op_tiling_info.h"
+
+namespace optiling {
+/**
+ * 定长连续的tiling data缓冲区，用于替代基于std::stringstream的ByteBuffer
+ * 缓冲区不持有内存，内存来自TilingArena或者OpRunInfo的args区域（见BindRunInfo），写入即落在最终位置，无中间拷贝；
+ * 写入超过容量时不再写入并置fail，与stream的行为一致
+ */
+class TilingBuffer {
+ public:
+  TilingBuffer() = default;
+  TilingBuffer(void *const data, const size_t capacity) {
+    Reset(data, capacity);
+  }
+
+  void Reset(void *const data, const size_t capacity) {
+    data_ = static_cast<uint8_t *>(data);
+    capacity_ = (data == nullptr) ? 0U : capacity;
+    size_ = 0U;
+    read_pos_ = 0U;
+    fail_ = false;
+  }
+
+  TilingBuffer &write(const ge::char_t *const value, const size_t len) {
+    if (fail_ || (len > (capacity_ - size_))) {
+      fail_ = true;
+      return *this;
+    }
+    if (len > 0U) {
+      (void) memcpy(data_ + size_, value, len);
+      size_ += len;
+    }
+    return *this;
+  }
+
+  TilingBuffer &read(ge::char_t *const value, const size_t len) {
+    if (fail_ || (len > (size_ - read_pos_))) {
+      fail_ = true;
+      return *this;
+    }
+    if (len > 0U) {
+      (void) memcpy(value, data_ + read_pos_, len);
+      read_pos_ += len;
+    }
+    return *this;
+  }
+
+  // nothing is buffered, kept for source compatibility with ByteBuffer
+  TilingBuffer &flush() {
+    return *this;
+  }
+
+  // 按字节写入value的内存表示，与ByteBufferPut相同；不同于stringstream的operator<<，不做文本格式化
+  template<typename T>
+  TilingBuffer &Append(const T &value) {
+    return write(reinterpret_cast<const ge::char_t *>(&value), sizeof(T));
+  }
+
+  bool good() const {
+    return !fail_;
+  }
+  bool fail() const {
+    return fail_;
+  }
+  // drops the data written and the fail state, the memory is kept
+  void clear() {
+    size_ = 0U;
+    read_pos_ = 0U;
+    fail_ = false;
+  }
+
+  const uint8_t *GetData() const {
+    return data_;
+  }
+  size_t GetDataSize() const {
+    return size_;
+  }
+  // 已写入但尚未被read读取的长度
+  size_t GetReadableSize() const {
+    return size_ - read_pos_;
+  }
+  size_t GetCapacity() const {
+    return capacity_;
+  }
+
+  /**
+   * 把缓冲区绑定到run_info的args区域（GetAddrBase），之后的写入直接落在args区域，写完调用CommitRunInfo
+   * @return args区域为空时返回false
+   */
+  bool BindRunInfo(const utils::OpRunInfo &run_info) {
+    uint64_t max_size = 0U;
+    void *const addr_base = run_info.GetAddrBase(max_size);
+    Reset(addr_base, static_cast<size_t>(max_size));
+    return addr_base != nullptr;
+  }
+  // 把写入的长度同步给绑定的run_info
+  void CommitRunInfo(utils::OpRunInfo &run_info) const {
+    run_info.SetAddrBaseOffset(static_cast<uint64_t>(size_));
+  }
+
+ private:
+  uint8_t *data_ = nullptr;
+  size_t capacity_ = 0U;
+  size_t size_ = 0U;
+  size_t read_pos_ = 0U;
+  bool fail_ = false;
+};
+
+/**
+ * 执行器级别的tiling内存池，按块分配，每个step开始时Reset复用全部内存，稳态下不再申请堆内存
+ * 非线程安全，每个执行器持有一个
+ */
+class TilingArena {
+ public:
+  static constexpr size_t kDefaultBlockSize = 64U * 1024U;
+  static constexpr size_t kAlignSize = 8U;
+
+  explicit TilingArena(const size_t block_size = kDefaultBlockSize) : block_size_(block_size) {}
+  ~TilingArena() = default;
+  TilingArena(const TilingArena &) = delete;
+  TilingArena &operator=(const TilingArena &) = delete;
+
+  /**
+   * 分配容量为capacity的缓冲区，有效期到下一次Reset
+   * @return 申请内存失败时返回容量为0的缓冲区，写入会置fail
+   */
+  TilingBuffer Allocate(const size_t capacity) {
+    const size_t aligned = ((capacity + kAlignSize) - 1U) & ~(kAlignSize - 1U);
+    while ((block_index_ < blocks_.size()) && (aligned > (blocks_[block_index_].size - offset_))) {
+      ++block_index_;
+      offset_ = 0U;
+    }
+    if (block_index_ == blocks_.size()) {
+      const size_t size = (aligned > block_size_) ? aligned : block_size_;
+      std::unique_ptr<uint8_t[]> memory(new (std::nothrow) uint8_t[size]);
+      if (memory == nullptr) {
+        return TilingBuffer();
+      }
+      blocks_.push_back({std::move(memory), size});
+      offset_ = 0U;
+    }
+    uint8_t *const data = blocks_[block_index_].memory.get() + offset_;
+    offset_ += aligned;
+    return TilingBuffer(data, capacity);
+  }
+
+  void Reset() {
+    block_index_ = 0U;
+    offset_ = 0U;
+  }
+
+  size_t GetTotalSize() const {
+    size_t total = 0U;
+    for (const auto &block : blocks_) {
+      total += block.size;
+    }
+    return total;
+  }
+
+ private:
+  struct Block {
+    std::unique_ptr<uint8_t[]> memory;
+    size_t size;
+  };
+  std::vector<Block> blocks_;
+  size_t block_size_;
+  size_t block_index_ = 0U;
+  size_t offset_ = 0U;
+};
+
+template<class T>
+TilingBuffer &ByteBufferPut(TilingBuffer &buf, const T &buffer_value) {
+  return buf.write(reinterpret_cast<const ge::char_t *>(&buffer_value), sizeof(buffer_value));
+}
+
+template<class T>
+TilingBuffer &ByteBufferGet(TilingBuffer &buf, T &buffer_value) {
+  return buf.read(reinterpret_cast<ge::char_t *>(&buffer_value), sizeof(buffer_value));
+}
+
+inline TilingBuffer &ByteBufferPut(TilingBuffer &buf, const uint8_t *data, size_t data_len) {
+  return buf.write(reinterpret_cast<const ge::char_t *>(data), data_len);
+}
+
+// 与ByteBuffer版本的readsome循环一致：从当前读位置读取，并推进读位置
+inline size_t ByteBufferGetAll(TilingBuffer &buf, ge::char_t *dest, size_t dest_len) {
+  if (buf.fail() || (dest == nullptr)) {
+    return 0U;
+  }
+  const size_t len = (buf.GetReadableSize() < dest_len) ? buf.GetReadableSize() : dest_len;
+  (void) buf.read(dest, len);
+  return len;
+}
+}  // namespace optiling
+#endif  // INC_EXTERNAL_REGISTER_OP_TILING_BUFFER_H_
@@ -0,0 +1,193 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INC_EXTERNAL_REGISTER_OP_TILING_DISPATCH_H_
+#define INC_EXTERNAL_REGISTER_OP_TILING_DISPATCH_H_
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "external/register/op_tiling_registry.h"
+
+namespace optiling {
+enum class TilingFuncVersion : uint32_t {
+  kNone = 0U,
+  kV1 = 1U,
+  kV2 = 2U,
+  kV3 = 3U,
+  kV4 = 4U
+};
+
+using OpTilingRawFunc = bool (*)(const TeOpParas &, const OpCompileInfo &, OpRunInfo &);
+using OpTilingRawFuncV2 = bool (*)(const ge::Operator &, const OpCompileInfoV2 &, OpRunInfoV2 &);
+using OpTilingRawFuncV3 = bool (*)(const ge::Operator &, const void *, OpRunInfoV2 &);
+using OpTilingRawFuncV4 = bool (*)(const ge::Operator &, const CompileInfoPtr, OpRunInfoV2 &);
+
+/**
+ * 冻结后的一个op type的tiling入口，版本在冻结时判定一次；注册的函数为普通函数时直接保存函数指针，
+ * 调用时不再经过std::function
+ */
+class OpTilingEntry {
+ public:
+  OpTilingEntry() = default;
+  explicit OpTilingEntry(OpTilingFuncInfo &func_info) : func_info_(func_info) {
+    if (func_info_.IsFunctionV4()) {
+      version_ = TilingFuncVersion::kV4;
+      const auto raw_func = func_info_.GetOpTilingFuncV4().target<OpTilingRawFuncV4>();
+      raw_func_v4_ = (raw_func == nullptr) ? nullptr : *raw_func;
+    } else if (func_info_.IsFunctionV3()) {
+      version_ = TilingFuncVersion::kV3;
+      const auto raw_func = func_info_.GetOpTilingFuncV3().target<OpTilingRawFuncV3>();
+      raw_func_v3_ = (raw_func == nullptr) ? nullptr : *raw_func;
+    } else if (func_info_.IsFunctionV2()) {
+      version_ = TilingFuncVersion::kV2;
+      const auto raw_func = func_info_.GetOpTilingFuncV2().target<OpTilingRawFuncV2>();
+      raw_func_v2_ = (raw_func == nullptr) ? nullptr : *raw_func;
+    } else if (func_info_.IsFunctionV1()) {
+      version_ = TilingFuncVersion::kV1;
+      const auto raw_func = func_info_.GetOpTilingFunc().target<OpTilingRawFunc>();
+      raw_func_v1_ = (raw_func == nullptr) ? nullptr : *raw_func;
+    } else {
+      version_ = TilingFuncVersion::kNone;
+    }
+  }
+
+  TilingFuncVersion GetVersion() const {
+    return version_;
+  }
+  const std::string &GetOpType() const {
+    return func_info_.GetOpType();
+  }
+  // V3/V4的编译信息解析只在加载时调用，不在热路径上
+  OpTilingFuncInfo &GetFuncInfo() {
+    return func_info_;
+  }
+
+  bool Call(const TeOpParas &op_paras, const OpCompileInfo &compile_info, OpRunInfo &run_info) {
+    return (raw_func_v1_ != nullptr) ? raw_func_v1_(op_paras, compile_info, run_info) :
+                                       func_info_.GetOpTilingFunc()(op_paras, compile_info, run_info);
+  }
+  bool Call(const ge::Operator &op, const OpCompileInfoV2 &compile_info, OpRunInfoV2 &run_info) {
+    return (raw_func_v2_ != nullptr) ? raw_func_v2_(op, compile_info, run_info) :
+                                       func_info_.GetOpTilingFuncV2()(op, compile_info, run_info);
+  }
+  bool Call(const ge::Operator &op, const void *const compile_info, OpRunInfoV2 &run_info) {
+    return (raw_func_v3_ != nullptr) ? raw_func_v3_(op, compile_info, run_info) :
+                                       func_info_.GetOpTilingFuncV3()(op, compile_info, run_info);
+  }
+  bool Call(const ge::Operator &op, const CompileInfoPtr &compile_info, OpRunInfoV2 &run_info) {
+    return (raw_func_v4_ != nullptr) ? raw_func_v4_(op, compile_info, run_info) :
+                                       func_info_.GetOpTilingFuncV4()(op, compile_info, run_info);
+  }
+
+ private:
+  OpTilingFuncInfo func_info_;
+  TilingFuncVersion version_ = TilingFuncVersion::kNone;
+  OpTilingRawFunc raw_func_v1_ = nullptr;
+  OpTilingRawFuncV2 raw_func_v2_ = nullptr;
+  OpTilingRawFuncV3 raw_func_v3_ = nullptr;
+  OpTilingRawFuncV4 raw_func_v4_ = nullptr;
+};
+
+/**
+ * 按op type id索引的tiling分发表
+ * 插件加载完成后调用Freeze，把OpTilingFuncRegistry::RegisteredOpFuncInfo()中的注册信息按op type排序后拷贝成连续表；
+ * 执行器构建时每个节点调用GetOpTypeId解析一次id并保存GetEntry的结果，执行时不再做字符串哈希查找
+ * Freeze之后表不再改变，查询无需加锁；再次加载插件后需要重新Freeze，已解析的入口在重新Freeze前保持有效
+ */
+class OpTilingDispatchTable {
+ public:
+  static constexpr uint32_t kInvalidOpTypeId = UINT32_MAX;
+
+  static OpTilingDispatchTable &Instance() {
+    static OpTilingDispatchTable instance;
+    return instance;
+  }
+
+  void Freeze() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    auto &registered = OpTilingFuncRegistry::RegisteredOpFuncInfo();
+    std::vector<std::string> op_types;
+    op_types.reserve(registered.size());
+    for (const auto &func_info : registered) {
+      op_types.emplace_back(func_info.first);
+    }
+    std::sort(op_types.begin(), op_types.end());
+    auto table = std::make_shared<Table>();
+    table->entries.reserve(op_types.size());
+    for (const auto &op_type : op_types) {
+      table->ids[op_type] = static_cast<uint32_t>(table->entries.size());
+      table->entries.emplace_back(registered[op_type]);
+    }
+    // entries resolved from the previous table stay valid while the previous table is kept
+    if (table_ != nullptr) {
+      retired_tables_.emplace_back(table_);
+    }
+    table_ = table;
+    frozen_table_.store(table.get(), std::memory_order_release);
+  }
+
+  bool IsFrozen() const {
+    return frozen_table_.load(std::memory_order_acquire) != nullptr;
+  }
+
+  uint32_t GetOpTypeId(const std::string &op_type) const {
+    const Table *const table = frozen_table_.load(std::memory_order_acquire);
+    if (table == nullptr) {
+      return kInvalidOpTypeId;
+    }
+    const auto iter = table->ids.find(op_type);
+    return (iter == table->ids.end()) ? kInvalidOpTypeId : iter->second;
+  }
+
+  // nullptr when not frozen or the id is invalid
+  OpTilingEntry *GetEntry(const uint32_t op_type_id) const {
+    Table *const table = frozen_table_.load(std::memory_order_acquire);
+    if ((table == nullptr) || (op_type_id >= table->entries.size())) {
+      return nullptr;
+    }
+    return &table->entries[op_type_id];
+  }
+
+  OpTilingEntry *GetEntry(const std::string &op_type) const {
+    return GetEntry(GetOpTypeId(op_type));
+  }
+
+  size_t GetEntryNum() const {
+    const Table *const table = frozen_table_.load(std::memory_order_acquire);
+    return (table == nullptr) ? 0U : table->entries.size();
+  }
+
+ private:
+  struct Table {
+    std::vector<OpTilingEntry> entries;
+    std::unordered_map<std::string, uint32_t> ids;
+  };
+
+  OpTilingDispatchTable() = default;
+  ~OpTilingDispatchTable() = default;
+
+  std::mutex mutex_;
+  std::shared_ptr<Table> table_;
+  std::vector<std::shared_ptr<Table>> retired_tables_;
+  std::atomic<Table *> frozen_table_{nullptr};
+};
+}  // namespace optiling
+#endif  // INC_EXTERNAL_REGISTER_OP_TILING_DISPATCH_H_
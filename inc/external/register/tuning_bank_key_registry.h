@@ -64,7 +64,7 @@
     len = sizeof(bank_key);                                                                                            \
     TUNING_TILING_MAKE_SHARED(in_args = std::make_shared<bank_key>(), return false);                                   \
     auto op_ky = std::static_pointer_cast<bank_key>(in_args);                                                          \
-    *op_ky = bank_key_json.get<bank_key>();                                                                            \
+    (void)bank_key_json.get_to(*op_ky);                                                                                \
     return true;                                                                                                       \
   }                                                                                                                    \
   REGISTER_OP_BANK_KEY_PARSE_FUN(op, ParseFunc##op##bank_key, LoadFunc##op##bank_key);
@@ -21,6 +21,7 @@
 #include <mutex>
 #include "toolchain/prof_common.h"
 #include "toolchain/prof_api.h"
+#include "common/runtime/sampled_memory_tracer.h"
 
 namespace gert {
   struct MemoryRecorder {
@@ -41,6 +42,17 @@ namespace gert {
     static void ReduceTotalAllocateMemory(const uint64_t &num) { total_allocate_memory_ -= num; }
     static void ClearReserveMemory() { total_reserve_memory_.store(0UL); }
     static void SetRecorder(const void *const addr, const int64_t size);
+    // sampled, lock free alternative of SetRecorder, events are aggregated by SampledMemoryTracer::Collect.
+    // always inlined, so the site is the return address of the allocating function, i.e. its caller.
+    // the allocators in the closed runtime library still call SetRecorder, their allocations are traced once they
+    // are switched over
+    GERT_TRACE_ALWAYS_INLINE static void TraceRecorder(const void *const addr, const int64_t size) {
+      if (SampledMemoryTracer::IsEnabled()) {
+        SampledMemoryTracer::Record(addr, size, total_allocate_memory_.load(std::memory_order_relaxed),
+                                    total_reserve_memory_.load(std::memory_order_relaxed),
+                                    GERT_TRACE_RETURN_ADDRESS());
+      }
+    }
     static const MemoryRecorder GetRecorder();
     static bool IsRecorderEmpty();
    private:
@@ -0,0 +1,303 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2023. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AIR_CXX_STREAM_EXECUTOR_TABLE_H
+#define AIR_CXX_STREAM_EXECUTOR_TABLE_H
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+#include "runtime/base.h"
+#include "stream_executor.h"
+
+namespace gert {
+/**
+ * 一个stream的已加载executor及其读者计数，地址在所属StreamExecutorTable析构前保持不变
+ * 读者先增加readers再读取executor，删除者先把executor置空再等待readers归零（均为seq_cst），
+ * 因此删除者等待结束后不会再有读者持有该executor
+ */
+struct StreamExecutorEntry {
+  std::atomic<ModelV2Executor *> executor{nullptr};
+  std::atomic<uint32_t> readers{0U};
+};
+
+/**
+ * stream到已加载executor的读多写少查找表
+ * Find无锁、不分配内存，可与Insert/Remove并发；Insert/Remove需要调用者串行化（CachedStreamExecutor在mutex_下调用）
+ * 开放寻址表，stream key插入后不删除，Remove只把executor置空，同一stream再次插入时复用原entry；
+ * 装载率超过1/2时重建并发布新表（同时清理被Remove的stream），旧表与entry可能仍有读者在访问，因此保留到本对象析构
+ */
+class StreamExecutorTable {
+ public:
+  StreamExecutorTable() {
+    (void)Rehash(nullptr);
+  }
+  StreamExecutorTable(const StreamExecutorTable &) = delete;
+  StreamExecutorTable &operator=(const StreamExecutorTable &) = delete;
+  ~StreamExecutorTable() = default;
+
+  StreamExecutorEntry *Find(const rtStream_t stream) {
+    if (stream == nullptr) {
+      return &null_stream_entry_;
+    }
+    const Table *const table = table_.load(std::memory_order_acquire);
+    if (table == nullptr) {
+      return nullptr;
+    }
+    const size_t mask = table->capacity - 1U;
+    for (size_t index = HashStream(stream) & mask;; index = (index + 1U) & mask) {
+      const Slot &slot = table->slots[index];
+      const rtStream_t key = slot.stream.load(std::memory_order_acquire);
+      if (key == stream) {
+        return slot.entry.load(std::memory_order_acquire);
+      }
+      if (key == nullptr) {
+        return nullptr;
+      }
+    }
+  }
+
+  // 返回发布executor的entry，分配失败时返回nullptr
+  StreamExecutorEntry *Insert(const rtStream_t stream, ModelV2Executor *const executor) {
+    if (stream == nullptr) {
+      null_stream_entry_.executor.store(executor, std::memory_order_seq_cst);
+      return &null_stream_entry_;
+    }
+    Table *table = table_.load(std::memory_order_relaxed);
+    if ((table == nullptr) || (((table->used + 1U) * 2U) > table->capacity)) {
+      table = Rehash(table);
+      if (table == nullptr) {
+        return nullptr;
+      }
+    }
+    Slot &slot = FindSlot(*table, stream);
+    StreamExecutorEntry *entry = slot.entry.load(std::memory_order_relaxed);
+    if (entry == nullptr) {
+      entry = new (std::nothrow) StreamExecutorEntry();
+      if (entry == nullptr) {
+        return nullptr;
+      }
+      entries_.emplace_back(entry);
+      ++table->used;
+    }
+    // executor与entry先于key发布，读者看到key时二者已经可见
+    entry->executor.store(executor, std::memory_order_seq_cst);
+    slot.entry.store(entry, std::memory_order_release);
+    slot.stream.store(stream, std::memory_order_release);
+    return entry;
+  }
+
+  // 取消发布，返回的entry上仍可能有读者，销毁executor前需要WaitReaders
+  StreamExecutorEntry *Remove(const rtStream_t stream) {
+    StreamExecutorEntry *const entry = Find(stream);
+    if (entry != nullptr) {
+      entry->executor.store(nullptr, std::memory_order_seq_cst);
+    }
+    return entry;
+  }
+
+  static void WaitReaders(const StreamExecutorEntry &entry) {
+    while (entry.readers.load(std::memory_order_seq_cst) != 0U) {
+      std::this_thread::yield();
+    }
+  }
+
+ private:
+  static constexpr size_t kInitCapacity = 16U;
+  struct Slot {
+    std::atomic<rtStream_t> stream{nullptr};
+    std::atomic<StreamExecutorEntry *> entry{nullptr};
+  };
+  struct Table {
+    explicit Table(const size_t cap) : capacity(cap), slots(new (std::nothrow) Slot[cap]) {}
+    size_t capacity;
+    size_t used = 0U;  // 已占用的key数，包括executor已被Remove的
+    std::unique_ptr<Slot[]> slots;
+  };
+
+  static size_t HashStream(const rtStream_t stream) {
+    // stream句柄按对齐分配，低位区分度差，乘法散列后取高位
+    constexpr uint64_t kGoldenRatio = 0x9E3779B97F4A7C15UL;
+    constexpr uint32_t kHashShift = 32U;
+    const uint64_t hash = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(stream)) * kGoldenRatio;
+    return static_cast<size_t>(hash >> kHashShift);
+  }
+
+  static Slot &FindSlot(Table &table, const rtStream_t stream) {
+    const size_t mask = table.capacity - 1U;
+    for (size_t index = HashStream(stream) & mask;; index = (index + 1U) & mask) {
+      const rtStream_t key = table.slots[index].stream.load(std::memory_order_relaxed);
+      if ((key == stream) || (key == nullptr)) {
+        return table.slots[index];
+      }
+    }
+  }
+
+  static bool IsLive(const Slot &slot) {
+    const StreamExecutorEntry *const entry = slot.entry.load(std::memory_order_relaxed);
+    return (entry != nullptr) && (entry->executor.load(std::memory_order_relaxed) != nullptr);
+  }
+
+  // 只迁移executor非空的槽位，被Remove的stream在这里被清理
+  Table *Rehash(const Table *const old_table) {
+    const size_t old_capacity = (old_table == nullptr) ? 0U : old_table->capacity;
+    size_t live = 1U;
+    for (size_t i = 0U; i < old_capacity; ++i) {
+      live += IsLive(old_table->slots[i]) ? 1U : 0U;
+    }
+    size_t capacity = kInitCapacity;
+    while ((live * 4U) > capacity) {
+      capacity <<= 1U;
+    }
+    std::unique_ptr<Table> table(new (std::nothrow) Table(capacity));
+    if ((table == nullptr) || (table->slots == nullptr)) {
+      return nullptr;
+    }
+    for (size_t i = 0U; i < old_capacity; ++i) {
+      if (!IsLive(old_table->slots[i])) {
+        continue;
+      }
+      const rtStream_t stream = old_table->slots[i].stream.load(std::memory_order_relaxed);
+      Slot &slot = FindSlot(*table, stream);
+      slot.stream.store(stream, std::memory_order_relaxed);
+      slot.entry.store(old_table->slots[i].entry.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      ++table->used;
+    }
+    Table *const raw = table.get();
+    tables_.emplace_back(std::move(table));
+    table_.store(raw, std::memory_order_release);
+    return raw;
+  }
+
+  std::atomic<Table *> table_{nullptr};
+  StreamExecutorEntry null_stream_entry_;
+  std::vector<std::unique_ptr<Table>> tables_;
+  std::vector<std::unique_ptr<StreamExecutorEntry>> entries_;
+};
+
+/**
+ * CachedStreamExecutor::GetOrCreateLoaded返回的executor引用，持有期间该executor不会被Erase销毁
+ * 只能在执行期间短暂持有，同一线程持有时调用Erase会一直等待
+ */
+class LoadedExecutorRef {
+ public:
+  LoadedExecutorRef() = default;
+  LoadedExecutorRef(LoadedExecutorRef &&other) noexcept : entry_(other.entry_), executor_(other.executor_) {
+    other.entry_ = nullptr;
+    other.executor_ = nullptr;
+  }
+  LoadedExecutorRef &operator=(LoadedExecutorRef &&other) noexcept {
+    if (this != &other) {
+      Release();
+      entry_ = other.entry_;
+      executor_ = other.executor_;
+      other.entry_ = nullptr;
+      other.executor_ = nullptr;
+    }
+    return *this;
+  }
+  LoadedExecutorRef(const LoadedExecutorRef &) = delete;
+  LoadedExecutorRef &operator=(const LoadedExecutorRef &) = delete;
+  ~LoadedExecutorRef() {
+    Release();
+  }
+
+  ModelV2Executor *Get() const {
+    return executor_;
+  }
+  ModelV2Executor *operator->() const {
+    return executor_;
+  }
+  explicit operator bool() const {
+    return executor_ != nullptr;
+  }
+
+ private:
+  friend class CachedStreamExecutor;
+  // 先登记读者再读取executor，与Remove的先置空再等待配对
+  static LoadedExecutorRef Acquire(StreamExecutorEntry *const entry) {
+    LoadedExecutorRef ref;
+    if (entry == nullptr) {
+      return ref;
+    }
+    (void)entry->readers.fetch_add(1U, std::memory_order_seq_cst);
+    ModelV2Executor *const executor = entry->executor.load(std::memory_order_seq_cst);
+    if (executor == nullptr) {
+      (void)entry->readers.fetch_sub(1U, std::memory_order_release);
+      return ref;
+    }
+    ref.entry_ = entry;
+    ref.executor_ = executor;
+    return ref;
+  }
+  void Release() {
+    if (entry_ != nullptr) {
+      (void)entry_->readers.fetch_sub(1U, std::memory_order_release);
+      entry_ = nullptr;
+      executor_ = nullptr;
+    }
+  }
+
+  StreamExecutorEntry *entry_ = nullptr;
+  ModelV2Executor *executor_ = nullptr;
+};
+
+/**
+ * StreamExecutor的调用侧缓存，不改变StreamExecutor的布局与导出符号
+ * 命中时无锁返回已加载executor的引用，未命中时经StreamExecutor::GetOrCreateLoaded加载后发布；
+ * Erase先取消发布，再等待已取得的引用全部释放，之后才调用StreamExecutor::Erase销毁executor；
+ * 使用本缓存时，stream必须经本类的Erase删除，直接调用StreamExecutor::Erase会销毁仍被引用的executor
+ */
+class CachedStreamExecutor {
+ public:
+  explicit CachedStreamExecutor(StreamExecutor &stream_executor) : stream_executor_(stream_executor) {}
+  CachedStreamExecutor(const CachedStreamExecutor &) = delete;
+  CachedStreamExecutor &operator=(const CachedStreamExecutor &) = delete;
+
+  // 加载失败时返回空引用
+  LoadedExecutorRef GetOrCreateLoaded(rtStream_t stream, const ModelExecuteArg &arg) {
+    LoadedExecutorRef ref = LoadedExecutorRef::Acquire(loaded_executors_.Find(stream));
+    if (ref) {
+      return ref;
+    }
+    // 加载与发布在同一把锁下，避免与Erase交错时发布已销毁的executor
+    const std::lock_guard<std::mutex> lock(mutex_);
+    ModelV2Executor *const executor = stream_executor_.GetOrCreateLoaded(stream, arg);
+    if (executor == nullptr) {
+      return ref;
+    }
+    // 发布失败时无法登记读者，按加载失败处理
+    return LoadedExecutorRef::Acquire(loaded_executors_.Insert(stream, executor));
+  }
+  ge::graphStatus Erase(rtStream_t stream) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    const StreamExecutorEntry *const entry = loaded_executors_.Remove(stream);
+    if (entry != nullptr) {
+      StreamExecutorTable::WaitReaders(*entry);
+    }
+    return stream_executor_.Erase(stream);
+  }
+
+ private:
+  StreamExecutor &stream_executor_;
+  std::mutex mutex_;
+  StreamExecutorTable loaded_executors_;
+};
+}  // namespace gert
+#endif  // AIR_CXX_STREAM_EXECUTOR_TABLE_H
@@ -17,6 +17,7 @@
 #ifndef INC_GRAPH_OP_KERNEL_BIN_H_
 #define INC_GRAPH_OP_KERNEL_BIN_H_
 
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -27,18 +28,26 @@ namespace ge {
 class OpKernelBin {
  public:
   OpKernelBin(const std::string &name, std::vector<char> &&data) : name_(name), data_(std::move(data)) {}
+  // refers to len bytes at data instead of copying them, owner keeps the bytes alive
+  OpKernelBin(const std::string &name, const uint8_t *const data, const size_t len, std::shared_ptr<const void> owner)
+      : name_(name), view_data_(data), view_len_(len), owner_(std::move(owner)) {}
 
   ~OpKernelBin() = default;
 
   const std::string &GetName() const { return name_; }
-  const uint8_t *GetBinData() const { return ge::PtrToPtr<const char_t, const uint8_t>(data_.data()); }
-  size_t GetBinDataSize() const { return data_.size(); }
+  const uint8_t *GetBinData() const {
+    return (owner_ != nullptr) ? view_data_ : ge::PtrToPtr<const char_t, const uint8_t>(data_.data());
+  }
+  size_t GetBinDataSize() const { return (owner_ != nullptr) ? view_len_ : data_.size(); }
   OpKernelBin(const OpKernelBin &) = delete;
   const OpKernelBin &operator=(const OpKernelBin &) = delete;
 
  private:
   std::string name_;
   std::vector<char> data_;
+  const uint8_t *view_data_ = nullptr;
+  size_t view_len_ = 0U;
+  std::shared_ptr<const void> owner_;
 };
 
 using OpKernelBinPtr = std::shared_ptr<OpKernelBin>;
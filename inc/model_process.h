@@ -9,9 +9,21 @@
 */
 #pragma once
 #include <iostream>
+#include <map>
+#include <vector>
 #include "utils.h"
 #include "acl/acl.h"
 
+typedef enum BufferLocation {
+    BUFFER_DEVICE = 0,
+    BUFFER_PINNED_HOST = 1
+} BufferLocation;
+
+struct UserBuffer {
+    void *data;
+    size_t size;
+};
+
 class ModelProcess {
 public:
     /**
@@ -92,6 +104,36 @@ public:
     */
     Result Execute();
 
+    /**
+    * @brief register long-lived user buffers for all inputs and outputs, the datasets are built once
+    * @param [in] inputBuffers: one buffer per model input
+    * @param [in] outputBuffers: one buffer per model output
+    * @param [in] location: device memory, or host memory from aclrtMallocHost
+    * @param [out] bindingId: handle of the registered buffers
+    * @return result
+    */
+    Result RegisterBuffers(const std::vector<UserBuffer> &inputBuffers, const std::vector<UserBuffer> &outputBuffers,
+                           BufferLocation location, uint32_t &bindingId);
+
+    /**
+    * @brief model execute with registered buffers, no dataset is created
+    * @param [in] bindingId: handle returned by RegisterBuffers
+    * @return result
+    */
+    Result ExecuteBinding(uint32_t bindingId);
+
+    /**
+    * @brief release the datasets of registered buffers, the user buffers are not freed
+    * @param [in] bindingId: handle returned by RegisterBuffers
+    * @return result
+    */
+    Result UnregisterBuffers(uint32_t bindingId);
+
+    /**
+    * @brief release all registered buffers, call before UnloadModel
+    */
+    void UnregisterAllBuffers();
+
     /**
     * @brief dump model output result to file
     */
@@ -127,5 +169,19 @@ private:
     aclmdlDesc *modelDesc_;
     aclmdlDataset *input_;
     aclmdlDataset *output_;
+
+    struct BufferBinding {
+        aclmdlDataset *input;
+        aclmdlDataset *output;
+        // host buffers mirrored on device when the host memory is not visible to the device (ACL_HOST run mode)
+        std::vector<UserBuffer> hostInputs;
+        std::vector<UserBuffer> hostOutputs;
+        std::vector<void *> deviceMirrors;
+    };
+    Result CreateBindingDataset(const std::vector<UserBuffer> &buffers, bool isInput, bool mirror,
+                                BufferBinding &binding, aclmdlDataset *&dataset);
+    static void DestroyBinding(BufferBinding &binding);
+    std::map<uint32_t, BufferBinding> bindings_;
+    uint32_t nextBindingId_ = 0;
 };
 
@@ -0,0 +1,173 @@
+/**
+* @file model_process_binding.cpp
+*
+* Copyright (C) 2023. Huawei Technologies Co., Ltd. All rights reserved.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*/
+#include "model_process.h"
+
+namespace {
+void DestroyDataset(aclmdlDataset *dataset)
+{
+    if (dataset == nullptr) {
+        return;
+    }
+    for (size_t i = 0; i < aclmdlGetDatasetNumBuffers(dataset); ++i) {
+        aclDataBuffer *dataBuffer = aclmdlGetDatasetBuffer(dataset, i);
+        (void)aclDestroyDataBuffer(dataBuffer);
+    }
+    (void)aclmdlDestroyDataset(dataset);
+}
+}
+
+Result ModelProcess::CreateBindingDataset(const std::vector<UserBuffer> &buffers, bool isInput, bool mirror,
+                                          BufferBinding &binding, aclmdlDataset *&dataset)
+{
+    size_t num = isInput ? aclmdlGetNumInputs(modelDesc_) : aclmdlGetNumOutputs(modelDesc_);
+    if (buffers.size() != num) {
+        ERROR_LOG("registered %s buffer num %zu is not equal to model %s num %zu",
+            isInput ? "input" : "output", buffers.size(), isInput ? "input" : "output", num);
+        return FAILED;
+    }
+    dataset = aclmdlCreateDataset();
+    if (dataset == nullptr) {
+        ERROR_LOG("can't create dataset, create %s failed", isInput ? "input" : "output");
+        return FAILED;
+    }
+    for (size_t i = 0; i < num; ++i) {
+        size_t expectSize = isInput ? aclmdlGetInputSizeByIndex(modelDesc_, i) :
+            aclmdlGetOutputSizeByIndex(modelDesc_, i);
+        if ((buffers[i].data == nullptr) || (buffers[i].size < expectSize)) {
+            ERROR_LOG("registered %s buffer %zu is null or smaller than %zu", isInput ? "input" : "output", i,
+                expectSize);
+            return FAILED;
+        }
+        void *data = buffers[i].data;
+        if (mirror) {
+            // host memory is not visible to the device, the mirror is allocated once here
+            aclError ret = aclrtMalloc(&data, expectSize, ACL_MEM_MALLOC_HUGE_FIRST);
+            if (ret != ACL_SUCCESS) {
+                ERROR_LOG("can't malloc mirror of %s buffer %zu, size is %zu, errorCode is %d",
+                    isInput ? "input" : "output", i, expectSize, static_cast<int32_t>(ret));
+                return FAILED;
+            }
+            binding.deviceMirrors.push_back(data);
+            (isInput ? binding.hostInputs : binding.hostOutputs).push_back({buffers[i].data, expectSize});
+        }
+        aclDataBuffer *dataBuffer = aclCreateDataBuffer(data, mirror ? expectSize : buffers[i].size);
+        if (dataBuffer == nullptr) {
+            ERROR_LOG("can't create data buffer of %s buffer %zu", isInput ? "input" : "output", i);
+            return FAILED;
+        }
+        if (aclmdlAddDatasetBuffer(dataset, dataBuffer) != ACL_SUCCESS) {
+            ERROR_LOG("add %s dataset buffer %zu failed", isInput ? "input" : "output", i);
+            (void)aclDestroyDataBuffer(dataBuffer);
+            return FAILED;
+        }
+    }
+    return SUCCESS;
+}
+
+void ModelProcess::DestroyBinding(BufferBinding &binding)
+{
+    DestroyDataset(binding.input);
+    DestroyDataset(binding.output);
+    binding.input = nullptr;
+    binding.output = nullptr;
+    for (void *mirror : binding.deviceMirrors) {
+        (void)aclrtFree(mirror);
+    }
+    binding.deviceMirrors.clear();
+    binding.hostInputs.clear();
+    binding.hostOutputs.clear();
+}
+
+Result ModelProcess::RegisterBuffers(const std::vector<UserBuffer> &inputBuffers,
+                                     const std::vector<UserBuffer> &outputBuffers,
+                                     BufferLocation location, uint32_t &bindingId)
+{
+    if (modelDesc_ == nullptr) {
+        ERROR_LOG("no model description, create model desc before registering buffers");
+        return FAILED;
+    }
+    bool mirror = false;
+    if (location == BUFFER_PINNED_HOST) {
+        aclrtRunMode runMode;
+        aclError ret = aclrtGetRunMode(&runMode);
+        if (ret != ACL_SUCCESS) {
+            ERROR_LOG("get run mode failed, errorCode is %d", static_cast<int32_t>(ret));
+            return FAILED;
+        }
+        // on the device side host memory is device memory, the model reads it in place
+        mirror = (runMode == ACL_HOST);
+    }
+
+    BufferBinding binding = {nullptr, nullptr, {}, {}, {}};
+    if ((CreateBindingDataset(inputBuffers, true, mirror, binding, binding.input) != SUCCESS) ||
+        (CreateBindingDataset(outputBuffers, false, mirror, binding, binding.output) != SUCCESS)) {
+        DestroyBinding(binding);
+        return FAILED;
+    }
+    bindingId = nextBindingId_++;
+    bindings_[bindingId] = binding;
+    INFO_LOG("register buffers of model %u success, bindingId is %u, mirrored %d", modelId_, bindingId,
+        static_cast<int32_t>(mirror));
+    return SUCCESS;
+}
+
+Result ModelProcess::ExecuteBinding(uint32_t bindingId)
+{
+    auto iter = bindings_.find(bindingId);
+    if (iter == bindings_.end()) {
+        ERROR_LOG("bindingId %u is not registered", bindingId);
+        return FAILED;
+    }
+    const BufferBinding &binding = iter->second;
+    for (size_t i = 0; i < binding.hostInputs.size(); ++i) {
+        aclError ret = aclrtMemcpy(binding.deviceMirrors[i], binding.hostInputs[i].size, binding.hostInputs[i].data,
+            binding.hostInputs[i].size, ACL_MEMCPY_HOST_TO_DEVICE);
+        if (ret != ACL_SUCCESS) {
+            ERROR_LOG("copy input %zu to device failed, errorCode is %d", i, static_cast<int32_t>(ret));
+            return FAILED;
+        }
+    }
+    aclError ret = aclmdlExecute(modelId_, binding.input, binding.output);
+    if (ret != ACL_SUCCESS) {
+        ERROR_LOG("execute model failed, modelId is %u, bindingId is %u, errorCode is %d", modelId_, bindingId,
+            static_cast<int32_t>(ret));
+        return FAILED;
+    }
+    size_t mirrorOffset = binding.hostInputs.size();
+    for (size_t i = 0; i < binding.hostOutputs.size(); ++i) {
+        ret = aclrtMemcpy(binding.hostOutputs[i].data, binding.hostOutputs[i].size,
+            binding.deviceMirrors[mirrorOffset + i], binding.hostOutputs[i].size, ACL_MEMCPY_DEVICE_TO_HOST);
+        if (ret != ACL_SUCCESS) {
+            ERROR_LOG("copy output %zu to host failed, errorCode is %d", i, static_cast<int32_t>(ret));
+            return FAILED;
+        }
+    }
+    return SUCCESS;
+}
+
+Result ModelProcess::UnregisterBuffers(uint32_t bindingId)
+{
+    auto iter = bindings_.find(bindingId);
+    if (iter == bindings_.end()) {
+        ERROR_LOG("bindingId %u is not registered", bindingId);
+        return FAILED;
+    }
+    DestroyBinding(iter->second);
+    bindings_.erase(iter);
+    return SUCCESS;
+}
+
+void ModelProcess::UnregisterAllBuffers()
+{
+    for (auto &item : bindings_) {
+        DestroyBinding(item.second);
+    }
+    bindings_.clear();
+}